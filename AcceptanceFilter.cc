@@ -0,0 +1,36 @@
+#include "AcceptanceFilter.hh"
+
+#include "G4SystemOfUnits.hh"
+
+#include <cmath>
+
+AcceptanceFilter::Settings AcceptanceFilter::fgSettings;
+
+G4bool AcceptanceFilter::InAcceptance(const PrimaryMuon& muon, const Settings& settings)
+{
+    const G4double pT2 = muon.px * muon.px + muon.py * muon.py;
+    const G4double p2  = pT2 + muon.pz * muon.pz;
+    if (p2 * GeV * GeV < settings.pMin * settings.pMin) return false;
+    if (muon.pz <= 0.) return false;   // the disks are downstream
+
+    // r = z * pT / pz on each plane; compared squared to avoid the sqrt
+    const G4double slope2 = pT2 / (muon.pz * muon.pz);
+    const G4double rMin2 = settings.rMin * settings.rMin;
+    const G4double rMax2 = settings.rMax * settings.rMax;
+    for (auto z : settings.zPlanes) {
+        const G4double r2 = z * z * slope2;
+        if (r2 >= rMin2 && r2 <= rMax2) return true;
+    }
+    return false;
+}
+
+G4bool AcceptanceFilter::Accept(const std::vector<PrimaryMuon>& muons, const Settings& settings)
+{
+    if (!settings.enabled) return true;
+
+    G4int n = 0;
+    for (const auto& mu : muons) {
+        if (InAcceptance(mu, settings) && ++n >= settings.minMuons) return true;
+    }
+    return false;
+}
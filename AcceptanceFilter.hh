@@ -0,0 +1,39 @@
+#ifndef ACCEPTANCEFILTER_HH
+#define ACCEPTANCEFILTER_HH
+
+#include "globals.hh"
+#include "G4SystemOfUnits.hh"
+#include "GeneratorPool.hh"
+
+#include <vector>
+
+// Generator-level pre-filter: an event is kept if enough of its muons can
+// reach the FVTX disks. Straight lines from the vertex (the FVTX sits
+// upstream of the solenoid, only a map's fringe field reaches it), disk
+// planes and radii as in ConstructFVTXDetector.
+// Rejected events never reach Geant4; the trial counts keep the
+// normalisation (efficiency = accepted / trials).
+class AcceptanceFilter {
+public:
+    // Process-wide settings, set on the master (GeneratorMessenger).
+    // Lengths and momenta in Geant4 units.
+    struct Settings {
+        G4bool   enabled  = false;
+        G4int    minMuons = 1;                 // muons required in acceptance
+        G4double pMin     = 0.;                // per muon
+        G4double rMin     = 44.0 * mm;         // disk inner radius
+        G4double rMax     = 120.0 * mm;        // disk outer radius
+        std::vector<G4double> zPlanes = {201.1 * mm, 261.4 * mm, 321.7 * mm, 382.0 * mm};   // from the target
+        G4int    maxTrials = 100000;           // per accepted event
+    };
+    static Settings& GetSettings() { return fgSettings; }
+
+    // Muon (GeV) crosses at least one disk plane inside [rMin, rMax]
+    static G4bool InAcceptance(const PrimaryMuon& muon, const Settings& settings);
+    static G4bool Accept(const std::vector<PrimaryMuon>& muons, const Settings& settings);
+
+private:
+    static Settings fgSettings;
+};
+
+#endif
@@ -1,17 +1,45 @@
 #include "ActionInitialization.hh"
 #include "PrimaryGeneratorAction.hh"
+#include "RunAction.hh"
+#include "TrackOutputMessenger.hh"
+#include "GeneratorMessenger.hh"
+#include "RegionMessenger.hh"
+#include "FieldMessenger.hh"
+#include "StackingAction.hh"
+#include "SteppingAction.hh"
+#include "EventAction.hh"
 
+// Constructed once on the master: owns the master-side messengers
 ActionInitialization::ActionInitialization(EICDetectorConstruction* detector)
  : G4VUserActionInitialization(),
-   fDetector(detector)
+   fDetector(detector),
+   fOutputMessenger(new TrackOutputMessenger()),
+   fGeneratorMessenger(new GeneratorMessenger()),
+   fRegionMessenger(new RegionMessenger()),
+   fFieldMessenger(new FieldMessenger())
 {}
 
-ActionInitialization::~ActionInitialization() {}
+ActionInitialization::~ActionInitialization() {
+    delete fOutputMessenger;
+    delete fGeneratorMessenger;
+    delete fRegionMessenger;
+    delete fFieldMessenger;
+}
+
+void ActionInitialization::BuildForMaster() const
+{
+    SetUserAction(new RunAction());
+}
 
 void ActionInitialization::Build() const
 {
    
     auto primaryGen = new PrimaryGeneratorAction(fDetector);
     SetUserAction(primaryGen);
+    SetUserAction(new StackingAction());
+    auto stepping = new SteppingAction();
+    SetUserAction(stepping);
+    SetUserAction(new EventAction(stepping));
 
+    SetUserAction(new RunAction());
 }
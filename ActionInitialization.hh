@@ -4,15 +4,25 @@
 #include "G4VUserActionInitialization.hh"
 #include "EICDetectorConstruction.hh"
 
+class TrackOutputMessenger;
+class GeneratorMessenger;
+class RegionMessenger;
+class FieldMessenger;
+
 class ActionInitialization : public G4VUserActionInitialization {
 public:
     explicit ActionInitialization(EICDetectorConstruction* det);
     virtual ~ActionInitialization();
 
+    virtual void BuildForMaster() const override;
     virtual void Build() const override;
 
 private:
     EICDetectorConstruction* fDetector;
+    TrackOutputMessenger*    fOutputMessenger;
+    GeneratorMessenger*      fGeneratorMessenger;
+    RegionMessenger*         fRegionMessenger;
+    FieldMessenger*          fFieldMessenger;
 };
 
 #endif
@@ -1,62 +1,133 @@
+#include "AnalysisManager.hh"
+#include "EventRecord.hh"
+#include "Production.hh"
+#include "TrackFinder.hh"
+#include "Luminosity.hh"
 #include "G4ios.hh"
-#include <cstdio>
 
-std::mutex AnalysisManager::mutex;
-AnalysisManager* AnalysisManager::instance = nullptr;
+#include "TFile.h"
+#include "TParameter.h"
 
-AnalysisManager* AnalysisManager::GetInstance() {
-    std::lock_guard<std::mutex> lock(mutex);
-    if (!instance) {
-        instance = new AnalysisManager();
-    }
-    return instance;
+#include <cmath>
+
+std::mutex AnalysisManager::fgMutex;
+
+AnalysisManager& AnalysisManager::ThreadInstance() {
+    static G4ThreadLocal AnalysisManager* instance = nullptr;
+    if (!instance) instance = new AnalysisManager();
+    return *instance;
+}
+
+AnalysisManager& AnalysisManager::Totals() {
+    static AnalysisManager totals;
+    return totals;
 }
 
 AnalysisManager::AnalysisManager()
-    : outputFile(nullptr), EnergyTrackHist(nullptr), EnergyTrack(0.)
 {
-    const char* filename = "output.root";
+    // Not attached to any directory: the copies of the threads share names
+    auto book = [this](std::unique_ptr<TH1D>& hist, const char* name, const char* title,
+                       int bins, double min, double max) {
+        hist.reset(new TH1D(name, title, bins, min, max));
+        hist->SetDirectory(nullptr);
+        hist->Sumw2();
+        fHists.push_back(hist.get());
+    };
+    book(fEdepHist, "EnergyTrackHist", "Energy deposited per event;E_{dep} [GeV];events", 1500, 0., 150.);
+    // Weighted: entries are events per week of luminosity
+    book(fPairMassHist, "PairMassHist", "#mu^{+}#mu^{-} mass;M [GeV];events / week", 200, 0., 10.);
+    book(fPairXFHist, "PairXFHist", "#mu^{+}#mu^{-} x_{F};x_{F};events / week", 200, -1., 1.);
+    book(fPairPtHist, "PairPtHist", "#mu^{+}#mu^{-} p_{T};p_{T} [GeV];events / week", 200, 0., 5.);
+    book(fPairYHist, "PairYHist", "#mu^{+}#mu^{-} rapidity;y;events / week", 200, 0., 8.);
+    // Track reconstruction (/eic/reco/enable), unweighted
+    book(fRecoTracksHist, "RecoTracksHist", "Reconstructed tracks per event;tracks;events", 50, 0., 50.);
+    book(fRecoChi2Hist, "RecoChi2Hist", "Track #chi^{2}/ndf;#chi^{2}/ndf;tracks", 200, 0., 20.);
+    book(fMuonThetaHist, "MuonThetaHist", "Muon #theta;#theta [mrad];muons", 150, 0., 300.);
+    book(fRecoMuonThetaHist, "RecoMuonThetaHist", "Muon #theta, reconstructed;#theta [mrad];muons",
+         150, 0., 300.);
+}
 
-    if (std::remove(filename) == 0) {
-        G4cout << "Old output file removed: " << filename << G4endl;
-    }
+AnalysisManager::~AnalysisManager() = default;
 
-    outputFile = new TFile(filename, "RECREATE");
-    if (!outputFile || outputFile->IsZombie()) {
-        G4cerr << "Error: Could not create output file!" << G4endl;
-        delete outputFile;
-        outputFile = nullptr;
-        return;
+void AnalysisManager::FillEvent(const EventRecord& record) {
+    ++fEvents;
+    fSumWeights += record.weight;
+    fEdepHist->Fill(record.edepTotal);
+    for (const auto& pair : record.pairs) {
+        fPairMassHist->Fill(pair.mass, record.weight);
+        fPairXFHist->Fill(pair.xF, record.weight);
+        fPairPtHist->Fill(pair.pT, record.weight);
+        fPairYHist->Fill(pair.y, record.weight);
     }
 
-    EnergyTrackHist = new TH1F("EnergyTrackHist", "Total Energy per Event", 1500, 0., 1500.);
+    if (!TrackFinder::GetSettings().enabled) return;
+    fRecoTracksHist->Fill(record.tracks.size());
+    for (const auto& track : record.tracks) fRecoChi2Hist->Fill(track.chi2);
+    // A muon is reconstructed by a track with at least 3/4 of its hits
+    for (const auto& mu : record.muons) {
+        const double theta = 1e3 * std::atan2(std::hypot(mu.px, mu.py), mu.pz);
+        fMuonThetaHist->Fill(theta);
+        for (const auto& track : record.tracks) {
+            if (track.mcTrackID == mu.trackID && 4 * track.nMatched >= 3 * track.nHits) {
+                fRecoMuonThetaHist->Fill(theta);
+                break;
+            }
+        }
+    }
 }
 
-AnalysisManager::~AnalysisManager() {
-    if (outputFile) {
-        delete outputFile;
-        outputFile = nullptr;
-    }
-    delete EnergyTrackHist;
+void AnalysisManager::Add(const AnalysisManager& other) {
+    for (std::size_t i = 0; i < fHists.size(); ++i) fHists[i]->Add(other.fHists[i]);
+    fEvents += other.fEvents;
+    fSumWeights += other.fSumWeights;
 }
 
-void AnalysisManager::SetEnergy(G4double energy) {
-    EnergyTrack = energy;
+void AnalysisManager::Reset() {
+    for (auto hist : fHists) hist->Reset();
+    fEvents = 0;
+    fSumWeights = 0.;
 }
 
-void AnalysisManager::EndOfEvent() {
-    if (EnergyTrackHist) {
-        EnergyTrackHist->Fill(EnergyTrack);
-        G4cout << "Filling EnergyTrackHist with " << EnergyTrack << G4endl;
+void AnalysisManager::Merge() {
+    {
+        std::lock_guard<std::mutex> lock(fgMutex);
+        Totals().Add(*this);
     }
-    EnergyTrack = 0.;
+    Reset();
 }
 
 void AnalysisManager::Write() {
-    if (outputFile && outputFile->IsOpen()) {
-        outputFile->cd();
-        EnergyTrackHist->Write();
-        outputFile->Write();
-        outputFile->Close();  
+    std::lock_guard<std::mutex> lock(fgMutex);
+    auto& totals = Totals();
+
+    const G4String fileName = Production::OutputFileName("output");
+    TFile file(fileName.c_str(), "RECREATE");
+    if (file.IsZombie()) {
+        G4cerr << "Error: Could not create " << fileName << G4endl;
+    } else {
+        // Run normalisation, known only now (RunAction, end of run)
+        const auto& lumi = Luminosity::GetSettings();
+        const G4double eventScale = lumi.eventScale;
+        for (auto hist : {&totals.fPairMassHist, &totals.fPairXFHist, &totals.fPairPtHist, &totals.fPairYHist}) {
+            (*hist)->Scale(eventScale);
+        }
+        for (auto hist : totals.fHists) hist->Write();
+        TParameter<Long64_t>("Events", totals.fEvents).Write();
+        TParameter<Double_t>("SumWeights", totals.fSumWeights).Write();
+        // Shard spectra are each normalised to a full week: mergeShards
+        // rescales their sum with eventsPerWeek / sum of the trials
+        TParameter<Long64_t>("Trials", lumi.trials).Write();
+        TParameter<Long64_t>("EventsPerWeek", lumi.eventsPerWeek).Write();
+        TParameter<Double_t>("EventScale", eventScale).Write();
+        file.Close();
+        G4cout << "[ANA] " << totals.fEvents << " events, " << totals.fPairMassHist->GetEntries()
+               << " pairs (" << totals.fPairMassHist->GetSumOfWeights() << " per week)";
+        if (totals.fMuonThetaHist->GetEntries() > 0) {
+            G4cout << ", " << totals.fRecoChi2Hist->GetEntries() << " tracks, "
+                   << totals.fRecoMuonThetaHist->GetEntries() << " of " << totals.fMuonThetaHist->GetEntries()
+                   << " muons reconstructed";
+        }
+        G4cout << " -> " << fileName << G4endl;
     }
+    totals.Reset();
 }
@@ -1,34 +1,63 @@
 #ifndef ANALYSISMANAGER_HH
 #define ANALYSISMANAGER_HH
 
+#include <memory>
 #include <mutex>
-#include "TH1F.h"
-#include "TFile.h"
-#include "G4Types.hh"
+#include <vector>
+#include "TH1D.h"
+#include "globals.hh"
 
+struct EventRecord;
+
+// Run histograms: energy deposited per event and the weighted dimuon
+// mass / xF / pT / y spectra (filled with the generator weight, scaled at
+// Write by the run's eventScale: entries are events per week of luminosity).
+// With /eic/reco/enable also the reconstructed tracks: number per event,
+// chi2, and the theta of the muons with and without a matching track.
+//
+// Each thread fills its own histograms (ThreadInstance) with no locks. At
+// end of run each worker adds them to the run totals (Merge, one lock per
+// worker and run); the master writes the totals to output.root
+// (output_shard<K>.root in a sharded production) and starts afresh (Write).
 class AnalysisManager {
 public:
-    static AnalysisManager* GetInstance();
+    // Histograms of the calling thread
+    static AnalysisManager& ThreadInstance();
     ~AnalysisManager();
 
-    void SetEnergy(G4double energy);
-    void AddKineticEnergy(G4double kineticEnergy);  // méthode ajoutée
-    void EndOfEvent();
-    void Write();
+    // Worker side, once per event
+    void FillEvent(const EventRecord& record);
+    // Worker end of run: histograms of this thread added to the run totals
+    void Merge();
+
+    // Master end of run: run totals written, then reset
+    static void Write();
 
 private:
     AnalysisManager();
     AnalysisManager(const AnalysisManager&) = delete;
     AnalysisManager& operator=(const AnalysisManager&) = delete;
 
-    static AnalysisManager* instance;
-    static std::mutex mutex;
+    void Add(const AnalysisManager& other);
+    void Reset();
+
+    // Run totals, filled by Merge
+    static AnalysisManager& Totals();
+    static std::mutex fgMutex;
+
+    std::unique_ptr<TH1D> fEdepHist;
+    std::unique_ptr<TH1D> fPairMassHist;
+    std::unique_ptr<TH1D> fPairXFHist;
+    std::unique_ptr<TH1D> fPairPtHist;
+    std::unique_ptr<TH1D> fPairYHist;
+    std::unique_ptr<TH1D> fRecoTracksHist;
+    std::unique_ptr<TH1D> fRecoChi2Hist;
+    std::unique_ptr<TH1D> fMuonThetaHist;
+    std::unique_ptr<TH1D> fRecoMuonThetaHist;
+    std::vector<TH1D*>    fHists;    // all of the above
 
-    TFile* outputFile;
-    TH1F* EnergyTrackHist;
-    TH1F* KineticEnergyHist;
-    G4double EnergyTrack;
-    G4double TotalKineticEnergy;  
+    G4long   fEvents = 0;
+    G4double fSumWeights = 0.;
 };
 
 #endif
@@ -0,0 +1,114 @@
+#include "AsyncWriter.hh"
+
+#include "TrackOutput.hh"
+#include "Log.hh"
+
+#include "G4ios.hh"
+
+#include <chrono>
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    std::uint64_t NanosecondsSince(Clock::time_point start) {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+    }
+}
+
+AsyncWriter& AsyncWriter::Instance() {
+    static AsyncWriter writer;
+    return writer;
+}
+
+void AsyncWriter::Start(const G4String& fileName, G4int queueSize) {
+    if (IsRunning()) Stop();
+
+    fQueue = std::make_unique<BoundedQueue<OutputBatch*>>(queueSize);
+    fStopRequested.store(false);
+    fStallNs.store(0);
+    fPushes.store(0);
+    fDepthSum.store(0);
+    fMaxDepth.store(0);
+    fBatches = 0;
+    fEvents = 0;
+    fIOTime = 0.;
+    fBytesWritten = 0.;
+
+    fRunning.store(true, std::memory_order_release);
+    fThread = std::thread(&AsyncWriter::Run, this, fileName);
+}
+
+AsyncWriter::Stats AsyncWriter::Stop() {
+    Stats stats;
+    if (!IsRunning()) return stats;
+
+    fStopRequested.store(true, std::memory_order_release);
+    fThread.join();
+    fRunning.store(false, std::memory_order_release);
+
+    const auto pushes = fPushes.load();
+    stats.stallTime    = fStallNs.load() * 1e-9;
+    stats.meanDepth    = pushes ? double(fDepthSum.load()) / pushes : 0.;
+    stats.maxDepth     = static_cast<G4int>(fMaxDepth.load());
+    stats.batches      = fBatches;
+    stats.events       = fEvents;
+    stats.ioTime       = fIOTime;
+    stats.bytesWritten = fBytesWritten;
+    return stats;
+}
+
+void AsyncWriter::Push(OutputBatch* batch) {
+    batch->inFlight.store(true, std::memory_order_release);
+
+    const std::uint64_t depth = fQueue->SizeApprox();
+    fPushes.fetch_add(1, std::memory_order_relaxed);
+    fDepthSum.fetch_add(depth, std::memory_order_relaxed);
+    std::uint64_t seen = fMaxDepth.load(std::memory_order_relaxed);
+    while (depth > seen && !fMaxDepth.compare_exchange_weak(seen, depth, std::memory_order_relaxed)) {}
+
+    if (fQueue->TryPush(batch)) return;
+
+    // Backpressure: the writer is behind
+    const auto start = Clock::now();
+    while (!fQueue->TryPush(batch)) std::this_thread::yield();
+    AddStall(NanosecondsSince(start));
+}
+
+void AsyncWriter::WaitIdle(OutputBatch* batch) {
+    if (!batch->inFlight.load(std::memory_order_acquire)) return;
+
+    const auto start = Clock::now();
+    while (batch->inFlight.load(std::memory_order_acquire)) std::this_thread::yield();
+    AddStall(NanosecondsSince(start));
+}
+
+void AsyncWriter::Run(G4String fileName) {
+    // The writer's own TrackOutput, writing straight to file. Not the
+    // thread-local instance: the thread ends with the run, the sink with it
+    std::unique_ptr<TrackOutput> sink(new TrackOutput());
+    sink->Open(fileName);
+
+    OutputBatch* batch = nullptr;
+    G4int idle = 0;
+    for (;;) {
+        if (!fQueue->TryPop(batch)) {
+            if (fStopRequested.load(std::memory_order_acquire) && fQueue->SizeApprox() == 0) break;
+            // Spin briefly, then back off so an idle writer does not hold a core
+            if (++idle < 64) std::this_thread::yield();
+            else std::this_thread::sleep_for(std::chrono::microseconds(50));
+            continue;
+        }
+        idle = 0;
+
+        for (std::size_t i = 0; i < batch->size; ++i) sink->Write(batch->events[i]);
+        fEvents += static_cast<G4int>(batch->size);
+        ++fBatches;
+
+        batch->inFlight.store(false, std::memory_order_release);
+    }
+
+    sink->Close();
+    fIOTime = sink->GetIOTime();
+    fBytesWritten = sink->GetBytesWritten();
+    Log::EndOfThread();
+}
@@ -0,0 +1,74 @@
+#ifndef ASYNCWRITER_HH
+#define ASYNCWRITER_HH
+
+#include "globals.hh"
+#include "BoundedQueue.hh"
+#include "EventRecord.hh"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+// Completed events handed from a worker to the writer thread.
+// Each worker owns a few of these and cycles through them (double buffering);
+// `inFlight` is set by the worker on hand-off and cleared by the writer.
+struct OutputBatch {
+    std::vector<EventRecord> events;   // slots are reused, only the first `size` are valid
+    std::size_t              size = 0;
+    std::atomic<bool>        inFlight{false};
+};
+
+// Dedicated writer thread for the track output.
+// Workers push full batches into a bounded lock-free queue; the writer fills
+// (and thereby compresses) the tree in its own TrackOutput. A full queue or a
+// buffer still being written makes the worker wait: that time is reported
+// as stall time.
+class AsyncWriter {
+public:
+    struct Stats {
+        G4double stallTime    = 0.;  // s, summed over workers
+        G4double meanDepth    = 0.;  // queue depth seen at each push
+        G4int    maxDepth     = 0;
+        G4int    batches      = 0;
+        G4int    events       = 0;
+        G4double ioTime       = 0.;  // s, writer thread
+        G4double bytesWritten = 0.;
+    };
+
+    static AsyncWriter& Instance();
+
+    // Master side, once per run
+    void Start(const G4String& fileName, G4int queueSize);
+    Stats Stop();
+    G4bool IsRunning() const { return fRunning.load(std::memory_order_acquire); }
+
+    // Worker side
+    void Push(OutputBatch* batch);
+    void WaitIdle(OutputBatch* batch);
+
+private:
+    AsyncWriter() = default;
+    void Run(G4String fileName);
+    void AddStall(std::uint64_t ns) { fStallNs.fetch_add(ns, std::memory_order_relaxed); }
+
+    std::unique_ptr<BoundedQueue<OutputBatch*>> fQueue;
+    std::thread fThread;
+    std::atomic<bool> fRunning{false};
+    std::atomic<bool> fStopRequested{false};
+
+    std::atomic<std::uint64_t> fStallNs{0};
+    std::atomic<std::uint64_t> fPushes{0};
+    std::atomic<std::uint64_t> fDepthSum{0};
+    std::atomic<std::uint64_t> fMaxDepth{0};
+
+    // Written by the writer thread, read after join
+    G4int    fBatches = 0;
+    G4int    fEvents = 0;
+    G4double fIOTime = 0.;
+    G4double fBytesWritten = 0.;
+};
+
+#endif
@@ -0,0 +1,91 @@
+#include "Benchmark.hh"
+#include "RunAction.hh"
+#include "Production.hh"
+
+#include "G4RunManager.hh"
+#include "G4UImanager.hh"
+#include "G4ios.hh"
+
+#include <sys/resource.h>
+
+#include <chrono>
+#include <fstream>
+#include <sstream>
+
+namespace Benchmark {
+
+const std::vector<Workload>& Workloads() {
+    // Event counts: a few seconds per workload on one thread
+    static const std::vector<Workload> workloads = {
+        {"charmonium", "charmonium", 500},
+        {"opencharm",  "opencharm",  500},
+        {"singlemuon", "singlemuon", 2000},
+    };
+    return workloads;
+}
+
+namespace {
+    // Process peak resident set so far, in MB
+    G4double PeakRSS() {
+        rusage usage{};
+        getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+        return usage.ru_maxrss / (1024. * 1024.);   // bytes
+#else
+        return usage.ru_maxrss / 1024.;             // KB
+#endif
+    }
+}
+
+G4bool Run(G4RunManager* runManager, const std::string& list, G4int nThreads,
+           G4double initTime, G4int nEvents, const std::string& outFile) {
+    std::vector<const Workload*> selected;
+    std::istringstream names(list);
+    for (std::string name; std::getline(names, name, ',');) {
+        G4bool found = false;
+        for (const auto& w : Workloads()) {
+            if (name == "all" || name == w.name) {
+                selected.push_back(&w);
+                found = true;
+            }
+        }
+        if (!found) {
+            G4cerr << "Error: unknown benchmark workload " << name << G4endl;
+            return false;
+        }
+    }
+
+    auto* ui = G4UImanager::GetUIpointer();
+    ui->ApplyCommand("/run/printProgress 0");
+    std::ofstream out;
+    if (!outFile.empty()) out.open(outFile, std::ios::app);
+
+    for (const auto* w : selected) {
+        ui->ApplyCommand(std::string("/eic/gen/process ") + w->process);
+        const G4int events = nEvents > 0 ? nEvents : w->events;
+
+        const auto start = std::chrono::steady_clock::now();
+        runManager->BeamOn(events);
+        const G4double run = std::chrono::duration<G4double>(std::chrono::steady_clock::now() - start).count();
+
+        // The loop rate comes from the run's own timer (merge excluded);
+        // run_s is the whole BeamOn, first-run Pythia setup and merge included
+        const auto& last = RunAction::GetLastRun();
+        const G4double perEvent = last.events > 0 ? 1. / last.events : 0.;
+        std::ostringstream json;
+        json << "{\"workload\":\"" << w->name << "\",\"threads\":" << nThreads
+             << ",\"events\":" << last.events << ",\"seed\":" << Production::GetSettings().seed
+             << ",\"init_s\":" << initTime << ",\"run_s\":" << run
+             << ",\"events_per_s\":" << (last.wall > 0. ? last.events / last.wall : 0.)
+             << ",\"steps_per_event\":" << last.steps * perEvent
+             << ",\"steps_per_s\":" << (last.wall > 0. ? last.steps / last.wall : 0.)
+             << ",\"worker_s_per_event\":" << last.workerTime * perEvent
+             << ",\"peak_rss_mb\":" << PeakRSS()
+             << ",\"output_bytes_per_event\":" << last.bytesWritten * perEvent << "}";
+        G4cout << "[BENCH] " << json.str() << G4endl;
+        if (out) out << json.str() << '\n';
+    }
+    return true;
+}
+
+} // namespace Benchmark
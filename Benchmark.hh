@@ -0,0 +1,32 @@
+#ifndef BENCHMARK_HH
+#define BENCHMARK_HH
+
+#include "globals.hh"
+
+#include <string>
+#include <vector>
+
+class G4RunManager;
+
+// Standard simulation benchmark (--bench): fixed workloads through the full
+// detector with a fixed seed, so that two builds or two machines run the
+// same events. One JSON line per workload on stdout (and appended to a
+// file): initialization time, events/s, steps/s, peak RSS and output
+// bytes per event. Thread counts are scanned by bench/run_suite.sh.
+namespace Benchmark {
+
+struct Workload {
+    const char* name;
+    const char* process;   // /eic/gen/process
+    G4int       events;
+};
+const std::vector<Workload>& Workloads();
+
+// Comma-separated workload names, or "all". False (and nothing run) on an
+// unknown name. nEvents > 0 overrides the per-workload event counts.
+G4bool Run(G4RunManager* runManager, const std::string& list, G4int nThreads,
+           G4double initTime, G4int nEvents, const std::string& outFile);
+
+} // namespace Benchmark
+
+#endif
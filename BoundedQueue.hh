@@ -0,0 +1,88 @@
+#ifndef BOUNDEDQUEUE_HH
+#define BOUNDEDQUEUE_HH
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+// Bounded lock-free multi-producer/multi-consumer queue (D. Vyukov's
+// sequence-number ring). TryPush/TryPop never block; the caller decides
+// how to wait when the queue is full or empty.
+template <typename T>
+class BoundedQueue {
+public:
+    explicit BoundedQueue(std::size_t capacity) {
+        std::size_t n = 2;
+        while (n < capacity) n *= 2;
+        fMask = n - 1;
+        fCells.reset(new Cell[n]);
+        for (std::size_t i = 0; i < n; ++i) fCells[i].sequence.store(i, std::memory_order_relaxed);
+        fEnqueuePos.store(0, std::memory_order_relaxed);
+        fDequeuePos.store(0, std::memory_order_relaxed);
+    }
+
+    BoundedQueue(const BoundedQueue&) = delete;
+    BoundedQueue& operator=(const BoundedQueue&) = delete;
+
+    bool TryPush(const T& value) {
+        std::size_t pos = fEnqueuePos.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell& cell = fCells[pos & fMask];
+            const std::size_t seq = cell.sequence.load(std::memory_order_acquire);
+            const auto diff = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos);
+            if (diff == 0) {
+                if (fEnqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    cell.data = value;
+                    cell.sequence.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;   // full
+            } else {
+                pos = fEnqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    bool TryPop(T& value) {
+        std::size_t pos = fDequeuePos.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell& cell = fCells[pos & fMask];
+            const std::size_t seq = cell.sequence.load(std::memory_order_acquire);
+            const auto diff = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos + 1);
+            if (diff == 0) {
+                if (fDequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    value = cell.data;
+                    cell.sequence.store(pos + fMask + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;   // empty
+            } else {
+                pos = fDequeuePos.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // Approximate number of queued elements (for monitoring only)
+    std::size_t SizeApprox() const {
+        const std::size_t head = fDequeuePos.load(std::memory_order_relaxed);
+        const std::size_t tail = fEnqueuePos.load(std::memory_order_relaxed);
+        return tail > head ? tail - head : 0;
+    }
+
+    std::size_t Capacity() const { return fMask + 1; }
+
+private:
+    struct Cell {
+        std::atomic<std::size_t> sequence;
+        T data;
+    };
+
+    std::unique_ptr<Cell[]> fCells;
+    std::size_t fMask = 0;
+    alignas(64) std::atomic<std::size_t> fEnqueuePos;
+    alignas(64) std::atomic<std::size_t> fDequeuePos;
+};
+
+#endif
@@ -0,0 +1,43 @@
+#include "DetectorHit.hh"
+
+#include "G4Event.hh"
+#include "G4HCofThisEvent.hh"
+#include "G4SDManager.hh"
+
+#include <array>
+
+G4ThreadLocal G4Allocator<DetectorHit>* DetectorHitAllocator = nullptr;
+
+const char* DetectorHit::Name(Subsystem subsystem) {
+    switch (subsystem) {
+        case FVTX:         return "FVTX";
+        case InnerTracker: return "InnerTracker";
+        case Micromegas:   return "Micromegas";
+        case EMCal:        return "EMCal";
+        default:           return "";
+    }
+}
+
+G4bool DetectorHit::FromName(const G4String& name, Subsystem& subsystem) {
+    for (G4int i = 0; i < kNSubsystems; ++i) {
+        if (name == Name(static_cast<Subsystem>(i))) {
+            subsystem = static_cast<Subsystem>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+const DetectorHitsCollection* GetDetectorHits(const G4Event* event, DetectorHit::Subsystem subsystem) {
+    static G4ThreadLocal std::array<G4int, DetectorHit::kNSubsystems>* ids = nullptr;
+    if (!ids) {
+        ids = new std::array<G4int, DetectorHit::kNSubsystems>;
+        ids->fill(-2);   // not looked up yet
+    }
+    auto& id = (*ids)[subsystem];
+    if (id == -2) id = G4SDManager::GetSDMpointer()->GetCollectionID(DetectorHit::CollectionName(subsystem));
+
+    auto* hce = event ? event->GetHCofThisEvent() : nullptr;
+    if (id < 0 || !hce) return nullptr;
+    return static_cast<const DetectorHitsCollection*>(hce->GetHC(id));
+}
@@ -0,0 +1,51 @@
+#ifndef DETECTORHIT_HH
+#define DETECTORHIT_HH
+
+#include "G4VHit.hh"
+#include "G4THitsCollection.hh"
+#include "G4Allocator.hh"
+#include "G4ThreeVector.hh"
+#include "globals.hh"
+
+class G4Event;
+
+// Hit of one sensitive subsystem: consecutive steps of a track in one layer
+// summed into one hit. EICSensitiveDetector fills one collection per
+// subsystem ("<name>Hits"), so a consumer reads only the subsystems it needs.
+class DetectorHit : public G4VHit {
+public:
+    enum Subsystem { FVTX, InnerTracker, Micromegas, EMCal, kNSubsystems };
+
+    static const char* Name(Subsystem subsystem);
+    static G4bool FromName(const G4String& name, Subsystem& subsystem);
+    static G4String CollectionName(Subsystem subsystem) { return G4String(Name(subsystem)) + "Hits"; }
+
+    inline void* operator new(size_t);
+    inline void  operator delete(void* hit);
+
+    G4int         trackID = 0;
+    G4int         pdg = 0;
+    G4int         layer = 0;       // within the subsystem, description order
+    G4ThreeVector position;        // global, first step
+    G4double      time = 0.;       // global, first step
+    G4double      energyDep = 0.;  // summed over the steps
+};
+
+using DetectorHitsCollection = G4THitsCollection<DetectorHit>;
+
+// Hits of `subsystem` in `event`, or nullptr; the collection ID is looked
+// up once per thread
+const DetectorHitsCollection* GetDetectorHits(const G4Event* event, DetectorHit::Subsystem subsystem);
+
+extern G4ThreadLocal G4Allocator<DetectorHit>* DetectorHitAllocator;
+
+inline void* DetectorHit::operator new(size_t) {
+    if (!DetectorHitAllocator) DetectorHitAllocator = new G4Allocator<DetectorHit>;
+    return DetectorHitAllocator->MallocSingle();
+}
+
+inline void DetectorHit::operator delete(void* hit) {
+    DetectorHitAllocator->FreeSingle(static_cast<DetectorHit*>(hit));
+}
+
+#endif
@@ -0,0 +1,91 @@
+#include "DetectorRegions.hh"
+
+#include "G4Region.hh"
+#include "G4RegionStore.hh"
+#include "G4LogicalVolume.hh"
+#include "G4VPhysicalVolume.hh"
+#include "G4ProductionCuts.hh"
+#include "G4ProductionCutsTable.hh"
+#include "G4UserLimits.hh"
+#include "G4ios.hh"
+
+#include <cfloat>
+#include <cstring>
+#include <memory>
+
+DetectorRegions::Settings DetectorRegions::fgSettings;
+
+namespace {
+    // Owned here: G4Region keeps plain pointers
+    std::array<std::unique_ptr<G4ProductionCuts>, DetectorRegions::kNRegions> gCuts;
+    std::array<std::unique_ptr<G4UserLimits>, DetectorRegions::kNRegions> gLimits;
+
+    // Daughters follow their mother, down to the root of another region
+    void SetLimits(G4LogicalVolume* volume, G4UserLimits* limits, G4bool root) {
+        if (!root && volume->IsRootRegion()) return;
+        volume->SetUserLimits(limits);
+        for (std::size_t i = 0; i < volume->GetNoDaughters(); ++i) {
+            SetLimits(volume->GetDaughter(i)->GetLogicalVolume(), limits, false);
+        }
+    }
+}
+
+const char* DetectorRegions::Name(Id id) {
+    switch (id) {
+        case Tracking:    return "Tracking";
+        case BarrelCalo:  return "BarrelCalo";
+        case ForwardCalo: return "ForwardCalo";
+        case Magnet:      return "Magnet";
+        default:          return "";
+    }
+}
+
+G4bool DetectorRegions::FromName(const G4String& name, Id& id) {
+    for (G4int i = 0; i < kNRegions; ++i) {
+        if (name == Name(static_cast<Id>(i))) {
+            id = static_cast<Id>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+G4Region* DetectorRegions::GetRegion(Id id) {
+    return G4RegionStore::GetInstance()->GetRegion(Name(id), false);
+}
+
+void DetectorRegions::AddRootVolume(Id id, G4LogicalVolume* volume) {
+    if (!volume) return;
+    auto region = GetRegion(id);
+    if (!region) region = new G4Region(Name(id));
+    region->AddRootLogicalVolume(volume);
+}
+
+void DetectorRegions::Apply() {
+    for (G4int i = 0; i < kNRegions; ++i) {
+        const auto id = static_cast<Id>(i);
+        auto region = GetRegion(id);
+        if (!region) continue;
+        const auto& limits = fgSettings.limits[i];
+
+        if (limits.cut > 0.) {
+            if (!gCuts[i]) gCuts[i] = std::make_unique<G4ProductionCuts>();
+            gCuts[i]->SetProductionCut(limits.cut);
+            region->SetProductionCuts(gCuts[i].get());
+        } else {
+            region->SetProductionCuts(G4ProductionCutsTable::GetProductionCutsTable()->GetDefaultProductionCuts());
+        }
+
+        G4UserLimits* userLimits = nullptr;
+        if (limits.maxStep > 0. || limits.minEkin > 0.) {
+            if (!gLimits[i]) gLimits[i] = std::make_unique<G4UserLimits>();
+            userLimits = gLimits[i].get();
+            userLimits->SetMaxAllowedStep(limits.maxStep > 0. ? limits.maxStep : DBL_MAX);
+            userLimits->SetUserMinEkine(limits.minEkin);
+        }
+        auto it = region->GetRootLogicalVolumeIterator();
+        for (std::size_t n = 0; n < region->GetNumberOfRootVolumes(); ++n, ++it) {
+            SetLimits(*it, userLimits, true);
+        }
+    }
+}
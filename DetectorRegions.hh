@@ -0,0 +1,50 @@
+#ifndef DETECTORREGIONS_HH
+#define DETECTORREGIONS_HH
+
+#include "globals.hh"
+
+#include <array>
+
+class G4LogicalVolume;
+class G4Region;
+
+// Geant4 regions of the detector, each with its own production cut and
+// user limits. Only muons matter downstream, so the passive volumes
+// (calorimeters, magnet) can run with coarse cuts while the tracking
+// region keeps the defaults.
+//
+// Limits need G4StepLimiterPhysics (registered in main.cc): maxStep via
+// G4StepLimiter, minEkin via G4UserSpecialCuts.
+class DetectorRegions {
+public:
+    enum Id { Tracking, BarrelCalo, ForwardCalo, Magnet, kNRegions };
+
+    // Geant4 units; 0 = not set (default cuts, no limit)
+    struct Limits {
+        G4double cut     = 0.;    // production cut, all particles
+        G4double maxStep = 0.;
+        G4double minEkin = 0.;    // tracks stopped below
+    };
+
+    // Process-wide settings, set on the master (RegionMessenger)
+    struct Settings {
+        std::array<Limits, kNRegions> limits;
+    };
+    static Settings& GetSettings() { return fgSettings; }
+
+    static const char* Name(Id id);
+    static G4bool FromName(const G4String& name, Id& id);
+
+    // Detector construction: `volume` and its daughters belong to region `id`
+    static void AddRootVolume(Id id, G4LogicalVolume* volume);
+    static G4Region* GetRegion(Id id);
+
+    // Settings -> production cuts and user limits of the regions; at
+    // construction and after every change (master, PreInit or Idle)
+    static void Apply();
+
+private:
+    static Settings fgSettings;
+};
+
+#endif
@@ -4,10 +4,16 @@
 #include "G4VUserDetectorConstruction.hh"
 #include "G4LogicalVolume.hh"
 #include "G4ThreeVector.hh"
+#include "GeometryDescription.hh"
+#include "Readout.hh"
+#include <map>
 #include <vector>
 
 class G4Material;
+class G4VSolid;
 
+// Detector built from a GeometryDescription file (geometry/ft-eic.geo by
+// default): volumes, materials, sensitive volumes and region roots.
 class EICDetectorConstruction : public G4VUserDetectorConstruction {
 public:
   EICDetectorConstruction();
@@ -18,51 +24,45 @@ public:
 
   G4ThreeVector GetTargetPosition() const;
 
-private:
-  G4Material* CreateMaterial(const G4String& name);
-  G4Material* CreateCompositeMaterial(const G4String& name);
+  // Description file and its binary cache directory ("" = no cache),
+  // before Construct
+  void SetDescription(const G4String& fileName, const G4String& cacheDir) {
+    descriptionFile = fileName;
+    cacheDirectory = cacheDir;
+  }
+  // Subdetectors in the central barrel / forward / backward envelopes
+  // (default), or all directly in the world (before Construct, to compare)
+  void SetEnvelopes(G4bool enable) { useEnvelopes = enable; }
+  // Overlap check of every placement; returns the number with overlaps
+  G4int CheckOverlaps(G4int resolution = 1000) const;
+  // Channel maps of the segmented volumes (`readout=`), in description
+  // order: the detector number of the digits
+  const std::vector<ReadoutMap>& GetReadouts() const { return readouts; }
 
-  void ConstructTarget(G4LogicalVolume* worldLV);
-  void ConstructFVTXDetector(G4LogicalVolume* worldLV);
+private:
+  // Declared composite or NIST material; built once per process, so
+  // geometry variants and rebuilds share the definitions
+  G4Material* FindOrBuildMaterial(const G4String& name);
+  G4VSolid* BuildSolid(const GeometryDescription::Volume& volume) const;
+  // Mother and position, envelopes dissolved when they are disabled
+  const GeometryDescription::Volume* PlacementMother(const GeometryDescription::Volume& volume,
+                                                     G4ThreeVector& position) const;
 
-  void ConstructEMCal(G4LogicalVolume* worldLV);
-  void ConstructHCal(G4LogicalVolume* worldLV);
-  void ConstructSolenoid(G4LogicalVolume* worldLV);
-  void ConstructRICH(G4LogicalVolume* worldLV);
-  void ConstructBarrelEMCal(G4LogicalVolume* worldLV);
-  void ConstructTimeOfFlight(G4LogicalVolume* worldLV);
-  void ConstructInnerTracker(G4LogicalVolume* worldLV);
-  void ConstructMicromegas(G4LogicalVolume* worldLV);
+  // DetectorRegions roots from the `region=` of the description
+  void ConstructRegions();
 
 private:
-  G4LogicalVolume* emcalLV                  = nullptr;
-  G4LogicalVolume* hcalLV                   = nullptr;
-  G4LogicalVolume* solenoidLV               = nullptr;
-  G4LogicalVolume* richLV                   = nullptr;
-  G4LogicalVolume* barrelLV                 = nullptr;
-  G4LogicalVolume* tofLV                    = nullptr;
+  G4String descriptionFile = "geometry/ft-eic.geo";
+  G4String cacheDirectory  = ".geocache";
+  G4bool   useEnvelopes    = true;
 
-  // EMCal
-  G4LogicalVolume* emcalCrystalsLV          = nullptr;
-  G4LogicalVolume* emcalElectronicsLV       = nullptr;
-  G4LogicalVolume* emcalOuterSurfaceLV      = nullptr;
-  G4LogicalVolume* emcalInnerSurfaceLV      = nullptr;
-  G4LogicalVolume* emcalOffsetAirLV         = nullptr;
-  G4LogicalVolume* emcalAluminumPlateLV     = nullptr;
+  GeometryDescription description;
+  std::map<G4String, G4LogicalVolume*> volumesLV;   // by description name
+  std::vector<G4LogicalVolume*> sensitiveLV;
+  std::vector<ReadoutMap> readouts;
 
-  // Target
-  G4LogicalVolume*  targetLV                = nullptr;
-  G4VPhysicalVolume* targetPV               = nullptr;
+  G4VPhysicalVolume* worldPV = nullptr;
   G4ThreeVector      fTargetPosition;
-
-  // ===== FVTX (4 discs) =====
-  G4LogicalVolume* fvtxEnvelopeLV           = nullptr; // air
-  G4LogicalVolume* fvtxBeamPipeLV           = nullptr; // Be
-  std::vector<G4LogicalVolume*> fvtxDisksLV;           // Si
-
-  // Trackers additionnels
-  std::vector<G4LogicalVolume*> innerTrackerDisksLV;
-  std::vector<G4LogicalVolume*> micromegasLV;
 };
 
 #endif
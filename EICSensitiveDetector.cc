@@ -3,18 +3,72 @@
 #include "G4Track.hh"
 #include "G4ParticleDefinition.hh"
 #include "G4SystemOfUnits.hh"
+#include "G4Event.hh"
+#include "G4EventManager.hh"
+#include "G4FastHit.hh"
+#include "G4HCofThisEvent.hh"
+#include "G4SDManager.hh"
+#include "G4LogicalVolume.hh"
+#include "G4NavigationHistory.hh"
+#include "G4AffineTransform.hh"
 #include "G4ios.hh"
 #include <iostream>
-#include "TFile.h"
-#include "TTree.h"
-#include "TLorentzVector.h"
+#include <algorithm>
+#include "TrackOutput.hh"
+#include "GeneratorConfig.hh"
+#include "Production.hh"
+#include "EventInformation.hh"
+#include "AnalysisManager.hh"
+#include "FieldSetup.hh"
 
 EICSensitiveDetector::EICSensitiveDetector(const G4String& name)
   : G4VSensitiveDetector(name), totalEnergyDeposit(0.)
-{}
+{
+    for (G4int s = 0; s < DetectorHit::kNSubsystems; ++s) {
+        collectionName.insert(DetectorHit::CollectionName(static_cast<DetectorHit::Subsystem>(s)));
+    }
+    collectionIDs.fill(-1);
+}
 
 EICSensitiveDetector::~EICSensitiveDetector() {}
 
+void EICSensitiveDetector::SetVolume(const G4LogicalVolume* lv, const Volume& volume)
+{
+    const auto id = std::size_t(lv->GetInstanceID());
+    if (id >= volumes.size()) volumes.resize(id + 1);
+    volumes[id] = volume;
+
+    if (volume.subsystem >= 0) {
+        auto& layers = recoLayers[volume.subsystem];
+        if (std::size_t(volume.layer) >= layers.size()) layers.resize(volume.layer + 1, -1);
+        layers[volume.layer] = volume.recoLayer;
+    }
+}
+
+void EICSensitiveDetector::SetReadouts(const std::vector<ReadoutMap>& maps)
+{
+    digitizer = maps.empty() ? nullptr : std::make_unique<Digitizer>(maps);
+}
+
+void EICSensitiveDetector::SetTrackingLayers(const std::vector<TrackFinder::Layer>& layers)
+{
+    finder = layers.size() < 3 ? nullptr : std::make_unique<TrackFinder>(layers);
+}
+
+void EICSensitiveDetector::Initialize(G4HCofThisEvent* hce)
+{
+    // The event owns the collections
+    for (G4int s = 0; s < DetectorHit::kNSubsystems; ++s) {
+        hitsCollections[s] = new DetectorHitsCollection(SensitiveDetectorName, collectionName[s]);
+        if (collectionIDs[s] < 0) collectionIDs[s] = G4SDManager::GetSDMpointer()->GetCollectionID(hitsCollections[s]);
+        hce->AddHitsCollection(collectionIDs[s], hitsCollections[s]);
+    }
+    lastHit = nullptr;
+
+    digitize = digitizer && TrackOutput::GetSettings().schema == TrackOutput::Schema::Digits;
+    if (digitize) digitizer->Clear();
+}
+
 G4bool EICSensitiveDetector::ProcessHits(G4Step* step, G4TouchableHistory*)
 {
     if (!step) return false;
@@ -24,176 +78,157 @@ G4bool EICSensitiveDetector::ProcessHits(G4Step* step, G4TouchableHistory*)
 
     totalEnergyDeposit += edep;
 
-    auto preStepPoint = step->GetPreStepPoint();
     auto track = step->GetTrack();
-    auto pos = preStepPoint->GetPosition();
-    auto kineticEnergy = track->GetTotalEnergy();
     auto trackID = track->GetTrackID();
-    auto particleName = track->GetDefinition()->GetParticleName();
 
-    auto momentum = track->GetMomentum();
-    
-    auto px = momentum.x();
-    auto py = momentum.y();
-    auto pz = momentum.z();
-    
-    auto e = track->GetTotalEnergy();
-
-    auto it = trackInfos.find(trackID);
-    if (it == trackInfos.end()) {
-        trackInfos[trackID] = {trackID, particleName, pos, edep, kineticEnergy, px, py, pz, e};
-    } else {
-        it->second.energyDep += edep;
+    const auto pre = step->GetPreStepPoint();
+    const auto touchable = pre->GetTouchable();
+    const auto lvID = std::size_t(touchable->GetVolume()->GetLogicalVolume()->GetInstanceID());
+    if (lvID < volumes.size()) {
+        const Volume& volume = volumes[lvID];
+        if (volume.subsystem >= 0) {
+            if (lastHit && lastHit->trackID == trackID && lastSubsystem == volume.subsystem
+                && lastHit->layer == volume.layer) {
+                lastHit->energyDep += edep;
+            } else {
+                lastHit = new DetectorHit();
+                lastHit->trackID = trackID;
+                lastHit->pdg = track->GetDefinition()->GetPDGEncoding();
+                lastHit->layer = volume.layer;
+                lastHit->position = pre->GetPosition();
+                lastHit->time = pre->GetGlobalTime();
+                lastHit->energyDep = edep;
+                hitsCollections[volume.subsystem]->insert(lastHit);
+                lastSubsystem = volume.subsystem;
+            }
+        }
+        if (digitize && volume.readout >= 0) {
+            // Midpoint of the step, local coordinates of the segmented volume
+            const auto local = touchable->GetHistory()->GetTopTransform().TransformPoint(
+                0.5 * (pre->GetPosition() + step->GetPostStepPoint()->GetPosition()));
+            digitizer->Add(uint16_t(volume.readout), local.x() / cm, local.y() / cm, local.z() / cm, edep / keV);
+        }
+    }
+
+    if (auto hit = trackHits.Find(trackID)) {
+        hit->energyDep += edep;
+        return true;
     }
 
+    // First hit of this track: record position and momentum
+    auto pos = pre->GetPosition();
+    auto momentum = track->GetMomentum();
+
+    auto& hit = trackHits.Insert(trackID);
+    hit.pdg = track->GetDefinition()->GetPDGEncoding();
+    hit.x = pos.x();
+    hit.y = pos.y();
+    hit.z = pos.z();
+    hit.energyDep = edep;
+    hit.kineticEnergy = track->GetTotalEnergy();
+    hit.px = momentum.x();
+    hit.py = momentum.y();
+    hit.pz = momentum.z();
+    hit.e = track->GetTotalEnergy();
+
     return true;
 }
+G4bool EICSensitiveDetector::ProcessHits(const G4FastHit* hit, const G4FastTrack*, G4TouchableHistory*)
+{
+    totalEnergyDeposit += hit->GetEnergy();
+    return true;
+}
+
 void EICSensitiveDetector::EndOfEvent(G4HCofThisEvent*)
-{TString setup = "pp";
-    if(setup=="pp"){
-        static TFile* file = nullptr;
-        static TTree* tree = nullptr;
-        
-        static Int_t    trackID;
-        static Float_t  posX, posY, posZ;
-        static Float_t  energyDep;
-        static Float_t  kineticEnergy;
-        static char     particleName[50];
-        
-        static Float_t  px, py, pz, e;
-        
-        static Float_t xBj, x1, x2, xF, pT, mass, y;
-        
-        // Ajout des angles dans le lab
-        static Float_t theta, phi;
-        
-        if (!file) {
-            file = new TFile("tracks_output.root", "RECREATE");
-            tree = new TTree("TrackTree", "Track information per event");
-            
-            tree->Branch("TrackID", &trackID, "TrackID/I");
-            tree->Branch("ParticleName", particleName, "ParticleName/C");
-            tree->Branch("PosX", &posX, "PosX/F");
-            tree->Branch("PosY", &posY, "PosY/F");
-            tree->Branch("PosZ", &posZ, "PosZ/F");
-            tree->Branch("EnergyDeposit_GeV", &energyDep, "EnergyDeposit_GeV/F");
-            tree->Branch("KineticEnergy_GeV", &kineticEnergy, "KineticEnergy_GeV/F");
-            
-            tree->Branch("Px_GeV", &px, "Px_GeV/F");
-            tree->Branch("Py_GeV", &py, "Py_GeV/F");
-            tree->Branch("Pz_GeV", &pz, "Pz_GeV/F");
-            
-            tree->Branch("x1", &x1, "x1/F");
-            tree->Branch("x2", &x2, "x2/F");
-            tree->Branch("xF", &xF, "xF/F");
-            
-            tree->Branch("y", &y, "y/F");
-            
-            tree->Branch("pT", &pT, "pT/F");
-            tree->Branch("e", &e, "e/F");
-            tree->Branch("Mass", &mass, "Mass/F");
-            
-            tree->Branch("Theta_rad", &theta, "Theta_rad/F");
-            tree->Branch("Phi_rad", &phi, "Phi_rad/F");
-        }
-        
-        std::vector<const TrackInfo*> muPlusTracks;
-        std::vector<const TrackInfo*> muMinusTracks;
-        
-        for (const auto& [id, info] : trackInfos) {
-            if (info.particleName == "mu+") {
-                muPlusTracks.push_back(&info);
-            } else if (info.particleName == "mu-") {
-                muMinusTracks.push_back(&info);
-            }
+{
+    record.Clear();
+    const G4Event* event = G4EventManager::GetEventManager()->GetConstCurrentEvent();
+    record.eventID = event ? Production::GlobalEventID(event->GetEventID()) : -1;
+    record.edepTotal = totalEnergyDeposit / GeV;
+    if (event) {
+        if (auto info = dynamic_cast<const EventInformation*>(event->GetUserInformation())) {
+            record.weight = info->GetWeight();
         }
-        
-        double E_beam = 100.00 ;
-        
-        for (auto mup : muPlusTracks) {
-            for (auto mum : muMinusTracks) {
-                G4LorentzVector p1(
-                                   mup->px,
-                                   mup->py,
-                                   mup->pz,
-                                   mup->e
-                                   );
-                G4LorentzVector p2(
-                                   mum->px,
-                                   mum->py,
-                                   mum->pz,
-                                   mum->e
-                                   );
-                
-                G4LorentzVector pair = p1 + p2;
-                
-                double sqrt_s = sqrt(2.0 * E_beam * 0.938);
-                double s = sqrt_s * sqrt_s;
-                
-                TLorentzVector p_pair(pair.px() / GeV, pair.py() / GeV, pair.pz() / GeV, pair.e() / GeV);
-                
-                theta = p_pair.Theta();
-                phi   = p_pair.Phi();
-                
-                double E_p = E_beam;
-                double E_t = 0.938;
-                double beta_cm = (E_p - E_t) / (E_p + E_t);
-                TVector3 boost_vector(0, 0, -beta_cm);
-                
-                TLorentzVector p_pair_cm = p_pair;
-                p_pair_cm.Boost(boost_vector);
-                
-                double pL_cm = p_pair_cm.Pz();
-                xF = 2.0 * pL_cm / sqrt_s;
-                
-                pT = p_pair_cm.Pt();
-                mass = p_pair_cm.M();
-                
-                y = p_pair_cm.Rapidity();
-                
-                double delta = std::sqrt(xF * xF + 4.0 * mass * mass / s);
-                x1 = 0.5 * (xF + delta);
-                x2 = 0.5 * (-xF + delta);
-                
-                trackID = mup->trackID;
-                strncpy(particleName, mup->particleName.c_str(), sizeof(particleName));
-                particleName[sizeof(particleName)-1] = '\0';
-                
-                posX = mup->position.x() / mm;
-                posY = mup->position.y() / mm;
-                posZ = mup->position.z() / mm;
-                energyDep = mup->energyDep / GeV;
-                kineticEnergy = mup->kineticEnergy / GeV;
-                
-                px = mup->px / GeV;
-                py = mup->py / GeV;
-                pz = mup->pz / GeV;
-                e = mup->e / GeV;
-                
-                tree->Fill();
-                
-                trackID = mum->trackID;
-                strncpy(particleName, mum->particleName.c_str(), sizeof(particleName));
-                particleName[sizeof(particleName)-1] = '\0';
-                
-                posX = mum->position.x() / mm;
-                posY = mum->position.y() / mm;
-                posZ = mum->position.z() / mm;
-                energyDep = mum->energyDep / GeV;
-                kineticEnergy = mum->kineticEnergy / GeV;
-                
-                px = mum->px / GeV;
-                py = mum->py / GeV;
-                pz = mum->pz / GeV;
-                e = mum->e / GeV;
-                
-                tree->Fill();
-            }
+    }
+
+    muonTracks.clear();
+    for (const auto& hit : trackHits.Hits()) {
+        if (hit.pdg == -13 || hit.pdg == 13) muonTracks.push_back(&hit);
+    }
+
+    // Muons in trackID order, as before
+    std::sort(muonTracks.begin(), muonTracks.end(),
+              [](const TrackHit* a, const TrackHit* b) { return a->trackID < b->trackID; });
+
+    // Beam constants follow the generator settings (/eic/gen/beamEnergy),
+    // recomputed only when these changed
+    const auto& config = GeneratorConfig::Instance();
+    if (config.GetVersion() != beamVersion) {
+        beam = PairKinematics::BeamConstants::FixedTarget(config.GetBeamEnergy(), config.GetTargetMass());
+        beamVersion = config.GetVersion();
+    }
+
+    muPlus.Clear();
+    muMinus.Clear();
+    for (auto mu : muonTracks) {
+        const auto index = static_cast<int32_t>(record.muons.size());
+        record.muons.push_back({mu->trackID, mu->pdg,
+                                float(mu->x / mm), float(mu->y / mm), float(mu->z / mm),
+                                float(mu->energyDep / GeV), float(mu->kineticEnergy / GeV),
+                                float(mu->px / GeV), float(mu->py / GeV), float(mu->pz / GeV),
+                                float(mu->e / GeV)});
+
+        auto& soa = mu->pdg < 0 ? muPlus : muMinus;
+        soa.Add(index, mu->px / GeV, mu->py / GeV, mu->pz / GeV, mu->e / GeV);
+    }
+
+    PairKinematics::Compute(beam, muPlus, muMinus, pairs);
+
+    for (std::size_t k = 0; k < pairs.Size(); ++k) {
+        record.pairs.push_back({muPlus.index[pairs.iPlus[k]], muMinus.index[pairs.iMinus[k]],
+                                float(pairs.mass[k]), float(pairs.pT[k]), float(pairs.y[k]),
+                                float(pairs.xF[k]), float(pairs.x1[k]), float(pairs.x2[k]),
+                                float(pairs.theta[k]), float(pairs.phi[k])});
+    }
+
+    if (digitize) digitizer->Digitize(record.digits);
+    if (finder && TrackFinder::GetSettings().enabled) Reconstruct();
+
+    // Histograms also without track output
+    AnalysisManager::ThreadInstance().FillEvent(record);
+
+    // Every event is written, also those without muons
+    auto output = TrackOutput::GetInstance();
+    if (output->IsOpen()) output->Write(record);
+
+    trackHits.Clear();
+    totalEnergyDeposit = 0.;
+}
+
+void EICSensitiveDetector::Reconstruct()
+{
+    finder->Clear();
+    for (G4int s = 0; s < DetectorHit::kNSubsystems; ++s) {
+        const auto& layers = recoLayers[s];
+        if (layers.empty()) continue;
+        for (const DetectorHit* hit : *hitsCollections[s]->GetVector()) {
+            if (std::size_t(hit->layer) >= layers.size() || layers[hit->layer] < 0) continue;
+            finder->AddHit(layers[hit->layer], hit->position.x() / cm, hit->position.y() / cm,
+                           hit->position.z() / cm, hit->trackID);
         }
-        
-        trackInfos.clear();
-        totalEnergyDeposit = 0.;
-        
-        file->Write("", TObject::kOverwrite);
+    }
+
+    // Bending in the solenoid of this run; a map is taken at its nominal Bz
+    auto config = TrackFinder::GetSettings().config;
+    const auto& field = FieldSetup::GetSettings();
+    config.fieldBz = field.type == FieldSetup::Type::None ? 0. : field.uniformBz / tesla;
+    config.fieldZ = (field.origin.z() - field.halfLength) / cm;
+    finder->Find(config);
+    for (const auto& track : finder->Tracks()) {
+        uint32_t matched = 0;
+        const int32_t mcTrackID = finder->MajorityId(track, matched);
+        record.tracks.push_back({mcTrackID, uint16_t(track.nHits), uint16_t(matched),
+                                 float(track.x0 * cm / mm), float(track.y0 * cm / mm),
+                                 float(track.tx), float(track.ty), float(track.chi2)});
     }
 }
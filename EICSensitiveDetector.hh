@@ -2,38 +2,79 @@
 #define EICSensitiveDetector_h
 
 #include "G4VSensitiveDetector.hh"
+#include "G4VFastSimSensitiveDetector.hh"
 #include "globals.hh"
-#include <map>
-#include <vector>  
-#include <string>  
+#include "HitStore.hh"
+#include "PairKinematics.hh"
+#include "EventRecord.hh"
+#include "Readout.hh"
+#include "DetectorHit.hh"
+#include "TrackFinder.hh"
+#include <array>
+#include <memory>
+#include <vector>
 
-class EICSensitiveDetector : public G4VSensitiveDetector {
+class G4LogicalVolume;
+
+class EICSensitiveDetector : public G4VSensitiveDetector, public G4VFastSimSensitiveDetector {
 public:
+    // What a step in a logical volume feeds: subsystem hits collection and
+    // layer, readout map, TrackFinder layer (-1: none)
+    struct Volume {
+        G4int subsystem = -1;
+        G4int layer = 0;
+        G4int readout = -1;
+        G4int recoLayer = -1;
+    };
+
     EICSensitiveDetector(const G4String& name);
     virtual ~EICSensitiveDetector();
 
     virtual G4bool ProcessHits(G4Step* step, G4TouchableHistory* history) override;
+    // Energy spots of FastShowerModel: count in the total deposit only
+    virtual G4bool ProcessHits(const G4FastHit* hit, const G4FastTrack* track,
+                               G4TouchableHistory* history) override;
+    virtual void Initialize(G4HCofThisEvent* hce) override;
     virtual void EndOfEvent(G4HCofThisEvent* hce) override;
 
+    // Before the run (ConstructSDandField): identity of a sensitive volume,
+    // kept in a table by logical volume instance ID
+    void SetVolume(const G4LogicalVolume* lv, const Volume& volume);
+    // Channel maps of Volume::readout; deposits are digitized when the
+    // output schema is `digits`
+    void SetReadouts(const std::vector<ReadoutMap>& maps);
+    // Layers of Volume::recoLayer; tracks are reconstructed from the
+    // subsystem hits when /eic/reco/enable is set
+    void SetTrackingLayers(const std::vector<TrackFinder::Layer>& layers);
+
 private:
-    struct TrackInfo {
-        G4int trackID;
-        G4String particleName;
-        G4ThreeVector position;
-        G4double energyDep;
-        G4double kineticEnergy;
-
-       
-        G4double px;
-        G4double py;
-        G4double pz;
-        G4double e;
+    HitStore trackHits;
 
-    };
+    // Reused across events
+    std::vector<const TrackHit*> muonTracks;
+    PairKinematics::MuonSoA muPlus, muMinus;
+    PairKinematics::PairSoA pairs;
+    EventRecord record;
 
-    std::map<G4int, TrackInfo> trackInfos;  
+    PairKinematics::BeamConstants beam;
+    G4int beamVersion = -1;   // GeneratorConfig version of `beam`
 
     G4double totalEnergyDeposit = 0.;
+
+    // By logical volume instance ID: no name lookup on the step path
+    std::vector<Volume> volumes;
+    std::array<DetectorHitsCollection*, DetectorHit::kNSubsystems> hitsCollections{};
+    std::array<G4int, DetectorHit::kNSubsystems> collectionIDs;
+    DetectorHit* lastHit = nullptr;   // continued by the next step of the track in the layer
+    G4int lastSubsystem = -1;
+
+    std::unique_ptr<Digitizer> digitizer;
+    G4bool digitize = false;   // this event
+
+    void Reconstruct();
+    std::unique_ptr<TrackFinder> finder;
+    // TrackFinder layer by subsystem and layer, -1: not used
+    std::array<std::vector<G4int>, DetectorHit::kNSubsystems> recoLayers;
 };
 
 #endif // EICSensitiveDetector_h
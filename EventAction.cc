@@ -0,0 +1,22 @@
+#include "EventAction.hh"
+#include "SteppingAction.hh"
+#include "Log.hh"
+
+#include "G4Event.hh"
+
+EventAction::EventAction(SteppingAction* stepping)
+ : G4UserEventAction(),
+   fStepping(stepping)
+{}
+
+void EventAction::BeginOfEventAction(const G4Event* event)
+{
+    if (fStepping) fStepping->BeginOfEvent(event);
+}
+
+void EventAction::EndOfEventAction(const G4Event*)
+{
+    if (fStepping) fStepping->EndOfEvent();
+    // Messages of the event in one write
+    Log::Flush();
+}
@@ -0,0 +1,21 @@
+#ifndef EVENTACTION_HH
+#define EVENTACTION_HH
+
+#include "G4UserEventAction.hh"
+
+class SteppingAction;
+
+// Per-event bookkeeping of the other user actions
+class EventAction : public G4UserEventAction {
+public:
+    explicit EventAction(SteppingAction* stepping);
+    virtual ~EventAction() = default;
+
+    virtual void BeginOfEventAction(const G4Event* event) override;
+    virtual void EndOfEventAction(const G4Event* event) override;
+
+private:
+    SteppingAction* fStepping;
+};
+
+#endif
@@ -0,0 +1,22 @@
+#ifndef EVENTINFORMATION_HH
+#define EVENTINFORMATION_HH
+
+#include "G4VUserEventInformation.hh"
+#include "G4ios.hh"
+
+// Generator information carried by the G4Event (set in GeneratePrimaries)
+class EventInformation : public G4VUserEventInformation {
+public:
+    explicit EventInformation(G4double weight) : fWeight(weight) {}
+
+    // Generator weight (1 without bias); times the run's EventScale
+    // (RunInfo) it gives the events of one week of luminosity
+    G4double GetWeight() const { return fWeight; }
+
+    void Print() const override { G4cout << "Event weight: " << fWeight << G4endl; }
+
+private:
+    G4double fWeight;
+};
+
+#endif
@@ -0,0 +1,62 @@
+#ifndef EVENTRECORD_HH
+#define EVENTRECORD_HH
+
+#include <cstdint>
+#include <vector>
+
+// Output content of one event, independent of the file layout.
+// Units: mm and GeV. Pairs refer to muons by their position in `muons`.
+struct MuonRecord {
+    int32_t trackID;
+    int32_t pdg;
+    float   posX, posY, posZ;
+    float   energyDep;
+    float   kineticEnergy;
+    float   px, py, pz, e;
+};
+
+struct PairRecord {
+    int32_t iPlus, iMinus;
+    float   mass, pT, y, xF, x1, x2;
+    float   theta, phi;
+};
+
+// Detector-level hit: channel of readout map `detector` (Readout.hh)
+struct DigitRecord {
+    uint16_t detector;
+    uint16_t adc;
+    uint32_t channel;
+};
+
+// Reconstructed track (TrackFinder): x0/y0 at the target z, slopes up to
+// the coil entry (the bending past it is not stored)
+struct TrackRecord {
+    int32_t  mcTrackID;        // majority of the hits, -1 for noise
+    uint16_t nHits, nMatched;  // nMatched: hits of mcTrackID
+    float    x0, y0;
+    float    tx, ty;           // dx/dz, dy/dz
+    float    chi2;             // per degree of freedom
+};
+
+struct EventRecord {
+    int32_t eventID   = -1;
+    float   edepTotal = 0.f;   // all sensitive volumes, GeV
+    double  weight    = 1.;    // generator weight (EventInformation)
+    std::vector<MuonRecord> muons;
+    std::vector<PairRecord> pairs;
+    std::vector<DigitRecord> digits;   // Digits schema only
+    std::vector<TrackRecord> tracks;   // /eic/reco/enable only; not written
+
+    // Keeps the capacity: records are reused from event to event
+    void Clear() {
+        eventID = -1;
+        edepTotal = 0.f;
+        weight = 1.;
+        muons.clear();
+        pairs.clear();
+        digits.clear();
+        tracks.clear();
+    }
+};
+
+#endif
@@ -0,0 +1,136 @@
+#include "FastShowerModel.hh"
+
+#include "G4FastTrack.hh"
+#include "G4FastStep.hh"
+#include "G4FastHit.hh"
+#include "G4Track.hh"
+#include "G4Material.hh"
+#include "G4Navigator.hh"
+#include "G4TransportationManager.hh"
+#include "G4LogicalVolume.hh"
+#include "G4VPhysicalVolume.hh"
+#include "G4Element.hh"
+#include "G4Electron.hh"
+#include "G4Positron.hh"
+#include "G4Gamma.hh"
+#include "G4PhysicalConstants.hh"
+#include "Randomize.hh"
+
+#include <algorithm>
+#include <cmath>
+
+FastShowerModel::Settings FastShowerModel::fgSettings;
+
+namespace {
+    // How far ahead Absorber looks for the absorber (barrel: 1.6 cm of
+    // Al plate, air and Al before the SciGlass)
+    constexpr G4double kLookAhead = 20. * cm;
+    constexpr G4int kMaxVolumes = 16;
+}
+
+FastShowerModel::FastShowerModel(DetectorRegions::Id region, G4Region* envelope)
+ : G4VFastSimulationModel(G4String(DetectorRegions::Name(region)) + "Shower", envelope),
+   fRegion(region),
+   fHitMaker(std::make_unique<G4FastSimHitMaker>())
+{}
+
+FastShowerModel::~FastShowerModel() = default;
+
+G4bool FastShowerModel::IsApplicable(const G4ParticleDefinition& particle)
+{
+    return &particle == G4Electron::Definition() || &particle == G4Positron::Definition()
+        || &particle == G4Gamma::Definition();
+}
+
+G4bool FastShowerModel::ModelTrigger(const G4FastTrack& track)
+{
+    return fgSettings.enabled[fRegion]
+        && track.GetPrimaryTrack()->GetKineticEnergy() > fgSettings.eMin;
+}
+
+const FastShowerModel::MaterialParams& FastShowerModel::ParamsFor(const G4Material* material)
+{
+    auto it = fParams.find(material);
+    if (it != fParams.end()) return it->second;
+
+    // Mass-weighted Z of mixtures (PbSc, FeSc, SciGlass)
+    G4double z = 0.;
+    const auto elements = material->GetElementVector();
+    const auto fractions = material->GetFractionVector();
+    for (std::size_t i = 0; i < material->GetNumberOfElements(); ++i) {
+        z += fractions[i] * (*elements)[i]->GetZ();
+    }
+    MaterialParams params;
+    params.x0 = material->GetRadlen();
+    params.ec = 610. * MeV / (z + 1.24);
+    params.rm = 21.2 * MeV * params.x0 / params.ec;
+    return fParams.emplace(material, params).first->second;
+}
+
+const G4Material* FastShowerModel::Absorber(const G4ThreeVector& origin, const G4ThreeVector& axis,
+                                            const G4Region* region, G4double& distance)
+{
+    if (!fNavigator) {
+        fNavigator = std::make_unique<G4Navigator>();
+        fNavigator->SetWorldVolume(G4TransportationManager::GetTransportationManager()
+                                       ->GetNavigatorForTracking()->GetWorldVolume());
+    }
+
+    const G4Material* absorber = nullptr;
+    distance = 0.;
+    G4ThreeVector point = origin;
+    G4double travelled = 0.;
+    auto volume = fNavigator->LocateGlobalPointAndSetup(point, &axis, false, false);
+    for (G4int i = 0; i < kMaxVolumes && volume && volume->GetLogicalVolume()->GetRegion() == region; ++i) {
+        const auto material = volume->GetLogicalVolume()->GetMaterial();
+        if (!absorber || material->GetRadlen() < absorber->GetRadlen()) {
+            absorber = material;
+            distance = travelled;
+        }
+        G4double safety = 0.;
+        const G4double s = fNavigator->ComputeStep(point, axis, kLookAhead - travelled, safety);
+        if (travelled + s >= kLookAhead) break;
+        travelled += s;
+        point += s * axis;
+        fNavigator->SetGeometricallyLimitedStep();
+        volume = fNavigator->LocateGlobalPointAndSetup(point, &axis, true);
+    }
+    return absorber;
+}
+
+void FastShowerModel::DoIt(const G4FastTrack& track, G4FastStep& step)
+{
+    const auto primary = track.GetPrimaryTrack();
+    const G4double energy = primary->GetKineticEnergy()
+        + (primary->GetDefinition() == G4Positron::Definition() ? 2. * electron_mass_c2 : 0.);
+
+    step.KillPrimaryTrack();
+    step.ProposePrimaryTrackPathLength(0.);
+
+    // Shower from the front face of the absorber
+    G4double distance = 0.;
+    const G4ThreeVector axis = primary->GetMomentumDirection();
+    const auto absorber = Absorber(primary->GetPosition(), axis, track.GetEnvelope(), distance);
+    const auto& params = ParamsFor(absorber ? absorber : primary->GetMaterial());
+    const G4double y = energy / params.ec;
+    const G4double tMax = std::max(0.5, std::log(y) + (primary->GetDefinition() == G4Gamma::Definition() ? 0.5 : -0.5));
+    const G4double b = 0.5;
+    const G4double a = b * tMax + 1.;
+
+    const G4int nSpots = std::max(10, static_cast<G4int>(fgSettings.spots * energy / GeV));
+    const G4double spotEnergy = energy / nSpots;
+
+    const G4ThreeVector origin = primary->GetPosition() + distance * axis;
+    const G4ThreeVector u = axis.orthogonal().unit();
+    const G4ThreeVector v = axis.cross(u);
+
+    for (G4int i = 0; i < nSpots; ++i) {
+        const G4double t = G4RandGamma::shoot(a, 1.) / b;          // X0
+        const G4double q = G4UniformRand();
+        const G4double r = params.rm * std::sqrt(q / (1. - q + 1e-12));
+        const G4double phi = twopi * G4UniformRand();
+        const G4ThreeVector position = origin + t * params.x0 * axis
+                                     + r * (std::cos(phi) * u + std::sin(phi) * v);
+        fHitMaker->make(G4FastHit(position, spotEnergy), track);
+    }
+}
@@ -0,0 +1,65 @@
+#ifndef FASTSHOWERMODEL_HH
+#define FASTSHOWERMODEL_HH
+
+#include "G4VFastSimulationModel.hh"
+#include "G4FastSimHitMaker.hh"
+#include "G4SystemOfUnits.hh"
+#include "G4ThreeVector.hh"
+#include "DetectorRegions.hh"
+
+#include <array>
+#include <memory>
+#include <unordered_map>
+
+class G4Material;
+class G4Navigator;
+
+// Parameterised electromagnetic showers in the calorimeter regions.
+//
+// An e+, e- or photon above eMin entering the region is killed and its
+// energy laid down as spots: depth from the Gamma longitudinal profile
+// (t_max = ln(E/Ec) -/+ 0.5 for e/gamma, b = 0.5), radius from
+// f(r) ~ r R_M^2 / (r^2 + R_M^2)^2 around the entry direction. X0, Ec and
+// R_M are those of the absorber: the material with the shortest X0 met
+// along the entry direction inside the region (SciGlass behind the barrel
+// plates, PbSc or FeSc forward), where the shower starts. Spots in
+// sensitive volumes reach EICSensitiveDetector through G4FastSimHitMaker.
+//
+// One instance per region and thread (ConstructSDandField).
+class FastShowerModel : public G4VFastSimulationModel {
+public:
+    // Process-wide settings, set on the master (RegionMessenger)
+    struct Settings {
+        std::array<G4bool, DetectorRegions::kNRegions> enabled{};   // all off
+        G4double eMin  = 50. * MeV;
+        G4int    spots = 100;       // per GeV, at least 10 per shower
+    };
+    static Settings& GetSettings() { return fgSettings; }
+
+    FastShowerModel(DetectorRegions::Id region, G4Region* envelope);
+    virtual ~FastShowerModel();
+
+    virtual G4bool IsApplicable(const G4ParticleDefinition& particle) override;
+    virtual G4bool ModelTrigger(const G4FastTrack& track) override;
+    virtual void DoIt(const G4FastTrack& track, G4FastStep& step) override;
+
+private:
+    struct MaterialParams {
+        G4double x0;        // radiation length
+        G4double ec;        // critical energy
+        G4double rm;        // Moliere radius
+    };
+    const MaterialParams& ParamsFor(const G4Material* material);
+    // Absorber ahead of `origin` in this region, and the distance to it
+    const G4Material* Absorber(const G4ThreeVector& origin, const G4ThreeVector& axis,
+                               const G4Region* region, G4double& distance);
+
+    static Settings fgSettings;
+
+    DetectorRegions::Id fRegion;
+    std::unique_ptr<G4FastSimHitMaker> fHitMaker;
+    std::unique_ptr<G4Navigator> fNavigator;    // Absorber, not the tracking one
+    std::unordered_map<const G4Material*, MaterialParams> fParams;
+};
+
+#endif
@@ -0,0 +1,188 @@
+#ifndef FIELDGRID_HH
+#define FIELDGRID_HH
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Field map on a regular grid, either 2D (r, z) with (Br, Bz) or 3D
+// (x, y, z) with (Bx, By, Bz). No Geant4 dependency: positions in mm,
+// field in the units of the file (tesla for SolenoidField).
+//
+// Text format, '#' starts a comment:
+//   rz  nr nz rMin rMax zMin zMax                          then nr*nz lines "Br Bz"
+//   xyz nx ny nz xMin xMax yMin yMax zMin zMax             then nx*ny*nz lines "Bx By Bz"
+// the last coordinate running fastest. A node line that does not hold
+// exactly its components fails the load, with its line number.
+//
+// Node values are interleaved (all components of a node together) and the
+// last axis is contiguous, so the corners of a cell sit in two (2D) or
+// four (3D) short runs, read straight from the grid on every call.
+class FieldGrid {
+public:
+    enum class Kind { RZ, XYZ };
+
+    Kind Type() const { return fKind; }
+    std::size_t Nodes() const { return fValues.size() / Components(); }
+    int Components() const { return fKind == Kind::RZ ? 2 : 3; }
+
+    // Empty grid, values to be set with Node() (bench, tests of a map)
+    void Init(Kind kind, const int n[3], const double lo[3], const double hi[3]) {
+        fKind = kind;
+        const int axes = fKind == Kind::RZ ? 2 : 3;
+        for (int a = 0; a < 3; ++a) {
+            fN[a] = a < axes ? n[a] : 1;
+            fMin[a] = a < axes ? lo[a] : 0.;
+            fMax[a] = a < axes ? hi[a] : 0.;
+            fInv[a] = fN[a] > 1 ? (fN[a] - 1) / (fMax[a] - fMin[a]) : 0.;
+        }
+        fValues.assign(std::size_t(fN[0]) * fN[1] * fN[2] * Components(), 0.f);
+    }
+
+    float* Node(int i, int j, int k = 0) {
+        return &fValues[(std::size_t(i * fN[1] + j) * fN[2] + k) * Components()];
+    }
+
+    bool Load(const std::string& fileName, std::string& error) {
+        std::ifstream in(fileName);
+        if (!in) {
+            error = "cannot open " + fileName;
+            return false;
+        }
+        std::string line, tag;
+        std::vector<double> header;
+        int lineNumber = 0;
+        while (std::getline(in, line)) {
+            ++lineNumber;
+            if (line.empty() || line[0] == '#') continue;
+            std::istringstream is(line);
+            is >> tag;
+            double v;
+            while (is >> v) header.push_back(v);
+            break;
+        }
+        int n[3];
+        double lo[3], hi[3];
+        if (tag == "rz" && header.size() == 6) {
+            n[0] = int(header[0]); n[1] = int(header[1]);
+            lo[0] = header[2]; hi[0] = header[3];
+            lo[1] = header[4]; hi[1] = header[5];
+            Init(Kind::RZ, n, lo, hi);
+        } else if (tag == "xyz" && header.size() == 9) {
+            for (int a = 0; a < 3; ++a) {
+                n[a] = int(header[a]);
+                lo[a] = header[3 + 2 * a];
+                hi[a] = header[4 + 2 * a];
+            }
+            Init(Kind::XYZ, n, lo, hi);
+        } else {
+            error = fileName + ": expected an 'rz' or 'xyz' header";
+            return false;
+        }
+        for (int a = 0; a < (fKind == Kind::RZ ? 2 : 3); ++a) {
+            if (fN[a] < 2 || !(fMax[a] > fMin[a])) {
+                error = fileName + ": bad grid dimensions";
+                return false;
+            }
+        }
+
+        std::size_t i = 0;
+        while (i < fValues.size() && std::getline(in, line)) {
+            ++lineNumber;
+            if (line.empty() || line[0] == '#') continue;
+            std::istringstream is(line);
+            float v[3];
+            std::string rest;
+            int c = 0;
+            while (c < Components() && is >> v[c]) ++c;
+            if (c < Components() || (is >> rest && rest[0] != '#')) {
+                error = fileName + ":" + std::to_string(lineNumber) + ": expected "
+                      + std::to_string(Components()) + " field values, got '" + line + "'";
+                return false;
+            }
+            for (c = 0; c < Components(); ++c) fValues[i++] = v[c];
+        }
+        if (i != fValues.size()) {
+            error = fileName + ": " + std::to_string(i / Components()) + " nodes, expected "
+                  + std::to_string(Nodes());
+            return false;
+        }
+        return true;
+    }
+
+    // Field at (x, y, z) into b[3]; false (b untouched) outside the grid
+    bool Evaluate(double x, double y, double z, double b[3]) const {
+        return fKind == Kind::RZ ? EvaluateRZ(x, y, z, b) : EvaluateXYZ(x, y, z, b);
+    }
+
+private:
+    // Cell index and fraction along axis a; false outside
+    bool Locate(int a, double x, int& i, double& f) const {
+        const double u = (x - fMin[a]) * fInv[a];
+        if (!(u >= 0.) || u > fN[a] - 1) return false;
+        i = static_cast<int>(u);
+        if (i > fN[a] - 2) i = fN[a] - 2;
+        f = u - i;
+        return true;
+    }
+
+    bool EvaluateRZ(double x, double y, double z, double b[3]) const {
+        const double r = std::sqrt(x * x + y * y);
+        int i, k;
+        double fr, fz;
+        if (!Locate(0, r, i, fr) || !Locate(1, z, k, fz)) return false;
+
+        const std::size_t cell = std::size_t(i) * fN[1] + k;
+        const float* p0 = &fValues[cell * 2];                 // (i, k), (i, k+1)
+        const float* p1 = &fValues[(cell + fN[1]) * 2];       // (i+1, k), (i+1, k+1)
+        double v[2];
+        for (int n = 0; n < 2; ++n) {
+            const double low  = p0[n] + fz * (p0[2 + n] - p0[n]);
+            const double high = p1[n] + fz * (p1[2 + n] - p1[n]);
+            v[n] = low + fr * (high - low);
+        }
+        // Br along the radial direction (no Br on the axis)
+        const double cosPhi = r > 0. ? x / r : 0.;
+        const double sinPhi = r > 0. ? y / r : 0.;
+        b[0] = v[0] * cosPhi;
+        b[1] = v[0] * sinPhi;
+        b[2] = v[1];
+        return true;
+    }
+
+    bool EvaluateXYZ(double x, double y, double z, double b[3]) const {
+        int i, j, k;
+        double fx, fy, fz;
+        if (!Locate(0, x, i, fx) || !Locate(1, y, j, fy) || !Locate(2, z, k, fz)) return false;
+
+        // Runs of two nodes along z at (i, j), (i, j+1), (i+1, j), (i+1, j+1)
+        const std::size_t stride = std::size_t(fN[2]) * 3;
+        const float* p00 = &fValues[((std::size_t(i) * fN[1] + j) * fN[2] + k) * 3];
+        const float* p01 = p00 + stride;
+        const float* p10 = p00 + std::size_t(fN[1]) * stride;
+        const float* p11 = p10 + stride;
+        for (int n = 0; n < 3; ++n) {
+            const double c00 = p00[n] + fz * (p00[3 + n] - p00[n]);
+            const double c01 = p01[n] + fz * (p01[3 + n] - p01[n]);
+            const double c10 = p10[n] + fz * (p10[3 + n] - p10[n]);
+            const double c11 = p11[n] + fz * (p11[3 + n] - p11[n]);
+            const double c0 = c00 + fy * (c01 - c00);
+            const double c1 = c10 + fy * (c11 - c10);
+            b[n] = c0 + fx * (c1 - c0);
+        }
+        return true;
+    }
+
+    Kind   fKind = Kind::RZ;
+    int    fN[3] = {1, 1, 1};
+    double fMin[3] = {0., 0., 0.};
+    double fMax[3] = {0., 0., 0.};
+    double fInv[3] = {0., 0., 0.};
+    std::vector<float> fValues;
+};
+
+#endif
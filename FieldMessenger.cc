@@ -0,0 +1,124 @@
+#include "FieldMessenger.hh"
+#include "FieldSetup.hh"
+
+#include "G4UIdirectory.hh"
+#include "G4UIcmdWithADouble.hh"
+#include "G4UIcmdWithADoubleAndUnit.hh"
+#include "G4UIcmdWithAString.hh"
+#include "G4SystemOfUnits.hh"
+#include "G4ios.hh"
+
+FieldMessenger::FieldMessenger()
+{
+    fDirectory = new G4UIdirectory("/eic/field/");
+    fDirectory->SetGuidance("Solenoid magnetic field and propagation in field.");
+    fDirectory->SetGuidance("Applied by every thread at the start of the next run.");
+
+    fTypeCmd = new G4UIcmdWithAString("/eic/field/type", this);
+    fTypeCmd->SetGuidance("  none    : no field");
+    fTypeCmd->SetGuidance("  uniform : /eic/field/uniformBz inside the coil bore (default)");
+    fTypeCmd->SetGuidance("  map     : field map /eic/field/map, centred on the solenoid");
+    fTypeCmd->SetParameterName("type", false);
+    fTypeCmd->SetCandidates("none uniform map");
+    fTypeCmd->SetToBeBroadcasted(false);
+    fTypeCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+    fUniformBzCmd = new G4UIcmdWithADoubleAndUnit("/eic/field/uniformBz", this);
+    fUniformBzCmd->SetGuidance("Field of the uniform fallback.");
+    fUniformBzCmd->SetParameterName("Bz", false);
+    fUniformBzCmd->SetDefaultUnit("tesla");
+    fUniformBzCmd->SetToBeBroadcasted(false);
+    fUniformBzCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+    fMapCmd = new G4UIcmdWithAString("/eic/field/map", this);
+    fMapCmd->SetGuidance("Field map file ('rz' or 'xyz' grid, mm and tesla, see FieldGrid.hh).");
+    fMapCmd->SetGuidance("Also selects /eic/field/type map.");
+    fMapCmd->SetParameterName("file", false);
+    fMapCmd->SetToBeBroadcasted(false);
+    fMapCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+    fStepperCmd = new G4UIcmdWithAString("/eic/field/stepper", this);
+    fStepperCmd->SetGuidance("Integration stepper of the equation of motion.");
+    fStepperCmd->SetParameterName("stepper", false);
+    fStepperCmd->SetCandidates(FieldSetup::kSteppers);
+    fStepperCmd->SetToBeBroadcasted(false);
+    fStepperCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+    fMinStepCmd = NewLengthCommand("/eic/field/minStep", "Minimum step of the chord finder.");
+    fDeltaChordCmd = NewLengthCommand("/eic/field/deltaChord", "Maximum sagitta of a chord.");
+    fDeltaIntersectionCmd = NewLengthCommand("/eic/field/deltaIntersection",
+                                             "Accuracy of boundary intersections.");
+    fDeltaOneStepCmd = NewLengthCommand("/eic/field/deltaOneStep", "Accuracy of the end point of a step.");
+
+    fEpsilonMinCmd = new G4UIcmdWithADouble("/eic/field/epsilonMin", this);
+    fEpsilonMinCmd->SetGuidance("Minimum relative accuracy of a step.");
+    fEpsilonMinCmd->SetParameterName("eps", false);
+    fEpsilonMinCmd->SetRange("eps>0");
+    fEpsilonMinCmd->SetToBeBroadcasted(false);
+    fEpsilonMinCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+    fEpsilonMaxCmd = new G4UIcmdWithADouble("/eic/field/epsilonMax", this);
+    fEpsilonMaxCmd->SetGuidance("Maximum relative accuracy of a step.");
+    fEpsilonMaxCmd->SetParameterName("eps", false);
+    fEpsilonMaxCmd->SetRange("eps>0");
+    fEpsilonMaxCmd->SetToBeBroadcasted(false);
+    fEpsilonMaxCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+}
+
+FieldMessenger::~FieldMessenger()
+{
+    delete fTypeCmd;
+    delete fUniformBzCmd;
+    delete fMapCmd;
+    delete fStepperCmd;
+    delete fMinStepCmd;
+    delete fDeltaChordCmd;
+    delete fDeltaIntersectionCmd;
+    delete fDeltaOneStepCmd;
+    delete fEpsilonMinCmd;
+    delete fEpsilonMaxCmd;
+    delete fDirectory;
+}
+
+G4UIcmdWithADoubleAndUnit* FieldMessenger::NewLengthCommand(const char* path, const char* guidance)
+{
+    auto command = new G4UIcmdWithADoubleAndUnit(path, this);
+    command->SetGuidance(guidance);
+    command->SetParameterName("length", false);
+    command->SetRange("length>0");
+    command->SetDefaultUnit("mm");
+    command->SetToBeBroadcasted(false);
+    command->AvailableForStates(G4State_PreInit, G4State_Idle);
+    return command;
+}
+
+void FieldMessenger::SetNewValue(G4UIcommand* command, G4String newValue)
+{
+    auto& field = FieldSetup::GetSettings();
+
+    if (command == fTypeCmd) {
+        field.type = newValue == "uniform" ? FieldSetup::Type::Uniform
+                   : newValue == "map"     ? FieldSetup::Type::Map
+                                           : FieldSetup::Type::None;
+    } else if (command == fUniformBzCmd) {
+        field.uniformBz = fUniformBzCmd->GetNewDoubleValue(newValue);
+    } else if (command == fMapCmd) {
+        field.mapFile = newValue;
+        field.type = FieldSetup::Type::Map;
+    } else if (command == fStepperCmd) {
+        field.stepper = newValue;
+    } else if (command == fMinStepCmd) {
+        field.minStep = fMinStepCmd->GetNewDoubleValue(newValue);
+    } else if (command == fDeltaChordCmd) {
+        field.deltaChord = fDeltaChordCmd->GetNewDoubleValue(newValue);
+    } else if (command == fDeltaIntersectionCmd) {
+        field.deltaIntersection = fDeltaIntersectionCmd->GetNewDoubleValue(newValue);
+    } else if (command == fDeltaOneStepCmd) {
+        field.deltaOneStep = fDeltaOneStepCmd->GetNewDoubleValue(newValue);
+    } else if (command == fEpsilonMinCmd) {
+        field.epsilonMin = fEpsilonMinCmd->GetNewDoubleValue(newValue);
+    } else if (command == fEpsilonMaxCmd) {
+        field.epsilonMax = fEpsilonMaxCmd->GetNewDoubleValue(newValue);
+    }
+    FieldSetup::Changed();
+}
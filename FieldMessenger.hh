@@ -0,0 +1,36 @@
+#ifndef FIELDMESSENGER_HH
+#define FIELDMESSENGER_HH
+
+#include "G4UImessenger.hh"
+
+class G4UIdirectory;
+class G4UIcommand;
+class G4UIcmdWithADouble;
+class G4UIcmdWithADoubleAndUnit;
+class G4UIcmdWithAString;
+
+// /eic/field/ commands, applied on the master to FieldSetup::Settings
+class FieldMessenger : public G4UImessenger {
+public:
+    FieldMessenger();
+    virtual ~FieldMessenger();
+
+    virtual void SetNewValue(G4UIcommand* command, G4String newValue) override;
+
+private:
+    G4UIcmdWithADoubleAndUnit* NewLengthCommand(const char* path, const char* guidance);
+
+    G4UIdirectory*             fDirectory;
+    G4UIcmdWithAString*        fTypeCmd;
+    G4UIcmdWithADoubleAndUnit* fUniformBzCmd;
+    G4UIcmdWithAString*        fMapCmd;
+    G4UIcmdWithAString*        fStepperCmd;
+    G4UIcmdWithADoubleAndUnit* fMinStepCmd;
+    G4UIcmdWithADoubleAndUnit* fDeltaChordCmd;
+    G4UIcmdWithADoubleAndUnit* fDeltaIntersectionCmd;
+    G4UIcmdWithADoubleAndUnit* fDeltaOneStepCmd;
+    G4UIcmdWithADouble*        fEpsilonMinCmd;
+    G4UIcmdWithADouble*        fEpsilonMaxCmd;
+};
+
+#endif
@@ -0,0 +1,119 @@
+#include "FieldSetup.hh"
+#include "SolenoidField.hh"
+#include "FieldGrid.hh"
+
+#include "G4TransportationManager.hh"
+#include "G4FieldManager.hh"
+#include "G4ChordFinder.hh"
+#include "G4Mag_UsualEqRhs.hh"
+#include "G4ClassicalRK4.hh"
+#include "G4CashKarpRKF45.hh"
+#include "G4DormandPrince745.hh"
+#include "G4BogackiShampine23.hh"
+#include "G4HelixExplicitEuler.hh"
+#include "G4Threading.hh"
+#include "G4AutoLock.hh"
+#include "G4ios.hh"
+
+#include <map>
+
+FieldSetup::Settings FieldSetup::fgSettings;
+std::atomic<G4int> FieldSetup::fgVersion{0};
+const char* const FieldSetup::kSteppers =
+    "DormandPrince745 ClassicalRK4 CashKarpRKF45 BogackiShampine23 HelixExplicitEuler";
+
+namespace {
+    G4Mutex gGridMutex = G4MUTEX_INITIALIZER;
+
+    // One grid per file for the whole process
+    std::shared_ptr<const FieldGrid> LoadGrid(const G4String& fileName) {
+        G4AutoLock lock(&gGridMutex);
+        static std::map<G4String, std::shared_ptr<const FieldGrid>> grids;
+        auto it = grids.find(fileName);
+        if (it != grids.end()) return it->second;
+
+        auto grid = std::make_shared<FieldGrid>();
+        std::string error;
+        if (!grid->Load(fileName, error)) {
+            G4cerr << "Error: field map " << error << G4endl;
+            return nullptr;
+        }
+        G4cout << "[FIELD] " << fileName << ": " << grid->Nodes() << " nodes ("
+               << (grid->Type() == FieldGrid::Kind::RZ ? "r,z" : "x,y,z") << ")" << G4endl;
+        return grids[fileName] = grid;
+    }
+
+    G4MagIntegratorStepper* MakeStepper(const G4String& name, G4Mag_UsualEqRhs* equation) {
+        if (name == "ClassicalRK4")       return new G4ClassicalRK4(equation);
+        if (name == "CashKarpRKF45")      return new G4CashKarpRKF45(equation);
+        if (name == "BogackiShampine23")  return new G4BogackiShampine23(equation);
+        if (name == "HelixExplicitEuler") return new G4HelixExplicitEuler(equation);
+        return new G4DormandPrince745(equation);
+    }
+}
+
+const char* FieldSetup::TypeName(Type type) {
+    switch (type) {
+        case Type::Uniform: return "uniform";
+        case Type::Map:     return "map";
+        default:            return "none";
+    }
+}
+
+FieldSetup& FieldSetup::ThreadInstance() {
+    static G4ThreadLocal FieldSetup* instance = nullptr;
+    if (!instance) instance = new FieldSetup();
+    return *instance;
+}
+
+G4long FieldSetup::GetCalls() const {
+    return fRetiredCalls + (fField ? fField->GetCalls() : 0);
+}
+
+void FieldSetup::Release() {
+    auto fieldManager = G4TransportationManager::GetTransportationManager()->GetFieldManager();
+    fieldManager->SetDetectorField(nullptr);
+    fieldManager->SetChordFinder(nullptr);
+
+    if (fField) fRetiredCalls += fField->GetCalls();
+    fChordFinder.reset();
+    fStepper.reset();
+    fEquation.reset();
+    fField.reset();
+}
+
+void FieldSetup::Update() {
+    const G4int version = fgVersion.load(std::memory_order_acquire);
+    if (version == fVersion) return;
+    fVersion = version;
+    Release();
+
+    const auto& s = fgSettings;
+    if (s.type == Type::Map) {
+        auto grid = LoadGrid(s.mapFile);
+        if (!grid) return;   // no field rather than a wrong one
+        fField = std::make_unique<SolenoidField>(grid, s.origin);
+    } else if (s.type == Type::Uniform) {
+        fField = std::make_unique<SolenoidField>(s.uniformBz, s.boreRadius, s.halfLength, s.origin);
+    } else {
+        return;
+    }
+
+    fEquation = std::make_unique<G4Mag_UsualEqRhs>(fField.get());
+    fStepper.reset(MakeStepper(s.stepper, fEquation.get()));
+    fChordFinder = std::make_unique<G4ChordFinder>(fField.get(), s.minStep, fStepper.get());
+    fChordFinder->SetDeltaChord(s.deltaChord);
+
+    auto fieldManager = G4TransportationManager::GetTransportationManager()->GetFieldManager();
+    fieldManager->SetDetectorField(fField.get());
+    fieldManager->SetChordFinder(fChordFinder.get());
+    fieldManager->SetDeltaIntersection(s.deltaIntersection);
+    fieldManager->SetDeltaOneStep(s.deltaOneStep);
+    fieldManager->SetMinimumEpsilonStep(s.epsilonMin);
+    fieldManager->SetMaximumEpsilonStep(s.epsilonMax);
+
+    if (G4Threading::IsMasterThread()) {
+        G4cout << "[FIELD] " << TypeName(s.type) << " field, " << s.stepper << " stepper, minStep "
+               << s.minStep / mm << " mm, deltaChord " << s.deltaChord / mm << " mm" << G4endl;
+    }
+}
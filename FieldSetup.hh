@@ -0,0 +1,72 @@
+#ifndef FIELDSETUP_HH
+#define FIELDSETUP_HH
+
+#include "globals.hh"
+#include "G4SystemOfUnits.hh"
+#include "G4ThreeVector.hh"
+
+#include <atomic>
+#include <memory>
+
+class FieldGrid;
+class SolenoidField;
+class G4Mag_UsualEqRhs;
+class G4MagIntegratorStepper;
+class G4ChordFinder;
+
+// Magnetic field of the solenoid and its propagation settings.
+// Settings are set on the master between runs (FieldMessenger); each thread
+// owns a FieldSetup that rebuilds its field, stepper and chord finder when
+// the settings changed since (ConstructSDandField and the worker's
+// BeginOfRunAction). Field maps are loaded once and shared by the threads.
+class FieldSetup {
+public:
+    enum class Type { None, Uniform, Map };
+
+    struct Settings {
+        Type          type = Type::Uniform;   // the 1.7 T solenoid; None to switch it off
+        G4double      uniformBz  = 1.7 * tesla;
+        G4double      boreRadius = 142. * cm;           // coil inner radius
+        G4double      halfLength = 192. * cm;
+        G4ThreeVector origin = G4ThreeVector(0., 0., -10. * cm);   // solenoid centre, also the map origin
+        G4String      mapFile;
+        G4String      stepper = "DormandPrince745";
+        G4double      minStep = 0.01 * mm;
+        G4double      deltaChord = 0.25 * mm;
+        G4double      deltaIntersection = 0.001 * mm;
+        G4double      deltaOneStep = 0.01 * mm;
+        G4double      epsilonMin = 5.e-5;
+        G4double      epsilonMax = 1.e-3;
+    };
+    static Settings& GetSettings() { return fgSettings; }
+    // After any change of the settings (master)
+    static void Changed() { fgVersion.fetch_add(1, std::memory_order_acq_rel); }
+
+    static const char* TypeName(Type type);
+    static const char* const kSteppers;   // candidates of /eic/field/stepper
+
+    // This thread's setup
+    static FieldSetup& ThreadInstance();
+
+    // Rebuilds the field of this thread if the settings changed
+    void Update();
+
+    // Field evaluations of this thread, cumulative
+    G4long GetCalls() const;
+
+private:
+    FieldSetup() = default;
+    void Release();
+
+    static Settings fgSettings;
+    static std::atomic<G4int> fgVersion;
+
+    G4int fVersion = -1;
+    G4long fRetiredCalls = 0;    // of the fields released so far
+    std::unique_ptr<SolenoidField> fField;
+    std::unique_ptr<G4Mag_UsualEqRhs> fEquation;
+    std::unique_ptr<G4MagIntegratorStepper> fStepper;
+    std::unique_ptr<G4ChordFinder> fChordFinder;
+};
+
+#endif
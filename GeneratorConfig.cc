@@ -0,0 +1,113 @@
+#include "GeneratorConfig.hh"
+
+#include "Pythia8/Pythia.h"
+
+#include <cmath>
+#include <memory>
+#include <sstream>
+
+namespace {
+    // Phase-space bias of the weighted production (see GeneratorConfig::Bias)
+    class BiasHooks : public Pythia8::UserHooks {
+    public:
+        explicit BiasHooks(const GeneratorConfig::Bias& bias) : fBias(bias) {}
+
+        bool canBiasSelection() override { return true; }
+
+        double biasSelection(const Pythia8::SigmaProcess*, const Pythia8::PhaseSpace* phaseSpacePtr,
+                             bool) override {
+            const double mHat = std::sqrt(phaseSpacePtr->sHat());
+            const double xF = phaseSpacePtr->x1() - phaseSpacePtr->x2();
+            return std::pow(mHat / fBias.massRef, fBias.massPower)
+                 * std::pow(1. + xF, fBias.xFPower);
+        }
+
+    private:
+        GeneratorConfig::Bias fBias;
+    };
+}
+
+GeneratorConfig& GeneratorConfig::Instance() {
+    static GeneratorConfig config;
+    return config;
+}
+
+const char* GeneratorConfig::ProcessName(Process process) {
+    switch (process) {
+        case Process::OpenCharm:  return "opencharm";
+        case Process::SingleMuon: return "singlemuon";
+        default:                  return "charmonium";
+    }
+}
+
+void GeneratorConfig::SetBeamEnergy(G4double energy) {
+    if (energy == fBeamEnergy) return;
+    fBeamEnergy = energy;
+    Changed();
+}
+
+void GeneratorConfig::SetProcess(Process process) {
+    if (process == fProcess) return;
+    fProcess = process;
+    Changed();
+}
+
+void GeneratorConfig::SetBias(const Bias& bias) {
+    if (bias == fBias) return;
+    fBias = bias;
+    Changed();
+}
+
+void GeneratorConfig::SetGun(const Gun& gun) {
+    if (gun == fGun) return;
+    fGun = gun;
+    Changed();
+}
+
+void GeneratorConfig::AddString(const std::string& line) {
+    fExtraStrings.push_back(line);
+    Changed();
+}
+
+void GeneratorConfig::ClearStrings() {
+    if (fExtraStrings.empty()) return;
+    fExtraStrings.clear();
+    Changed();
+}
+
+void GeneratorConfig::Apply(Pythia8::Pythia& pythia) const
+{
+    // Config Pythia fixed target
+    std::ostringstream eA;
+    eA << "Beams:eA = " << fBeamEnergy;
+    pythia.readString("Beams:idA = 2212");
+    pythia.readString("Beams:idB = 2212");
+    pythia.readString(eA.str());
+    pythia.readString("Beams:eB = 0.");
+    pythia.readString("Beams:frameType = 2");
+    //pythia.readString("HardQCD:all = on");
+
+    if (fProcess == Process::Charmonium) {
+        pythia.readString("Charmonium:all = on");
+        pythia.readString("443:onMode = off");
+        pythia.readString("443:onIfMatch = 13 -13");
+
+        pythia.readString("100443:onMode = off");
+        pythia.readString("100443:onIfMatch = 13 -13");
+    } else if (fProcess == Process::OpenCharm) {
+        // ccbar
+        pythia.readString("HardQCD:hardccbar = on");
+
+        // To muons
+        // D0 (421), D+ (411), D_s+ (431) and opp.c
+        for (auto id : {"421", "-421", "411", "-411", "431", "-431"}) {
+            pythia.readString(std::string(id) + ":onMode = off");
+            pythia.readString(std::string(id) + ":onIfAny = 13");
+        }
+    }
+
+    if (fBias.enabled) pythia.setUserHooksPtr(std::make_shared<BiasHooks>(fBias));
+
+    // Macro additions last, so that they override the above
+    for (const auto& line : fExtraStrings) pythia.readString(line);
+}
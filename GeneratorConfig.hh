@@ -0,0 +1,82 @@
+#ifndef GENERATORCONFIG_HH
+#define GENERATORCONFIG_HH
+
+#include "globals.hh"
+
+#include <atomic>
+#include <string>
+#include <vector>
+
+namespace Pythia8 { class Pythia; }
+
+// Pythia settings of the run: beam, process and extra readString lines.
+// Set on the master between runs (GeneratorMessenger), read by every
+// Pythia instance and by the pair kinematics (beam energy).
+// Every actual change bumps the version: a Pythia built from an older
+// version is re-initialised before its next event, an unchanged setup is not.
+class GeneratorConfig {
+public:
+    enum class Process { Charmonium, OpenCharm, SingleMuon };
+
+    // SingleMuon: one mu+ or mu- per event, no Pythia. Momentum flat in
+    // [pMin, pMax], direction flat in solid angle within thetaMax of +z.
+    struct Gun {
+        G4double pMin     = 2.;     // GeV
+        G4double pMax     = 20.;    // GeV
+        G4double thetaMax = 0.3;    // rad
+        bool operator==(const Gun& o) const {
+            return pMin == o.pMin && pMax == o.pMax && thetaMax == o.thetaMax;
+        }
+    };
+
+    // Weighted production: hard-process selection biased by
+    // (mHat / massRef)^massPower * (1 + x1 - x2)^xFPower, i.e. toward high
+    // mass and high xF; Pythia's event weight compensates the bias.
+    struct Bias {
+        G4bool   enabled   = false;
+        G4double massRef   = 3.;    // GeV
+        G4double massPower = 2.;
+        G4double xFPower   = 2.;
+        bool operator==(const Bias& o) const {
+            return enabled == o.enabled && massRef == o.massRef &&
+                   massPower == o.massPower && xFPower == o.xFPower;
+        }
+    };
+
+    static GeneratorConfig& Instance();
+
+    G4double GetBeamEnergy() const { return fBeamEnergy; }   // GeV, fixed target
+    G4double GetTargetMass() const { return 0.938; }         // GeV, proton target
+    Process  GetProcess() const { return fProcess; }
+    const std::vector<std::string>& GetExtraStrings() const { return fExtraStrings; }
+    const Bias& GetBias() const { return fBias; }
+    const Gun& GetGun() const { return fGun; }
+
+    void SetBeamEnergy(G4double energy);
+    void SetProcess(Process process);
+    void SetBias(const Bias& bias);
+    void SetGun(const Gun& gun);
+    void AddString(const std::string& line);
+    void ClearStrings();
+
+    G4int GetVersion() const { return fVersion.load(std::memory_order_acquire); }
+
+    // readString calls and user hooks for the current settings (before
+    // Pythia::init)
+    void Apply(Pythia8::Pythia& pythia) const;
+
+    static const char* ProcessName(Process process);
+
+private:
+    GeneratorConfig() = default;
+    void Changed() { fVersion.fetch_add(1, std::memory_order_acq_rel); }
+
+    G4double fBeamEnergy = 100.;
+    Process  fProcess = Process::Charmonium;
+    Bias     fBias;
+    Gun      fGun;
+    std::vector<std::string> fExtraStrings;
+    std::atomic<G4int> fVersion{0};
+};
+
+#endif
@@ -0,0 +1,325 @@
+#include "GeneratorMessenger.hh"
+#include "GeneratorConfig.hh"
+#include "GeneratorPool.hh"
+#include "PrimaryCache.hh"
+#include "AcceptanceFilter.hh"
+#include "Luminosity.hh"
+
+#include "G4UIdirectory.hh"
+#include "G4UIcommand.hh"
+#include "G4UIparameter.hh"
+#include "G4UIcmdWithAnInteger.hh"
+#include "G4UIcmdWithABool.hh"
+#include "G4UIcmdWithADouble.hh"
+#include "G4UIcmdWithADoubleAndUnit.hh"
+#include "G4UIcmdWithAString.hh"
+#include "G4UIcmdWithoutParameter.hh"
+#include "G4SystemOfUnits.hh"
+#include "G4ios.hh"
+
+#include <sstream>
+
+GeneratorMessenger::GeneratorMessenger()
+{
+    fDirectory = new G4UIdirectory("/eic/gen/");
+    fDirectory->SetGuidance("Pythia event generation.");
+    fDirectory->SetGuidance("Pythia is re-initialised only if a setting changed since the last run.");
+
+    fBeamEnergyCmd = new G4UIcmdWithADoubleAndUnit("/eic/gen/beamEnergy", this);
+    fBeamEnergyCmd->SetGuidance("Proton beam energy on the fixed proton target.");
+    fBeamEnergyCmd->SetGuidance("Also used for the pair kinematics (sqrt(s), CM boost).");
+    fBeamEnergyCmd->SetParameterName("E", false);
+    fBeamEnergyCmd->SetRange("E>0");
+    fBeamEnergyCmd->SetDefaultUnit("GeV");
+    fBeamEnergyCmd->SetToBeBroadcasted(false);
+    fBeamEnergyCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+    fProcessCmd = new G4UIcmdWithAString("/eic/gen/process", this);
+    fProcessCmd->SetGuidance("Hard process and forced decays:");
+    fProcessCmd->SetGuidance("  charmonium : Charmonium:all, J/psi and psi(2S) -> mu+ mu-");
+    fProcessCmd->SetGuidance("  opencharm  : HardQCD:hardccbar, D0/D+/Ds -> mu + X");
+    fProcessCmd->SetGuidance("  singlemuon : one mu+ or mu- per event, no Pythia (/eic/gen/gun/)");
+    fProcessCmd->SetParameterName("process", false);
+    fProcessCmd->SetCandidates("charmonium opencharm singlemuon");
+    fProcessCmd->SetToBeBroadcasted(false);
+    fProcessCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+    fReadStringCmd = new G4UIcmdWithAString("/eic/gen/readString", this);
+    fReadStringCmd->SetGuidance("Extra Pythia setting, applied after the process settings.");
+    fReadStringCmd->SetGuidance("e.g. /eic/gen/readString PhaseSpace:pTHatMin = 1.");
+    fReadStringCmd->SetParameterName("line", false);
+    fReadStringCmd->SetToBeBroadcasted(false);
+    fReadStringCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+    fClearStringsCmd = new G4UIcmdWithoutParameter("/eic/gen/clearStrings", this);
+    fClearStringsCmd->SetGuidance("Forget the /eic/gen/readString settings.");
+    fClearStringsCmd->SetToBeBroadcasted(false);
+    fClearStringsCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+    fPregenThreadsCmd = new G4UIcmdWithAnInteger("/eic/gen/pregenThreads", this);
+    fPregenThreadsCmd->SetGuidance("Dedicated Pythia threads filling a ring of pre-generated events.");
+    fPregenThreadsCmd->SetGuidance("0 = each worker runs its own Pythia (default).");
+    fPregenThreadsCmd->SetParameterName("N", false);
+    fPregenThreadsCmd->SetRange("N>=0");
+    fPregenThreadsCmd->SetToBeBroadcasted(false);
+    fPregenThreadsCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+    fPregenCapacityCmd = new G4UIcmdWithAnInteger("/eic/gen/pregenCapacity", this);
+    fPregenCapacityCmd->SetGuidance("Events held in the pre-generation ring.");
+    fPregenCapacityCmd->SetParameterName("N", false);
+    fPregenCapacityCmd->SetRange("N>=2");
+    fPregenCapacityCmd->SetToBeBroadcasted(false);
+    fPregenCapacityCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+    fPregenSeedCmd = new G4UIcmdWithAnInteger("/eic/gen/pregenSeed", this);
+    fPregenSeedCmd->SetGuidance("Base of the generator threads' Pythia streams: each thread, run and");
+    fPregenSeedCmd->SetGuidance("shard gets its own seed from it. 0 = drawn at start-up (default).");
+    fPregenSeedCmd->SetParameterName("seed", false);
+    fPregenSeedCmd->SetRange("seed>=0");
+    fPregenSeedCmd->SetToBeBroadcasted(false);
+    fPregenSeedCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+    fCacheCmd = new G4UIcommand("/eic/gen/cache", this);
+    fCacheCmd->SetGuidance("Primary cache (muons of each generated event):");
+    fCacheCmd->SetGuidance("  record : write the primaries of the next runs to <file>");
+    fCacheCmd->SetGuidance("  replay : take the primaries from <file>, Pythia is not run");
+    fCacheCmd->SetGuidance("  off    : generate with Pythia (default)");
+    auto mode = new G4UIparameter("mode", 's', false);
+    mode->SetParameterCandidates("off record replay");
+    fCacheCmd->SetParameter(mode);
+    auto file = new G4UIparameter("file", 's', true);
+    file->SetDefaultValue("primaries.bin");
+    fCacheCmd->SetParameter(file);
+    fCacheCmd->SetToBeBroadcasted(false);
+    fCacheCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+    fFilterDirectory = new G4UIdirectory("/eic/gen/filter/");
+    fFilterDirectory->SetGuidance("Generator-level FVTX acceptance filter (straight lines from the target).");
+
+    fFilterEnableCmd = new G4UIcmdWithABool("/eic/gen/filter/enable", this);
+    fFilterEnableCmd->SetGuidance("Regenerate Pythia events until enough muons hit an FVTX disk.");
+    fFilterEnableCmd->SetParameterName("enable", true);
+    fFilterEnableCmd->SetDefaultValue(true);
+    fFilterEnableCmd->SetToBeBroadcasted(false);
+    fFilterEnableCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+    fFilterMinMuonsCmd = new G4UIcmdWithAnInteger("/eic/gen/filter/minMuons", this);
+    fFilterMinMuonsCmd->SetGuidance("Muons required in acceptance (2 = both muons of a pair).");
+    fFilterMinMuonsCmd->SetParameterName("N", false);
+    fFilterMinMuonsCmd->SetRange("N>=1");
+    fFilterMinMuonsCmd->SetToBeBroadcasted(false);
+    fFilterMinMuonsCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+    fFilterPMinCmd = new G4UIcmdWithADoubleAndUnit("/eic/gen/filter/pMin", this);
+    fFilterPMinCmd->SetGuidance("Minimum momentum of a muon in acceptance.");
+    fFilterPMinCmd->SetParameterName("p", false);
+    fFilterPMinCmd->SetRange("p>=0");
+    fFilterPMinCmd->SetDefaultUnit("GeV");
+    fFilterPMinCmd->SetToBeBroadcasted(false);
+    fFilterPMinCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+    fFilterRMinCmd = new G4UIcmdWithADoubleAndUnit("/eic/gen/filter/rMin", this);
+    fFilterRMinCmd->SetGuidance("Inner radius of the disks.");
+    fFilterRMinCmd->SetParameterName("r", false);
+    fFilterRMinCmd->SetRange("r>=0");
+    fFilterRMinCmd->SetDefaultUnit("mm");
+    fFilterRMinCmd->SetToBeBroadcasted(false);
+    fFilterRMinCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+    fFilterRMaxCmd = new G4UIcmdWithADoubleAndUnit("/eic/gen/filter/rMax", this);
+    fFilterRMaxCmd->SetGuidance("Outer radius of the disks.");
+    fFilterRMaxCmd->SetParameterName("r", false);
+    fFilterRMaxCmd->SetRange("r>0");
+    fFilterRMaxCmd->SetDefaultUnit("mm");
+    fFilterRMaxCmd->SetToBeBroadcasted(false);
+    fFilterRMaxCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+    fFilterMaxTrialsCmd = new G4UIcmdWithAnInteger("/eic/gen/filter/maxTrials", this);
+    fFilterMaxTrialsCmd->SetGuidance("Give up (empty event) after N rejected Pythia events.");
+    fFilterMaxTrialsCmd->SetParameterName("N", false);
+    fFilterMaxTrialsCmd->SetRange("N>=1");
+    fFilterMaxTrialsCmd->SetToBeBroadcasted(false);
+    fFilterMaxTrialsCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+    fWeightDirectory = new G4UIdirectory("/eic/gen/weight/");
+    fWeightDirectory->SetGuidance("Weighted production: events normalised to one week of luminosity.");
+    fWeightDirectory->SetGuidance("Weight = Pythia weight; events/week = Weight x EventScale (RunInfo),");
+    fWeightDirectory->SetGuidance("EventScale = (events/week) / (Pythia events generated, filter trials included).");
+
+    fWeightSigmaCmd = new G4UIcmdWithADouble("/eic/gen/weight/sigma", this);
+    fWeightSigmaCmd->SetGuidance("Cross section [mb] for the normalisation, 0 = unnormalised weights.");
+    fWeightSigmaCmd->SetParameterName("sigma", false);
+    fWeightSigmaCmd->SetRange("sigma>=0");
+    fWeightSigmaCmd->SetToBeBroadcasted(false);
+    fWeightSigmaCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+    fWeightTargetCmd = new G4UIcmdWithAString("/eic/gen/weight/target", this);
+    fWeightTargetCmd->SetGuidance("Target material of the luminosity (1 cm thick).");
+    fWeightTargetCmd->SetParameterName("target", false);
+    fWeightTargetCmd->SetCandidates("H BE C AL CU PB U");
+    fWeightTargetCmd->SetToBeBroadcasted(false);
+    fWeightTargetCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+    fBiasEnableCmd = new G4UIcmdWithABool("/eic/gen/weight/bias", this);
+    fBiasEnableCmd->SetGuidance("Bias the hard process toward high mass and high xF:");
+    fBiasEnableCmd->SetGuidance("  (mHat / massRef)^massPower * (1 + x1 - x2)^xFPower");
+    fBiasEnableCmd->SetParameterName("enable", true);
+    fBiasEnableCmd->SetDefaultValue(true);
+    fBiasEnableCmd->SetToBeBroadcasted(false);
+    fBiasEnableCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+    fBiasMassRefCmd = new G4UIcmdWithADoubleAndUnit("/eic/gen/weight/massRef", this);
+    fBiasMassRefCmd->SetGuidance("Reference mass of the bias (bias 1 at mHat = massRef, xF = 0).");
+    fBiasMassRefCmd->SetParameterName("m", false);
+    fBiasMassRefCmd->SetRange("m>0");
+    fBiasMassRefCmd->SetDefaultUnit("GeV");
+    fBiasMassRefCmd->SetToBeBroadcasted(false);
+    fBiasMassRefCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+    fBiasMassPowerCmd = new G4UIcmdWithADouble("/eic/gen/weight/massPower", this);
+    fBiasMassPowerCmd->SetGuidance("Power of mHat / massRef in the bias.");
+    fBiasMassPowerCmd->SetParameterName("n", false);
+    fBiasMassPowerCmd->SetToBeBroadcasted(false);
+    fBiasMassPowerCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+    fBiasXFPowerCmd = new G4UIcmdWithADouble("/eic/gen/weight/xFPower", this);
+    fBiasXFPowerCmd->SetGuidance("Power of 1 + xF in the bias.");
+    fBiasXFPowerCmd->SetParameterName("n", false);
+    fBiasXFPowerCmd->SetToBeBroadcasted(false);
+    fBiasXFPowerCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+    fGunDirectory = new G4UIdirectory("/eic/gen/gun/");
+    fGunDirectory->SetGuidance("Single muons (/eic/gen/process singlemuon) from the target.");
+
+    fGunPMinCmd = new G4UIcmdWithADoubleAndUnit("/eic/gen/gun/pMin", this);
+    fGunPMinCmd->SetGuidance("Lowest muon momentum (flat in p).");
+    fGunPMinCmd->SetParameterName("p", false);
+    fGunPMinCmd->SetRange("p>0");
+    fGunPMinCmd->SetDefaultUnit("GeV");
+    fGunPMinCmd->SetToBeBroadcasted(false);
+    fGunPMinCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+    fGunPMaxCmd = new G4UIcmdWithADoubleAndUnit("/eic/gen/gun/pMax", this);
+    fGunPMaxCmd->SetGuidance("Highest muon momentum (flat in p).");
+    fGunPMaxCmd->SetParameterName("p", false);
+    fGunPMaxCmd->SetRange("p>0");
+    fGunPMaxCmd->SetDefaultUnit("GeV");
+    fGunPMaxCmd->SetToBeBroadcasted(false);
+    fGunPMaxCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+    fGunThetaMaxCmd = new G4UIcmdWithADoubleAndUnit("/eic/gen/gun/thetaMax", this);
+    fGunThetaMaxCmd->SetGuidance("Largest polar angle to +z (flat in solid angle).");
+    fGunThetaMaxCmd->SetParameterName("theta", false);
+    fGunThetaMaxCmd->SetRange("theta>0");
+    fGunThetaMaxCmd->SetDefaultUnit("rad");
+    fGunThetaMaxCmd->SetToBeBroadcasted(false);
+    fGunThetaMaxCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+}
+
+GeneratorMessenger::~GeneratorMessenger()
+{
+    delete fBeamEnergyCmd;
+    delete fProcessCmd;
+    delete fReadStringCmd;
+    delete fClearStringsCmd;
+    delete fPregenThreadsCmd;
+    delete fPregenCapacityCmd;
+    delete fPregenSeedCmd;
+    delete fCacheCmd;
+    delete fFilterEnableCmd;
+    delete fFilterMinMuonsCmd;
+    delete fFilterPMinCmd;
+    delete fFilterRMinCmd;
+    delete fFilterRMaxCmd;
+    delete fFilterMaxTrialsCmd;
+    delete fFilterDirectory;
+    delete fWeightSigmaCmd;
+    delete fWeightTargetCmd;
+    delete fBiasEnableCmd;
+    delete fBiasMassRefCmd;
+    delete fBiasMassPowerCmd;
+    delete fBiasXFPowerCmd;
+    delete fWeightDirectory;
+    delete fGunPMinCmd;
+    delete fGunPMaxCmd;
+    delete fGunThetaMaxCmd;
+    delete fGunDirectory;
+    delete fDirectory;
+}
+
+void GeneratorMessenger::SetNewValue(G4UIcommand* command, G4String newValue)
+{
+    auto& pool = GeneratorPool::GetSettings();
+    auto& filter = AcceptanceFilter::GetSettings();
+
+    auto& config = GeneratorConfig::Instance();
+
+    if (command == fBeamEnergyCmd) {
+        config.SetBeamEnergy(fBeamEnergyCmd->GetNewDoubleValue(newValue) / GeV);
+        G4cout << "[GEN] beam energy " << config.GetBeamEnergy() << " GeV" << G4endl;
+    } else if (command == fProcessCmd) {
+        config.SetProcess(newValue == "opencharm"  ? GeneratorConfig::Process::OpenCharm
+                        : newValue == "singlemuon" ? GeneratorConfig::Process::SingleMuon
+                                                   : GeneratorConfig::Process::Charmonium);
+        G4cout << "[GEN] process " << GeneratorConfig::ProcessName(config.GetProcess()) << G4endl;
+    } else if (command == fReadStringCmd) {
+        config.AddString(newValue);
+    } else if (command == fClearStringsCmd) {
+        config.ClearStrings();
+    } else if (command == fPregenThreadsCmd) {
+        pool.threads = fPregenThreadsCmd->GetNewIntValue(newValue);
+    } else if (command == fPregenCapacityCmd) {
+        pool.capacity = fPregenCapacityCmd->GetNewIntValue(newValue);
+    } else if (command == fPregenSeedCmd) {
+        pool.seed = fPregenSeedCmd->GetNewIntValue(newValue);
+    } else if (command == fCacheCmd) {
+        std::istringstream is(newValue);
+        G4String mode, file;
+        is >> mode >> file;
+        auto& cache = PrimaryCache::GetSettings();
+        cache.mode = mode == "record" ? PrimaryCache::Mode::Record
+                   : mode == "replay" ? PrimaryCache::Mode::Replay
+                                      : PrimaryCache::Mode::Off;
+        if (!file.empty()) cache.fileName = file;
+        G4cout << "[GEN] primary cache " << mode << " " << cache.fileName << G4endl;
+    } else if (command == fFilterEnableCmd) {
+        filter.enabled = fFilterEnableCmd->GetNewBoolValue(newValue);
+    } else if (command == fFilterMinMuonsCmd) {
+        filter.minMuons = fFilterMinMuonsCmd->GetNewIntValue(newValue);
+    } else if (command == fFilterPMinCmd) {
+        filter.pMin = fFilterPMinCmd->GetNewDoubleValue(newValue);
+    } else if (command == fFilterRMinCmd) {
+        filter.rMin = fFilterRMinCmd->GetNewDoubleValue(newValue);
+    } else if (command == fFilterRMaxCmd) {
+        filter.rMax = fFilterRMaxCmd->GetNewDoubleValue(newValue);
+    } else if (command == fFilterMaxTrialsCmd) {
+        filter.maxTrials = fFilterMaxTrialsCmd->GetNewIntValue(newValue);
+    } else if (command == fWeightSigmaCmd) {
+        Luminosity::GetSettings().sigma_mb = fWeightSigmaCmd->GetNewDoubleValue(newValue);
+    } else if (command == fWeightTargetCmd) {
+        Luminosity::GetSettings().target = newValue;
+    } else if (command == fGunPMinCmd || command == fGunPMaxCmd || command == fGunThetaMaxCmd) {
+        auto gun = config.GetGun();
+        if (command == fGunPMinCmd) {
+            gun.pMin = fGunPMinCmd->GetNewDoubleValue(newValue) / GeV;
+        } else if (command == fGunPMaxCmd) {
+            gun.pMax = fGunPMaxCmd->GetNewDoubleValue(newValue) / GeV;
+        } else {
+            gun.thetaMax = fGunThetaMaxCmd->GetNewDoubleValue(newValue);
+        }
+        config.SetGun(gun);
+    } else {
+        // Bias settings change the Pythia setup: through GeneratorConfig
+        auto bias = config.GetBias();
+        if (command == fBiasEnableCmd) {
+            bias.enabled = fBiasEnableCmd->GetNewBoolValue(newValue);
+        } else if (command == fBiasMassRefCmd) {
+            bias.massRef = fBiasMassRefCmd->GetNewDoubleValue(newValue) / GeV;
+        } else if (command == fBiasMassPowerCmd) {
+            bias.massPower = fBiasMassPowerCmd->GetNewDoubleValue(newValue);
+        } else if (command == fBiasXFPowerCmd) {
+            bias.xFPower = fBiasXFPowerCmd->GetNewDoubleValue(newValue);
+        }
+        config.SetBias(bias);
+    }
+}
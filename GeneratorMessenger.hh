@@ -0,0 +1,56 @@
+#ifndef GENERATORMESSENGER_HH
+#define GENERATORMESSENGER_HH
+
+#include "G4UImessenger.hh"
+
+class G4UIdirectory;
+class G4UIcommand;
+class G4UIcmdWithAnInteger;
+class G4UIcmdWithABool;
+class G4UIcmdWithADouble;
+class G4UIcmdWithADoubleAndUnit;
+class G4UIcmdWithAString;
+class G4UIcmdWithoutParameter;
+
+// /eic/gen/ commands, applied on the master to the generator settings
+class GeneratorMessenger : public G4UImessenger {
+public:
+    GeneratorMessenger();
+    virtual ~GeneratorMessenger();
+
+    virtual void SetNewValue(G4UIcommand* command, G4String newValue) override;
+
+private:
+    G4UIdirectory*        fDirectory;
+    G4UIcmdWithADoubleAndUnit* fBeamEnergyCmd;
+    G4UIcmdWithAString*   fProcessCmd;
+    G4UIcmdWithAString*   fReadStringCmd;
+    G4UIcmdWithoutParameter* fClearStringsCmd;
+    G4UIcmdWithAnInteger* fPregenThreadsCmd;
+    G4UIcmdWithAnInteger* fPregenCapacityCmd;
+    G4UIcmdWithAnInteger* fPregenSeedCmd;
+    G4UIcommand*          fCacheCmd;
+
+    G4UIdirectory*             fFilterDirectory;
+    G4UIcmdWithABool*          fFilterEnableCmd;
+    G4UIcmdWithAnInteger*      fFilterMinMuonsCmd;
+    G4UIcmdWithADoubleAndUnit* fFilterPMinCmd;
+    G4UIcmdWithADoubleAndUnit* fFilterRMinCmd;
+    G4UIcmdWithADoubleAndUnit* fFilterRMaxCmd;
+    G4UIcmdWithAnInteger*      fFilterMaxTrialsCmd;
+
+    G4UIdirectory*             fWeightDirectory;
+    G4UIcmdWithADouble*        fWeightSigmaCmd;
+    G4UIcmdWithAString*        fWeightTargetCmd;
+    G4UIcmdWithABool*          fBiasEnableCmd;
+    G4UIcmdWithADoubleAndUnit* fBiasMassRefCmd;
+    G4UIcmdWithADouble*        fBiasMassPowerCmd;
+    G4UIcmdWithADouble*        fBiasXFPowerCmd;
+
+    G4UIdirectory*             fGunDirectory;
+    G4UIcmdWithADoubleAndUnit* fGunPMinCmd;
+    G4UIcmdWithADoubleAndUnit* fGunPMaxCmd;
+    G4UIcmdWithADoubleAndUnit* fGunThetaMaxCmd;
+};
+
+#endif
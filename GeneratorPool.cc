@@ -0,0 +1,158 @@
+#include "GeneratorPool.hh"
+#include "GeneratorConfig.hh"
+#include "PrimaryGeneratorAction.hh"
+#include "Production.hh"
+#include "Log.hh"
+
+#include "G4ios.hh"
+
+#include "Pythia8/Pythia.h"
+
+#include <algorithm>
+#include <chrono>
+
+GeneratorPool::Settings GeneratorPool::fgSettings;
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    std::uint64_t NanosecondsSince(Clock::time_point start) {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+    }
+
+    // Short spin, then back off so that a waiting thread does not hold a core
+    void Backoff(G4int& idle) {
+        if (++idle < 64) std::this_thread::yield();
+        else std::this_thread::sleep_for(std::chrono::microseconds(50));
+    }
+}
+
+GeneratorPool& GeneratorPool::Instance() {
+    static GeneratorPool pool;
+    return pool;
+}
+
+GeneratorPool::~GeneratorPool() = default;
+
+void GeneratorPool::Start(const Settings& settings) {
+    if (IsRunning()) Stop();
+
+    const std::size_t capacity = std::max(2, settings.capacity);
+    fSlots.assign(capacity, GeneratedEvent());
+    fFree  = std::make_unique<BoundedQueue<GeneratedEvent*>>(capacity);
+    fReady = std::make_unique<BoundedQueue<GeneratedEvent*>>(capacity);
+    for (auto& slot : fSlots) fFree->TryPush(&slot);
+
+    fStopRequested.store(false);
+    fGenerated.store(0);
+    fGenerateNs.store(0);
+    fProducerWaitNs.store(0);
+    fConsumerWaitNs.store(0);
+
+    // Pythia instances of the previous runs, unless the settings changed;
+    // each thread builds the missing one
+    const G4int nThreads = std::max(1, settings.threads);
+    const G4int version = GeneratorConfig::Instance().GetVersion();
+    if (version != fPythiaVersion) {
+        fPythia.clear();
+        fPythiaVersion = version;
+    }
+    fPythia.resize(nThreads);
+
+    // Thread streams: key (run, thread) under a base of this job and shard,
+    // never the workers' own (which use streamSeed itself)
+    const auto& production = Production::GetSettings();
+    const uint64_t base = (settings.seed > 0 ? uint64_t(settings.seed) : production.streamSeed)
+                        + (uint64_t(std::max(0, production.shard) + 1) << 32);
+    const G4int run = fRuns++;
+
+    fActive.store(nThreads);
+    fRunning.store(true, std::memory_order_release);
+    for (G4int i = 0; i < nThreads; ++i) {
+        const G4int seed = Production::SeedsFor(base, (run << 10) + i).pythia;
+        fThreads.emplace_back(&GeneratorPool::Run, this, i, seed);
+    }
+}
+
+GeneratorPool::Stats GeneratorPool::Stop() {
+    Stats stats;
+    if (!IsRunning()) return stats;
+
+    fStopRequested.store(true, std::memory_order_release);
+    for (auto& t : fThreads) t.join();
+    stats.threads = static_cast<G4int>(fThreads.size());
+    fThreads.clear();
+    fRunning.store(false, std::memory_order_release);
+
+    stats.generated    = static_cast<G4long>(fGenerated.load());
+    stats.discarded    = static_cast<G4long>(fReady->SizeApprox());
+    stats.generateTime = fGenerateNs.load() * 1e-9;
+    stats.producerWait = fProducerWaitNs.load() * 1e-9;
+    stats.consumerWait = fConsumerWaitNs.load() * 1e-9;
+    return stats;
+}
+
+GeneratedEvent* GeneratorPool::Acquire() {
+    GeneratedEvent* event = nullptr;
+    if (fReady->TryPop(event)) return event;
+
+    const auto start = Clock::now();
+    G4int idle = 0;
+    while (!fReady->TryPop(event)) {
+        if (fActive.load(std::memory_order_acquire) == 0 && !fReady->TryPop(event)) {
+            event = nullptr;
+            break;
+        }
+        Backoff(idle);
+    }
+    fConsumerWaitNs.fetch_add(NanosecondsSince(start), std::memory_order_relaxed);
+    return event;
+}
+
+void GeneratorPool::Release(GeneratedEvent* event) {
+    if (!event) return;
+    event->muons.clear();
+    // Cannot fail: there are as many free cells as slots
+    fFree->TryPush(event);
+}
+
+void GeneratorPool::Run(G4int index, G4int seed) {
+    auto& instance = fPythia[index];
+    if (!instance) {
+        instance = std::make_unique<Pythia8::Pythia>();
+        PrimaryGeneratorAction::ConfigurePythia(*instance);
+        if (!instance->init()) {
+            G4cerr << "Error: Pythia initialization failed in generator thread " << index << G4endl;
+            instance.reset();
+            Log::EndOfThread();
+            fActive.fetch_sub(1, std::memory_order_acq_rel);
+            return;
+        }
+    }
+    auto& pythia = *instance;
+    pythia.rndm.init(seed);
+
+    G4int idle = 0;
+    while (!fStopRequested.load(std::memory_order_acquire)) {
+        GeneratedEvent* event = nullptr;
+        if (!fFree->TryPop(event)) {
+            const auto start = Clock::now();
+            while (!fFree->TryPop(event) && !fStopRequested.load(std::memory_order_acquire)) {
+                Backoff(idle);
+            }
+            fProducerWaitNs.fetch_add(NanosecondsSince(start), std::memory_order_relaxed);
+            if (!event) break;
+        }
+        idle = 0;
+
+        const auto start = Clock::now();
+        PrimaryGeneratorAction::NextAccepted(pythia, *event);
+        event->seed = static_cast<uint64_t>(seed);
+        fGenerateNs.fetch_add(NanosecondsSince(start), std::memory_order_relaxed);
+        fGenerated.fetch_add(1, std::memory_order_relaxed);
+
+        fReady->TryPush(event);
+    }
+    Log::EndOfThread();
+    fActive.fetch_sub(1, std::memory_order_acq_rel);
+}
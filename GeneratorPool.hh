@@ -0,0 +1,98 @@
+#ifndef GENERATORPOOL_HH
+#define GENERATORPOOL_HH
+
+#include "globals.hh"
+#include "BoundedQueue.hh"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace Pythia8 { class Pythia; }
+
+// Final-state muon of a generated event, GeV.
+// Also the on-disk record of PrimaryCache: no implicit padding.
+struct PrimaryMuon {
+    int32_t pdg;
+    int32_t status;           // Pythia status code
+    double  px, py, pz, e;
+};
+
+// One Pythia event reduced to what GeneratePrimaries needs.
+// Events without muons are kept (empty) so that the event count matches
+// the number of Pythia events, as in the synchronous mode.
+struct GeneratedEvent {
+    std::vector<PrimaryMuon> muons;
+    double   weight = 1.;     // Pythia event weight
+    G4int    trials = 1;      // Pythia events generated for this one (acceptance filter)
+    G4bool   accepted = true; // false: none passed within maxTrials (empty, weight 0)
+    uint64_t seed   = 0;      // seed of the Pythia instance (0 = Pythia default)
+};
+
+// Event pre-generation: dedicated threads, each with its own Pythia and
+// seed, fill a ring of GeneratedEvent slots ahead of the Geant4 workers.
+// Slots cycle between two bounded queues (free -> ready -> free), so the
+// steady state does not allocate.
+// The Pythia instances outlive the run and are rebuilt only when the
+// generator settings changed (GeneratorConfig version), as on the workers.
+// Each run reseeds them: one stream per thread, run and shard, from
+// Production::SeedsFor.
+class GeneratorPool {
+public:
+    // Process-wide settings, set on the master (GeneratorMessenger)
+    struct Settings {
+        G4int  threads  = 0;      // generator threads, 0 = Pythia on the workers
+        G4int  capacity = 256;    // pre-generated events
+        G4long seed     = 0;      // base of the thread streams, 0 = Production streamSeed
+    };
+    static Settings& GetSettings() { return fgSettings; }
+
+    struct Stats {
+        G4int    threads       = 0;
+        G4long   generated     = 0;
+        G4long   discarded     = 0;   // still in the ring at Stop()
+        G4double generateTime  = 0.;  // s in Pythia::next(), summed over threads
+        G4double producerWait  = 0.;  // s waiting for a free slot (ring full)
+        G4double consumerWait  = 0.;  // s waiting for an event (ring empty)
+    };
+
+    static GeneratorPool& Instance();
+
+    // Master side, once per run
+    void Start(const Settings& settings);
+    Stats Stop();
+    G4bool IsRunning() const { return fRunning.load(std::memory_order_acquire); }
+
+    // Worker side: next ready event (waits if needed), nullptr if every
+    // generator thread has failed. Every acquired event must be released.
+    GeneratedEvent* Acquire();
+    void Release(GeneratedEvent* event);
+
+private:
+    GeneratorPool() = default;
+    ~GeneratorPool();
+    void Run(G4int index, G4int seed);
+
+    static Settings fgSettings;
+
+    std::vector<GeneratedEvent> fSlots;
+    std::unique_ptr<BoundedQueue<GeneratedEvent*>> fFree;
+    std::unique_ptr<BoundedQueue<GeneratedEvent*>> fReady;
+    std::vector<std::thread> fThreads;
+    std::vector<std::unique_ptr<Pythia8::Pythia>> fPythia;   // by thread, kept between runs
+    G4int fPythiaVersion = -1;
+    G4int fRuns = 0;
+
+    std::atomic<bool> fRunning{false};
+    std::atomic<bool> fStopRequested{false};
+    std::atomic<G4int> fActive{0};
+
+    std::atomic<std::uint64_t> fGenerated{0};
+    std::atomic<std::uint64_t> fGenerateNs{0};
+    std::atomic<std::uint64_t> fProducerWaitNs{0};
+    std::atomic<std::uint64_t> fConsumerWaitNs{0};
+};
+
+#endif
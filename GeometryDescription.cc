@@ -0,0 +1,514 @@
+#include "GeometryDescription.hh"
+
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <set>
+#include <sstream>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+    const char     kMagic[8] = {'E', 'I', 'C', 'G', 'E', 'O', 'M', '\0'};
+    const uint32_t kVersion  = 3;
+    const int      kMaxIncludeDepth = 16;
+
+    struct CacheHeader {
+        char     magic[8];
+        uint32_t version;
+        uint32_t reserved;
+        uint64_t textHash;         // key: hash of the expanded text
+        uint64_t payloadSize;
+        uint64_t payloadHash;      // truncated or damaged files
+    };
+
+    uint64_t Fnv1a(const char* data, std::size_t size) {
+        uint64_t h = 14695981039346656037ull;
+        for (std::size_t i = 0; i < size; ++i) {
+            h ^= static_cast<unsigned char>(data[i]);
+            h *= 1099511628211ull;
+        }
+        return h;
+    }
+
+    std::vector<std::string> Tokens(const std::string& line) {
+        std::vector<std::string> tokens;
+        std::size_t i = 0;
+        while (i < line.size()) {
+            while (i < line.size() && std::isspace(static_cast<unsigned char>(line[i]))) ++i;
+            const std::size_t begin = i;
+            while (i < line.size() && !std::isspace(static_cast<unsigned char>(line[i]))) ++i;
+            if (i > begin) tokens.emplace_back(line, begin, i - begin);
+        }
+        return tokens;
+    }
+
+    bool ToNumber(const std::string& s, double& v) {
+        char* end = nullptr;
+        v = std::strtod(s.c_str(), &end);
+        return !s.empty() && end == s.c_str() + s.size() && std::isfinite(v);
+    }
+
+    bool IsNistName(const std::string& name) { return name.compare(0, 3, "G4_") == 0; }
+
+    // "a,b"
+    bool ToPair(const std::string& s, double v[2]) {
+        const auto comma = s.find(',');
+        return comma != std::string::npos && ToNumber(s.substr(0, comma), v[0])
+            && ToNumber(s.substr(comma + 1), v[1]);
+    }
+
+    // ------------------------------------------------------------ binary
+
+    class Out {
+    public:
+        void Bytes(const void* p, std::size_t n) { fData.append(static_cast<const char*>(p), n); }
+        template <typename T> void Put(T v) { Bytes(&v, sizeof(v)); }
+        void Put(const std::string& s) {
+            Put(static_cast<uint32_t>(s.size()));
+            Bytes(s.data(), s.size());
+        }
+        const std::string& Data() const { return fData; }
+    private:
+        std::string fData;
+    };
+
+    class In {
+    public:
+        In(const char* data, std::size_t size) : fData(data), fEnd(data + size) {}
+        bool Bytes(void* p, std::size_t n) {
+            if (static_cast<std::size_t>(fEnd - fData) < n) return fOk = false;
+            std::memcpy(p, fData, n);
+            fData += n;
+            return true;
+        }
+        template <typename T> T Get() {
+            T v{};
+            Bytes(&v, sizeof(v));
+            return v;
+        }
+        std::string GetString() {
+            const auto n = Get<uint32_t>();
+            if (!fOk || static_cast<std::size_t>(fEnd - fData) < n) {
+                fOk = false;
+                return std::string();
+            }
+            std::string s(fData, n);
+            fData += n;
+            return s;
+        }
+        void Fail() { fOk = false; }
+        bool Ok() const { return fOk; }
+        bool AtEnd() const { return fData == fEnd; }
+    private:
+        const char* fData;
+        const char* fEnd;
+        bool fOk = true;
+    };
+
+    bool ExpandFile(const std::string& fileName, int depth, std::string& text, std::string& error) {
+        if (depth > kMaxIncludeDepth) {
+            error = fileName + ": includes nested too deep";
+            return false;
+        }
+        std::ifstream in(fileName, std::ios::binary);
+        if (!in) {
+            error = "cannot open " + fileName;
+            return false;
+        }
+        const std::string content((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        const auto slash = fileName.rfind('/');
+        const std::string dir = slash == std::string::npos ? std::string() : fileName.substr(0, slash + 1);
+
+        // Lines copied as they are (the hash is taken on this text), only
+        // include lines are looked at
+        std::size_t pos = 0;
+        while (pos < content.size()) {
+            std::size_t end = content.find('\n', pos);
+            if (end == std::string::npos) end = content.size();
+            std::size_t first = pos;
+            while (first < end && (content[first] == ' ' || content[first] == '\t')) ++first;
+            if (content.compare(first, 7, "include") == 0) {
+                std::string line = content.substr(first, end - first);
+                const auto hash = line.find('#');
+                if (hash != std::string::npos) line.erase(hash);
+                const auto tokens = Tokens(line);
+                if (tokens[0] == "include") {
+                    if (tokens.size() != 2) {
+                        error = fileName + ": include takes one file name";
+                        return false;
+                    }
+                    const std::string& target = tokens[1];
+                    if (!ExpandFile(target[0] == '/' ? target : dir + target, depth + 1, text, error)) return false;
+                    pos = end + 1;
+                    continue;
+                }
+            }
+            text.append(content, pos, end - pos);
+            text += '\n';
+            pos = end + 1;
+        }
+        return true;
+    }
+}
+
+bool GeometryDescription::Expand(const std::string& fileName, std::string& text, std::string& error) {
+    text.clear();
+    return ExpandFile(fileName, 0, text, error);
+}
+
+uint64_t GeometryDescription::Hash(const std::string& text) {
+    return Fnv1a(text.data(), text.size()) ^ kVersion;
+}
+
+const GeometryDescription::Volume* GeometryDescription::Find(const std::string& name) const {
+    const auto it = fIndex.find(name);
+    return it != fIndex.end() ? &volumes[it->second] : nullptr;
+}
+
+void GeometryDescription::WorldPosition(const Volume& volume, double position[3]) const {
+    position[0] = position[1] = position[2] = 0.;
+    for (const auto* v = &volume; v; v = Find(v->mother)) {
+        for (int i = 0; i < 3; ++i) position[i] += v->position[i];
+    }
+}
+
+void GeometryDescription::BuildIndex() {
+    fIndex.clear();
+    fIndex.reserve(volumes.size());
+    for (std::size_t i = 0; i < volumes.size(); ++i) fIndex.emplace(volumes[i].name, i);
+}
+
+bool GeometryDescription::Parse(const std::string& text, std::string& error) {
+    materials.clear();
+    volumes.clear();
+
+    std::istringstream lines(text);
+    std::string line;
+    while (std::getline(lines, line)) {
+        const auto hash = line.find('#');
+        if (hash != std::string::npos) line.erase(hash);
+        const auto tokens = Tokens(line);
+        if (tokens.empty()) continue;
+        const std::string& keyword = tokens[0];
+        auto fail = [&](const std::string& what) {
+            error = "'" + line + "': " + what;
+            return false;
+        };
+
+        if (keyword == "material") {
+            if (tokens.size() < 5) return fail("expected name, density and components");
+            Material m;
+            m.name = tokens[1];
+            if (!ToNumber(tokens[2], m.density)) return fail("bad density");
+            std::size_t i = 3;
+            for (; i + 1 < tokens.size(); i += 2) {
+                double fraction;
+                if (!ToNumber(tokens[i + 1], fraction)) return fail("bad fraction of " + tokens[i]);
+                m.components.emplace_back(tokens[i], fraction);
+            }
+            if (i < tokens.size()) {
+                if (tokens[i] != "gas") return fail("unexpected '" + tokens[i] + "'");
+                m.gas = true;
+            }
+            materials.push_back(std::move(m));
+            continue;
+        }
+
+        Volume v;
+        if (keyword == "box")           v.shape = Shape::Box;
+        else if (keyword == "tube")     v.shape = Shape::Tube;
+        else if (keyword == "polycone") v.shape = Shape::Polycone;
+        else return fail("unknown statement");
+        if (tokens.size() < 4) return fail("expected name, mother and material");
+        v.name = tokens[1];
+        v.mother = tokens[2];
+        v.material = tokens[3];
+
+        for (std::size_t i = 4; i < tokens.size(); ++i) {
+            const std::string& t = tokens[i];
+            double number;
+            const auto eq = t.find('=');
+            if (eq == std::string::npos) {
+                if (ToNumber(t, number))  v.dims.push_back(number);
+                else if (t == "sd")       v.sensitive = true;
+                else if (t == "envelope") v.envelope = true;
+                else if (t == "solid")    v.solid = true;
+                else if (t == "invisible") v.invisible = true;
+                else return fail("unknown flag '" + t + "'");
+                continue;
+            }
+            const std::string key = t.substr(0, eq), value = t.substr(eq + 1);
+            if (key == "region") {
+                v.region = value;
+            } else if (key == "subsystem") {
+                v.subsystem = value;
+            } else if (key == "colour") {
+                std::istringstream cs(value);
+                std::string c;
+                int n = 0;
+                while (n < 4 && std::getline(cs, c, ',')) {
+                    if (!ToNumber(c, number)) return fail("bad colour");
+                    v.colour[n++] = static_cast<float>(number);
+                }
+                if (n < 3) return fail("colour needs r,g,b[,a]");
+                v.hasColour = true;
+            } else if (key == "readout") {
+                if (value == "disk")        v.readout = Readout::Disk;
+                else if (value == "barrel") v.readout = Readout::Barrel;
+                else return fail("readout is disk or barrel");
+            } else if (key == "pitch") {
+                if (!ToPair(value, v.pitch)) return fail("pitch needs a,b");
+            } else if (key == "adc") {
+                if (!ToPair(value, v.adc)) return fail("adc needs lsb,threshold");
+            } else if (!ToNumber(value, number)) {
+                return fail("bad value of " + key);
+            } else if (key == "x" || key == "y" || key == "z") {
+                v.position[key[0] - 'x'] = number;
+            } else if (key == "copy") {
+                v.copy = static_cast<int>(number);
+            } else if (key == "smartless") {
+                v.smartless = number;
+            } else {
+                return fail("unknown option '" + key + "'");
+            }
+        }
+
+        const auto& d = v.dims;
+        switch (v.shape) {
+            case Shape::Box:
+                if (d.size() != 3 || !(d[0] > 0. && d[1] > 0. && d[2] > 0.)) return fail("box needs halfX halfY halfZ > 0");
+                break;
+            case Shape::Tube:
+                if (d.size() != 3 || !(d[0] >= 0. && d[1] > d[0] && d[2] > 0.)) return fail("tube needs 0 <= rMin < rMax, halfZ > 0");
+                break;
+            case Shape::Polycone:
+                if (d.size() < 6 || d.size() % 3 != 0) return fail("polycone needs two or more (z rIn rOut) planes");
+                for (std::size_t p = 0; p < d.size(); p += 3) {
+                    if (!(d[p + 1] >= 0. && d[p + 2] >= d[p + 1])) return fail("polycone needs 0 <= rIn <= rOut");
+                    if (p > 0 && d[p] < d[p - 3]) return fail("polycone planes must have increasing z");
+                }
+                break;
+        }
+        volumes.push_back(std::move(v));
+    }
+    BuildIndex();
+    return Validate(error);
+}
+
+bool GeometryDescription::Validate(std::string& error) const {
+    std::set<std::string> materialNames;
+    for (const auto& m : materials) {
+        if (!(m.density > 0.)) {
+            error = "material " + m.name + ": density must be positive";
+            return false;
+        }
+        double sum = 0.;
+        for (const auto& c : m.components) {
+            if (!IsNistName(c.first) && !materialNames.count(c.first)) {
+                error = "material " + m.name + ": unknown component " + c.first;
+                return false;
+            }
+            sum += c.second;
+        }
+        if (std::abs(sum - 1.) > 1e-6) {
+            error = "material " + m.name + ": fractions add up to " + std::to_string(sum);
+            return false;
+        }
+        if (IsNistName(m.name) || !materialNames.insert(m.name).second) {
+            error = "material " + m.name + " defined twice or shadows a NIST material";
+            return false;
+        }
+    }
+
+    if (volumes.empty() || volumes[0].mother != "-") {
+        error = "the first volume must be the world (mother '-')";
+        return false;
+    }
+    std::set<std::string> volumeNames;
+    for (std::size_t i = 0; i < volumes.size(); ++i) {
+        const auto& v = volumes[i];
+        if (i > 0 && !volumeNames.count(v.mother)) {
+            error = "volume " + v.name + ": mother " + v.mother + " not declared before";
+            return false;
+        }
+        if (!volumeNames.insert(v.name).second) {
+            error = "volume " + v.name + " declared twice";
+            return false;
+        }
+        if (!IsNistName(v.material) && !materialNames.count(v.material)) {
+            error = "volume " + v.name + ": unknown material " + v.material;
+            return false;
+        }
+        if (i == 0 && v.envelope) {
+            error = "the world cannot be an envelope";
+            return false;
+        }
+        if (v.readout != Readout::None
+            && (v.shape != Shape::Tube || !v.sensitive || !(v.pitch[0] > 0. && v.pitch[1] > 0.)
+                || !(v.adc[0] > 0. && v.adc[1] >= 0.))) {
+            error = "volume " + v.name + ": a readout needs a sensitive tube, pitch > 0 and adc lsb > 0";
+            return false;
+        }
+        if (!v.subsystem.empty() && !v.sensitive) {
+            error = "volume " + v.name + ": a subsystem needs a sensitive volume";
+            return false;
+        }
+    }
+    return true;
+}
+
+bool GeometryDescription::Load(const std::string& fileName, const std::string& cacheDir,
+                               std::string& error, bool& fromCache) {
+    fromCache = false;
+    std::string text;
+    if (!Expand(fileName, text, error)) return false;
+    const uint64_t hash = Hash(text);
+
+    std::string cacheFile;
+    if (!cacheDir.empty()) {
+        char key[17];
+        std::snprintf(key, sizeof(key), "%016llx", static_cast<unsigned long long>(hash));
+        cacheFile = cacheDir + "/" + key + ".bin";
+        if (ReadCache(cacheFile, hash)) {
+            fromCache = true;
+            return true;
+        }
+    }
+
+    if (!Parse(text, error)) {
+        error = fileName + ": " + error;
+        return false;
+    }
+    if (!cacheFile.empty()) {
+        ::mkdir(cacheDir.c_str(), 0755);
+        WriteCache(cacheFile, hash);   // a run without cache is still a run
+    }
+    return true;
+}
+
+bool GeometryDescription::WriteCache(const std::string& fileName, uint64_t hash) const {
+    Out out;
+    out.Put(static_cast<uint32_t>(materials.size()));
+    for (const auto& m : materials) {
+        out.Put(m.name);
+        out.Put(m.density);
+        out.Put(static_cast<uint8_t>(m.gas));
+        out.Put(static_cast<uint32_t>(m.components.size()));
+        for (const auto& c : m.components) {
+            out.Put(c.first);
+            out.Put(c.second);
+        }
+    }
+    out.Put(static_cast<uint32_t>(volumes.size()));
+    for (const auto& v : volumes) {
+        out.Put(v.name);
+        out.Put(v.mother);
+        out.Put(v.material);
+        out.Put(v.region);
+        out.Put(v.subsystem);
+        out.Put(static_cast<uint8_t>(v.shape));
+        out.Put(static_cast<uint32_t>(v.dims.size()));
+        out.Bytes(v.dims.data(), v.dims.size() * sizeof(double));
+        out.Bytes(v.position, sizeof(v.position));
+        out.Put(static_cast<int32_t>(v.copy));
+        out.Put(v.smartless);
+        out.Bytes(v.colour, sizeof(v.colour));
+        out.Put(static_cast<uint8_t>(v.hasColour | v.sensitive << 1 | v.envelope << 2
+                                     | v.solid << 3 | v.invisible << 4));
+        out.Put(static_cast<uint8_t>(v.readout));
+        out.Bytes(v.pitch, sizeof(v.pitch));
+        out.Bytes(v.adc, sizeof(v.adc));
+    }
+
+    CacheHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.textHash = hash;
+    header.payloadSize = out.Data().size();
+    header.payloadHash = Fnv1a(out.Data().data(), out.Data().size());
+
+    // Jobs started together share the cache: write aside, then rename
+    const std::string tmp = fileName + ".tmp" + std::to_string(::getpid());
+    std::FILE* f = std::fopen(tmp.c_str(), "wb");
+    if (!f) return false;
+    const bool ok = std::fwrite(&header, sizeof(header), 1, f) == 1
+        && std::fwrite(out.Data().data(), 1, out.Data().size(), f) == out.Data().size();
+    if (std::fclose(f) != 0 || !ok || std::rename(tmp.c_str(), fileName.c_str()) != 0) {
+        std::remove(tmp.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool GeometryDescription::ReadCache(const std::string& fileName, uint64_t hash) {
+    std::ifstream in(fileName, std::ios::binary);
+    if (!in) return false;
+    CacheHeader header;
+    if (!in.read(reinterpret_cast<char*>(&header), sizeof(header))) return false;
+    if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 || header.version != kVersion
+        || header.textHash != hash || header.payloadSize > (1ull << 32)) {
+        return false;
+    }
+    std::string payload(header.payloadSize, '\0');
+    if (!in.read(&payload[0], payload.size())) return false;
+    if (Fnv1a(payload.data(), payload.size()) != header.payloadHash) return false;
+
+    In is(payload.data(), payload.size());
+    // Counts bounded by the payload before anything is allocated
+    auto count = [&]() {
+        const auto n = is.Get<uint32_t>();
+        if (n <= payload.size()) return n;
+        is.Fail();
+        return 0u;
+    };
+    std::vector<Material> m(count());
+    for (auto& material : m) {
+        if (!is.Ok()) return false;
+        material.name = is.GetString();
+        material.density = is.Get<double>();
+        material.gas = is.Get<uint8_t>() != 0;
+        material.components.resize(count());
+        for (auto& c : material.components) {
+            c.first = is.GetString();
+            c.second = is.Get<double>();
+        }
+    }
+    std::vector<Volume> v(count());
+    for (auto& volume : v) {
+        if (!is.Ok()) return false;
+        volume.name = is.GetString();
+        volume.mother = is.GetString();
+        volume.material = is.GetString();
+        volume.region = is.GetString();
+        volume.subsystem = is.GetString();
+        volume.shape = static_cast<Shape>(is.Get<uint8_t>());
+        volume.dims.resize(count());
+        is.Bytes(volume.dims.data(), volume.dims.size() * sizeof(double));
+        is.Bytes(volume.position, sizeof(volume.position));
+        volume.copy = is.Get<int32_t>();
+        volume.smartless = is.Get<double>();
+        is.Bytes(volume.colour, sizeof(volume.colour));
+        const auto flags = is.Get<uint8_t>();
+        volume.hasColour = flags & 1;
+        volume.sensitive = flags & 2;
+        volume.envelope  = flags & 4;
+        volume.solid     = flags & 8;
+        volume.invisible = flags & 16;
+        volume.readout = static_cast<Readout>(is.Get<uint8_t>());
+        is.Bytes(volume.pitch, sizeof(volume.pitch));
+        is.Bytes(volume.adc, sizeof(volume.adc));
+    }
+    if (!is.Ok() || !is.AtEnd()) return false;
+
+    materials = std::move(m);
+    volumes = std::move(v);
+    BuildIndex();
+    return true;
+}
@@ -0,0 +1,91 @@
+#ifndef GEOMETRYDESCRIPTION_HH
+#define GEOMETRYDESCRIPTION_HH
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Declarative description of the detector, read by EICDetectorConstruction.
+// No Geant4 dependency: lengths in cm, densities in g/cm3.
+//
+// Text format, one statement per line, '#' starts a comment:
+//   include  <file>                                  relative to this file
+//   material <name> <density> <component> <fraction> [...] [gas]
+//   box      <name> <mother> <material> halfX halfY halfZ        [options]
+//   tube     <name> <mother> <material> rMin rMax halfZ          [options]
+//   polycone <name> <mother> <material> z rIn rOut  z rIn rOut ... [options]
+// Options: x= y= z= (position in the mother), copy=, region=<DetectorRegions
+// name>, smartless=, colour=r,g,b,a, and the flags sd (sensitive), envelope
+// (dissolved by --flat-geometry), solid, invisible.
+// A sensitive volume names its hits collection with subsystem=<DetectorHit
+// name>; the layers of a subsystem are numbered in description order.
+// Readout of a sensitive tube (ReadoutMap): readout=disk|barrel,
+// pitch=a,b (disk: r and arc; barrel: arc and z; cm), adc=lsb,threshold (keV).
+// The world is the volume with mother '-', first. Materials are NIST names
+// (G4_...) or declared before use; mothers are declared before daughters.
+//
+// Load() keeps a binary copy of each validated description in a cache
+// directory, keyed by the hash of the text with its includes: a variant is
+// parsed once, later runs read the cache.
+class GeometryDescription {
+public:
+    enum class Shape : uint8_t { Box, Tube, Polycone };
+    enum class Readout : uint8_t { None, Disk, Barrel };
+
+    struct Material {
+        std::string name;
+        double density = 0.;
+        bool   gas = false;
+        std::vector<std::pair<std::string, double>> components;   // mass fractions
+    };
+
+    struct Volume {
+        std::string name, mother, material, region, subsystem;
+        Shape  shape = Shape::Box;
+        std::vector<double> dims;          // per shape, see above
+        double position[3] = {0., 0., 0.};
+        int    copy = 0;
+        double smartless = 0.;             // 0: kernel default
+        float  colour[4] = {1.f, 1.f, 1.f, 1.f};
+        bool   hasColour = false;
+        bool   sensitive = false;
+        bool   envelope = false;
+        bool   solid = false;
+        bool   invisible = false;
+        Readout readout = Readout::None;
+        double pitch[2] = {0., 0.};        // cm
+        double adc[2] = {0., 0.};          // keV: LSB, threshold
+    };
+
+    std::vector<Material> materials;
+    std::vector<Volume> volumes;           // world first, mothers before daughters
+
+    // Text with its includes expanded
+    static bool Expand(const std::string& fileName, std::string& text, std::string& error);
+    static uint64_t Hash(const std::string& text);
+
+    // Parses and validates expanded text
+    bool Parse(const std::string& text, std::string& error);
+
+    // Expand + cache lookup, Parse + cache write on a miss. Empty cacheDir:
+    // no cache. fromCache tells which path was taken.
+    bool Load(const std::string& fileName, const std::string& cacheDir,
+              std::string& error, bool& fromCache);
+
+    bool ReadCache(const std::string& fileName, uint64_t hash);
+    bool WriteCache(const std::string& fileName, uint64_t hash) const;
+
+    const Volume* Find(const std::string& name) const;
+    // Position in the world, cm (the description has no rotations)
+    void WorldPosition(const Volume& volume, double position[3]) const;
+
+private:
+    bool Validate(std::string& error) const;
+    void BuildIndex();
+
+    std::unordered_map<std::string, std::size_t> fIndex;   // volume by name
+};
+
+#endif
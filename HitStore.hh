@@ -0,0 +1,63 @@
+#ifndef HITSTORE_HH
+#define HITSTORE_HH
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Flat per-event accumulation of sensitive-detector hits, one slot per track.
+// Geant4 track IDs are dense (1..N) inside an event, so the trackID -> slot
+// lookup is a plain vector. Storage is kept between events: once warmed up,
+// Clear() + Add() do not touch the heap.
+struct TrackHit {
+    int32_t trackID;
+    int32_t pdg;
+    double  x, y, z;          // position of the first hit
+    double  energyDep;        // summed over all hits of the track
+    double  kineticEnergy;
+    double  px, py, pz, e;    // momentum at the first hit
+};
+
+class HitStore {
+public:
+    explicit HitStore(std::size_t reserveTracks = 1024) {
+        fHits.reserve(reserveTracks);
+        fIndex.assign(reserveTracks, -1);
+    }
+
+    // Slot of `trackID`, or nullptr if the track has no hit yet
+    TrackHit* Find(int32_t trackID) {
+        if (trackID < 0 || static_cast<std::size_t>(trackID) >= fIndex.size()) return nullptr;
+        const int32_t slot = fIndex[trackID];
+        return slot < 0 ? nullptr : &fHits[slot];
+    }
+
+    // New slot for `trackID` (must not exist yet)
+    TrackHit& Insert(int32_t trackID) {
+        if (static_cast<std::size_t>(trackID) >= fIndex.size()) {
+            std::size_t n = fIndex.size() ? fIndex.size() : 1024;
+            while (n <= static_cast<std::size_t>(trackID)) n *= 2;
+            fIndex.resize(n, -1);
+        }
+        fIndex[trackID] = static_cast<int32_t>(fHits.size());
+        fHits.emplace_back();
+        TrackHit& hit = fHits.back();
+        hit.trackID = trackID;
+        return hit;
+    }
+
+    // Resets only the index entries used by this event
+    void Clear() {
+        for (const auto& hit : fHits) fIndex[hit.trackID] = -1;
+        fHits.clear();
+    }
+
+    std::size_t Size() const { return fHits.size(); }
+    const std::vector<TrackHit>& Hits() const { return fHits; }
+
+private:
+    std::vector<TrackHit> fHits;
+    std::vector<int32_t>  fIndex;
+};
+
+#endif
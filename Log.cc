@@ -0,0 +1,136 @@
+#include "Log.hh"
+
+#include "G4ios.hh"
+
+#include <algorithm>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+
+namespace Log {
+
+Settings& GetSettings() {
+    static Settings settings;
+    return settings;
+}
+
+namespace {
+    // Flushed before the end of the event beyond this size
+    constexpr std::size_t kMaxBuffer = 64 * 1024;
+
+    struct Count {
+        G4long total = 0;
+        G4long printed = 0;
+    };
+
+    struct ThreadState {
+        std::ostringstream out, err;    // Debug/Info, Warning/Error
+        std::ostringstream* current = nullptr;
+        std::unordered_map<const char*, Count> counts;
+    };
+
+    G4ThreadLocal ThreadState* state = nullptr;
+
+    ThreadState& State() {
+        if (!state) state = new ThreadState();
+        return *state;
+    }
+
+    std::mutex totalsMutex;
+    std::map<std::string, Count> totals;
+
+    const char* Prefix(Level level) {
+        switch (level) {
+            case Level::Debug:   return "Debug: ";
+            case Level::Warning: return "Warning: ";
+            case Level::Error:   return "Error: ";
+            default:             return "";
+        }
+    }
+
+    void FlushStream(std::ostringstream& buffer, std::ostream& to) {
+        std::string text = buffer.str();
+        if (text.empty()) return;
+        text.pop_back();   // G4endl ends the last line
+        to << text << G4endl;
+        buffer.str(std::string());
+    }
+}
+
+namespace detail {
+
+G4bool Admit(Level level, const char* key) {
+    auto& count = State().counts[key];
+    ++count.total;
+    const G4int limit = GetSettings().limit;
+    if (limit > 0 && count.printed > limit) return false;
+    ++count.printed;
+    if (limit > 0 && count.printed > limit) {
+        // Once per key, thread and run
+        Begin(level) << "further \"" << key << "\" messages suppressed until the end of the run";
+        End();
+        return false;
+    }
+    return true;
+}
+
+std::ostream& Begin(Level level) {
+    auto& state = State();
+    state.current = level >= Level::Warning ? &state.err : &state.out;
+    *state.current << Prefix(level);
+    return *state.current;
+}
+
+void End() {
+    auto& state = State();
+    *state.current << '\n';
+    if (state.current->tellp() > static_cast<std::streamoff>(kMaxBuffer)) Flush();
+}
+
+} // namespace detail
+
+void Flush() {
+    auto& state = State();
+    FlushStream(state.out, G4cout);
+    FlushStream(state.err, G4cerr);
+}
+
+void EndOfThreadRun() {
+    Flush();
+    auto& state = State();
+    if (state.counts.empty()) return;
+    // The limit is per thread: clamp here, not on the merged sum, and drop
+    // the "suppressed" notice, which is not a printed message
+    const G4int limit = GetSettings().limit;
+    {
+        std::lock_guard<std::mutex> lock(totalsMutex);
+        for (const auto& c : state.counts) {
+            auto& total = totals[c.first];
+            total.total += c.second.total;
+            total.printed += limit > 0 ? std::min<G4long>(c.second.printed, limit) : c.second.printed;
+        }
+    }
+    state.counts.clear();
+}
+
+void EndOfThread() {
+    EndOfThreadRun();
+    delete state;
+    state = nullptr;
+}
+
+void Summary() {
+    Flush();
+    std::lock_guard<std::mutex> lock(totalsMutex);
+    for (const auto& t : totals) {
+        if (t.second.total > t.second.printed) {
+            G4cout << "[LOG] \"" << t.first << "\": " << t.second.total << " messages, "
+                   << t.second.total - t.second.printed << " suppressed" << G4endl;
+        }
+    }
+    totals.clear();
+}
+
+} // namespace Log
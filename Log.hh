@@ -0,0 +1,67 @@
+#ifndef LOG_HH
+#define LOG_HH
+
+#include "globals.hh"
+
+#include <ostream>
+
+// Leveled logging for the per-event code paths (generation, stepping,
+// output), where one locked G4cout line per message costs wall time.
+//
+// Each message is identified by its key, a string literal (compared by
+// address). A thread prints the first `limit` occurrences of a key in a
+// run and only counts the others. Printed messages go to a buffer of the
+// thread, written out in one piece at the end of each event (Flush, from
+// the EventAction), when it grows large, and at the end of the run. The
+// master then lists the suppressed messages (Summary).
+//
+//   Log::Warning("unknown particle", "Unknown particle ID ", pdg, " from Pythia");
+namespace Log {
+
+enum class Level { Debug, Info, Warning, Error };
+
+// Process-wide settings, set on the master (TrackOutputMessenger)
+struct Settings {
+    Level level = Level::Info;   // lower levels are dropped without counting
+    G4int limit = 10;            // per key, thread and run; 0 = no limit
+};
+Settings& GetSettings();
+
+namespace detail {
+    // Counts the message; true if it is to be printed
+    G4bool Admit(Level level, const char* key);
+    // Buffer of the calling thread, positioned at a new line
+    std::ostream& Begin(Level level);
+    void End();
+}
+
+template <class... Args>
+void Write(Level level, const char* key, const Args&... args) {
+    if (level < GetSettings().level || !detail::Admit(level, key)) return;
+    (detail::Begin(level) << ... << args);
+    detail::End();
+}
+
+template <class... Args>
+void Debug(const char* key, const Args&... args) { Write(Level::Debug, key, args...); }
+template <class... Args>
+void Info(const char* key, const Args&... args) { Write(Level::Info, key, args...); }
+template <class... Args>
+void Warning(const char* key, const Args&... args) { Write(Level::Warning, key, args...); }
+template <class... Args>
+void Error(const char* key, const Args&... args) { Write(Level::Error, key, args...); }
+
+// Buffer of the calling thread to G4cout / G4cerr
+void Flush();
+// End of a thread's run (workers, generator threads): Flush, and the
+// counts of this thread added to the run totals
+void EndOfThreadRun();
+// Same for a thread that ends with the run (writer, generator threads),
+// then its buffers are freed
+void EndOfThread();
+// Master end of run: suppressed messages, then the totals are reset
+void Summary();
+
+} // namespace Log
+
+#endif
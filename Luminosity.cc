@@ -0,0 +1,56 @@
+#include "Luminosity.hh"
+
+#include <cctype>
+#include <cmath>
+#include <iostream>
+
+namespace Luminosity {
+
+bool GetMatProps(const std::string& nuc, long double& M, long double& rho) {
+  std::string k = nuc; for (auto& c : k) c = std::toupper(c);
+  if (k=="U"  || k=="URANIUM") { M=238.0L;  rho=18.95L;  return true; }
+  if (k=="C"  || k=="CARBON")  { M=12.01L;  rho=2.267L;  return true; }
+  if (k=="H"  || k=="HYDROGEN"){ M=1.008L;  rho=0.08988e-3L; return true; }
+  if (k=="AL" || k=="ALUMINUM"){ M=26.98L;  rho=2.70L;   return true; }
+  if (k=="CU" || k=="COPPER")  { M=63.546L; rho=8.96L;   return true; }
+  if (k=="PB" || k=="LEAD")    { M=207.2L;  rho=11.34L;  return true; }
+  if (k=="BE" || k=="BERYLLIUM"){ M=9.012L;  rho=1.848L;  return true; }
+  return false;
+}
+
+long long ComputeEvents(double sigma_mb, const std::string& nucleus) {
+  long double M=0.0L, rho=0.0L;
+  if (!GetMatProps(nucleus, M, rho)) {
+    std::cerr << "[ERROR] Unknown nucleus/material: " << nucleus << "\n";
+    return 0;
+  }
+
+  // Areal density [atoms/cm^2]
+  const long double RHOT = (phys::NA / M) * rho * phys::THICK;
+
+  // Luminosity [cm^-2 s^-1]
+  const long double L = phys::PHI * RHOT;
+
+  // sigma: mb -> barns -> cm^2
+  const long double sigma_b = (long double)sigma_mb * 1.0e-3L; // mb -> b
+  const long double sigma_c = sigma_b * 1.0e-24L;              // b  -> cm^2
+
+  // Events over one week
+  long double N = L * phys::WEEK * sigma_c * phys::EFF;
+
+  // Clamp to signed 64-bit
+  if (N < 0.0L) N = 0.0L;
+  constexpr long double Nmax64 = 9.22e18L;
+  if (N > Nmax64) {
+    std::cerr << "[WARN] N exceeds 64-bit range; clamping to " << (long double)Nmax64 << "\n";
+    N = Nmax64;
+  }
+  return static_cast<long long>(llround(N));
+}
+
+Settings& GetSettings() {
+  static Settings settings;
+  return settings;
+}
+
+} // namespace Luminosity
@@ -0,0 +1,38 @@
+#ifndef LUMINOSITY_HH
+#define LUMINOSITY_HH
+
+#include <string>
+
+// Fixed-target luminosity: cross section -> events in one week of beam.
+// Also gives the normalisation of a weighted production, where the Pythia
+// events generated in a run (acceptance filter trials included) stand for
+// the ComputeEvents() count.
+namespace Luminosity {
+
+namespace phys {
+  constexpr long double NA   = 6.02214076e23L;   // Avogadro [mol^-1]
+  constexpr long double WEEK = 7.0L*24.0L*3600.0L; // [s] = 604800
+  constexpr long double THICK = 1.0L;            // t = 1 cm (fixed target)
+  constexpr long double EFF   = 1.0L;            // Efficiency
+  // PHI = dN/dt [part/s]. 6.24e18 ~ 1 A ; 6.24e12 ~ 1 µA.
+  constexpr long double PHI  = 6.24e18L;         // beam (part/s)
+}
+
+bool GetMatProps(const std::string& nuc, long double& M, long double& rho);
+
+// Events in one week for `sigma_mb` on `nucleus` (0 if the nucleus is unknown)
+long long ComputeEvents(double sigma_mb, const std::string& nucleus);
+
+// Weighted production settings, set on the master (main.cc, GeneratorMessenger)
+struct Settings {
+    double      sigma_mb   = 0.;     // cross section used for the normalisation
+    std::string target     = "H";
+    long long   eventsPerWeek = 0;   // ComputeEvents of the run, 0 = unnormalised
+    long long   trials     = 0;      // Pythia events of the run, set at end of run
+    double      eventScale = 1.;     // eventsPerWeek / trials, set at end of run
+};
+Settings& GetSettings();
+
+} // namespace Luminosity
+
+#endif
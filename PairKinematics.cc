@@ -0,0 +1,168 @@
+#include "PairKinematics.hh"
+
+#include <algorithm>
+#include <cmath>
+
+namespace PairKinematics {
+
+namespace {
+
+// atan2 without a libm call, so that the pair loop vectorizes without
+// -ffast-math. Cephes' atan: argument reduced to [0, 1] (min / max of |y|,
+// |x|), then to [-0.2, 0.66] around pi/4, rational approximation of
+// degree 4/5 in x^2; within 2 ulp of std::atan2 in bench/pairKinematicsBench.
+// atan2(0, 0) = 0 as in std::atan2; no branches.
+inline double Atan2(double y, double x) {
+    constexpr double kPiOver2 = 1.57079632679489661923;
+    constexpr double kPiOver4 = 0.78539816339744830962;
+    constexpr double kPi      = 3.14159265358979323846;
+    constexpr double kMoreBits = 6.123233995736765886130e-17;   // pi/2 - kPiOver2
+
+    const double ax = std::fabs(x), ay = std::fabs(y);
+    const double hi = std::max(ax, ay), lo = std::min(ax, ay);
+
+    // Around pi/4: atan(lo / hi) = pi/4 + atan((lo - hi) / (lo + hi)).
+    // One division, selects only (no control flow in the caller's loop)
+    const bool upper = lo > 0.66 * hi;
+    const double num = upper ? lo - hi : lo;
+    const double den = upper ? lo + hi : (hi > 0. ? hi : 1.);
+    const double t = num / den;
+    const double z = t * t;
+    const double p = (((-8.750608600031904122785e-1 * z - 1.615753718733365076637e1) * z
+                       - 7.500855792314704667340e1) * z - 1.228866684490136173410e2) * z
+                     - 6.485021904942025371773e1;
+    const double q = ((((z + 2.485846490142306297962e1) * z + 1.650270098316988542046e2) * z
+                       + 4.328810604912902668951e2) * z + 4.853903996359136964868e2) * z
+                     + 1.945506571482613964425e2;
+    double r = t * z * p / q + t;
+    r += upper ? kPiOver4 + 0.5 * kMoreBits : 0.;
+
+    r = ay > ax ? kPiOver2 - r + kMoreBits : r;
+    r = x < 0. ? kPi - r + 2. * kMoreBits : r;
+    return std::copysign(r, y);
+}
+
+} // namespace
+
+BeamConstants BeamConstants::FixedTarget(double eBeam, double mTarget) {
+    BeamConstants c;
+    c.eBeam   = eBeam;
+    c.mTarget = mTarget;
+    c.sqrtS   = std::sqrt(2.0 * eBeam * mTarget);
+    c.s       = c.sqrtS * c.sqrtS;
+    c.betaCM  = (eBeam - mTarget) / (eBeam + mTarget);
+    c.bz      = -c.betaCM;
+    const double b2 = c.bz * c.bz;
+    c.gamma   = 1.0 / std::sqrt(1.0 - b2);
+    c.gamma2  = b2 > 0 ? (c.gamma - 1.0) / b2 : 0.0;
+    return c;
+}
+
+void MuonSoA::Clear() {
+    index.clear();
+    px.clear();
+    py.clear();
+    pz.clear();
+    e.clear();
+}
+
+void MuonSoA::Add(int32_t id, double px_, double py_, double pz_, double e_) {
+    index.push_back(id);
+    px.push_back(px_);
+    py.push_back(py_);
+    pz.push_back(pz_);
+    e.push_back(e_);
+}
+
+void PairSoA::Resize(std::size_t n) {
+    iPlus.resize(n);
+    iMinus.resize(n);
+    mass.resize(n);
+    pT.resize(n);
+    y.resize(n);
+    xF.resize(n);
+    x1.resize(n);
+    x2.resize(n);
+    theta.resize(n);
+    phi.resize(n);
+    sumPx.resize(n);
+    sumPy.resize(n);
+    sumPz.resize(n);
+    sumE.resize(n);
+}
+
+void Compute(const BeamConstants& beam, const MuonSoA& plus, const MuonSoA& minus,
+             PairSoA& out) {
+    const std::size_t nPlus = plus.Size();
+    const std::size_t nMinus = minus.Size();
+    const std::size_t n = nPlus * nMinus;
+    out.Resize(n);
+    if (n == 0) return;
+
+    // Gather: pair four-momenta
+    std::size_t k = 0;
+    for (std::size_t i = 0; i < nPlus; ++i) {
+        for (std::size_t j = 0; j < nMinus; ++j, ++k) {
+            out.iPlus[k]  = static_cast<int32_t>(i);
+            out.iMinus[k] = static_cast<int32_t>(j);
+            out.sumPx[k]  = plus.px[i] + minus.px[j];
+            out.sumPy[k]  = plus.py[i] + minus.py[j];
+            out.sumPz[k]  = plus.pz[i] + minus.pz[j];
+            out.sumE[k]   = plus.e[i]  + minus.e[j];
+        }
+    }
+
+    const double* __restrict px = out.sumPx.data();
+    const double* __restrict py = out.sumPy.data();
+    const double* __restrict pz = out.sumPz.data();
+    const double* __restrict e  = out.sumE.data();
+    double* __restrict mass  = out.mass.data();
+    double* __restrict pT    = out.pT.data();
+    double* __restrict y     = out.y.data();
+    double* __restrict xF    = out.xF.data();
+    double* __restrict x1    = out.x1.data();
+    double* __restrict x2    = out.x2.data();
+    double* __restrict theta = out.theta.data();
+    double* __restrict phi   = out.phi.data();
+
+    const double bz = beam.bz;
+    const double gamma = beam.gamma;
+    const double gamma2 = beam.gamma2;
+    const double twoOverSqrtS = 2.0 / beam.sqrtS;
+    const double fourOverS = 4.0 / beam.s;
+
+#pragma omp simd
+    for (std::size_t p = 0; p < n; ++p) {
+        const double pt2 = px[p] * px[p] + py[p] * py[p];
+        const double pt = std::sqrt(pt2);
+
+        // Lab angles of the pair
+        theta[p] = Atan2(pt, pz[p]);
+        phi[p]   = Atan2(py[p], px[p]);
+
+        // Boost to the CM frame (transverse components unchanged)
+        const double bp = bz * pz[p];
+        const double pzCM = pz[p] + gamma2 * bp * bz + gamma * bz * e[p];
+        const double eCM  = gamma * (e[p] + bp);
+
+        const double m2 = eCM * eCM - (pt2 + pzCM * pzCM);
+        const double m = std::copysign(std::sqrt(std::fabs(m2)), m2);
+
+        pT[p]   = pt;
+        mass[p] = m;
+        y[p]    = (eCM + pzCM) / (eCM - pzCM);   // log below
+
+        const double xf = twoOverSqrtS * pzCM;
+        const double delta = std::sqrt(xf * xf + fourOverS * m * m);
+        xF[p] = xf;
+        x1[p] = 0.5 * (xf + delta);
+        x2[p] = 0.5 * (-xf + delta);
+    }
+
+    // Rapidity: a libm call, in its own loop so that it does not keep the
+    // one above scalar; vectorized too with -ffast-math (libmvec)
+#pragma omp simd
+    for (std::size_t p = 0; p < n; ++p) y[p] = 0.5 * std::log(y[p]);
+}
+
+} // namespace PairKinematics
@@ -0,0 +1,55 @@
+#ifndef PAIRKINEMATICS_HH
+#define PAIRKINEMATICS_HH
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Batch dimuon kinematics for fixed-target collisions.
+// Inputs and outputs are structure-of-arrays in GeV; the pair loop has no
+// branches so the compiler can vectorize it.
+namespace PairKinematics {
+
+// Per-run constants, computed once from the beam energy
+struct BeamConstants {
+    double eBeam   = 0.;
+    double mTarget = 0.;
+    double sqrtS   = 0.;
+    double s       = 0.;
+    double betaCM  = 0.;
+    // Lorentz boost lab -> CM along z (TLorentzVector::Boost conventions)
+    double bz      = 0.;
+    double gamma   = 1.;
+    double gamma2  = 0.;
+
+    static BeamConstants FixedTarget(double eBeam, double mTarget = 0.938);
+};
+
+struct MuonSoA {
+    std::vector<int32_t> index;   // caller's identifier (e.g. hit slot)
+    std::vector<double>  px, py, pz, e;
+
+    void Clear();
+    void Add(int32_t id, double px_, double py_, double pz_, double e_);
+    std::size_t Size() const { return px.size(); }
+};
+
+struct PairSoA {
+    std::vector<int32_t> iPlus, iMinus;  // positions in the input MuonSoA
+    std::vector<double>  mass, pT, y, xF, x1, x2, theta, phi;
+
+    void Resize(std::size_t n);
+    std::size_t Size() const { return iPlus.size(); }
+
+    // Scratch: summed four-momenta
+    std::vector<double> sumPx, sumPy, sumPz, sumE;
+};
+
+// All mu+ x mu- combinations, plus-major order (same as the nested loop
+// in EICSensitiveDetector::EndOfEvent). `out` is reused between calls.
+void Compute(const BeamConstants& beam, const MuonSoA& plus, const MuonSoA& minus,
+             PairSoA& out);
+
+} // namespace PairKinematics
+
+#endif
@@ -0,0 +1,198 @@
+#include "PrimaryCache.hh"
+
+#include "G4ios.hh"
+
+#include <algorithm>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace PrimaryCache {
+
+namespace {
+    const char     kMagic[8] = {'E', 'I', 'C', 'P', 'R', 'I', 'M', '\0'};
+    const uint32_t kVersion  = 2;   // 2: trials and accepted in the index
+
+    Header EmptyHeader() {
+        Header header;
+        std::memset(&header, 0, sizeof(header));
+        std::memcpy(header.magic, kMagic, sizeof(kMagic));
+        header.version = kVersion;
+        header.muonSize = sizeof(PrimaryMuon);
+        header.muonOffset = sizeof(Header);
+        return header;
+    }
+}
+
+static_assert(sizeof(PrimaryMuon) == 40, "PrimaryMuon must not contain padding");
+static_assert(sizeof(IndexEntry) == 40, "IndexEntry must not contain padding");
+
+Settings& GetSettings() {
+    static Settings settings;
+    return settings;
+}
+
+// ---------------------------------------------------------------- Writer
+
+Writer& Writer::Instance() {
+    static Writer writer;
+    return writer;
+}
+
+G4bool Writer::Open(const G4String& fileName) {
+    Close();
+
+    std::lock_guard<std::mutex> lock(fMutex);
+    fFile = std::fopen(fileName.c_str(), "wb");
+    if (!fFile) {
+        G4cerr << "Error: Could not create primary cache " << fileName << G4endl;
+        return false;
+    }
+    fBuffer.resize(1 << 20);
+    std::setvbuf(fFile, fBuffer.data(), _IOFBF, fBuffer.size());
+
+    // Placeholder, rewritten by Close() once the counts are known
+    const Header header = EmptyHeader();
+    std::fwrite(&header, sizeof(header), 1, fFile);
+    fIndex.clear();
+    fNMuons = 0;
+    return true;
+}
+
+void Writer::Append(G4int eventID, const GeneratedEvent& event) {
+    std::lock_guard<std::mutex> lock(fMutex);
+    if (!fFile) return;
+
+    const auto n = static_cast<uint32_t>(event.muons.size());
+    if (n > 0) std::fwrite(event.muons.data(), sizeof(PrimaryMuon), n, fFile);
+    fIndex.push_back({eventID, n, fNMuons, event.weight, event.seed, static_cast<uint32_t>(event.trials),
+                      event.accepted ? 1u : 0u});
+    fNMuons += n;
+}
+
+void Writer::Close() {
+    std::lock_guard<std::mutex> lock(fMutex);
+    if (!fFile) return;
+
+    // Workers finish events out of order: the index is what makes replay
+    // follow the event IDs
+    std::stable_sort(fIndex.begin(), fIndex.end(),
+                     [](const IndexEntry& a, const IndexEntry& b) { return a.eventID < b.eventID; });
+
+    Header header = EmptyHeader();
+    header.nEvents = fIndex.size();
+    header.nMuons = fNMuons;
+    header.indexOffset = header.muonOffset + fNMuons * sizeof(PrimaryMuon);
+    if (!fIndex.empty()) std::fwrite(fIndex.data(), sizeof(IndexEntry), fIndex.size(), fFile);
+
+    std::fseek(fFile, 0, SEEK_SET);
+    std::fwrite(&header, sizeof(header), 1, fFile);
+    std::fclose(fFile);
+    fFile = nullptr;
+
+    G4cout << "[GEN] primary cache: " << header.nEvents << " events, "
+           << header.nMuons << " muons recorded" << G4endl;
+    fIndex.clear();
+    fIndex.shrink_to_fit();
+}
+
+// ---------------------------------------------------------------- Reader
+
+Reader& Reader::Instance() {
+    static Reader reader;
+    return reader;
+}
+
+Reader::~Reader() {
+    Close();
+}
+
+G4bool Reader::Open(const G4String& fileName) {
+    Close();
+
+    const int fd = ::open(fileName.c_str(), O_RDONLY);
+    if (fd < 0) {
+        G4cerr << "Error: Could not open primary cache " << fileName << G4endl;
+        return false;
+    }
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || static_cast<std::size_t>(st.st_size) < sizeof(Header)) {
+        G4cerr << "Error: " << fileName << " is not a primary cache" << G4endl;
+        ::close(fd);
+        return false;
+    }
+    void* data = ::mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);   // the mapping keeps the file
+    if (data == MAP_FAILED) {
+        G4cerr << "Error: Could not map primary cache " << fileName << G4endl;
+        return false;
+    }
+    ::madvise(data, st.st_size, MADV_WILLNEED);
+
+    fData = static_cast<const char*>(data);
+    fSize = st.st_size;
+    fHeader = reinterpret_cast<const Header*>(fData);
+
+    // Sizes compared by division: a corrupt count cannot overflow the check
+    const auto& h = *fHeader;
+    const G4bool valid = std::memcmp(h.magic, kMagic, sizeof(kMagic)) == 0
+        && h.version == kVersion && h.muonSize == sizeof(PrimaryMuon)
+        && h.muonOffset <= fSize && h.nMuons <= (fSize - h.muonOffset) / sizeof(PrimaryMuon)
+        && h.indexOffset <= fSize && h.nEvents <= (fSize - h.indexOffset) / sizeof(IndexEntry);
+    if (!valid) {
+        G4cerr << "Error: " << fileName << " is not a valid primary cache"
+               << " (unfinished recording or other version)" << G4endl;
+        Close();
+        return false;
+    }
+    fMuons = reinterpret_cast<const PrimaryMuon*>(fData + h.muonOffset);
+    fIndex = reinterpret_cast<const IndexEntry*>(fData + h.indexOffset);
+
+    // Every event inside the muon array, once here rather than on each
+    // Event() call: a truncated or corrupt file fails to open
+    for (uint64_t i = 0; i < h.nEvents; ++i) {
+        const auto& entry = fIndex[i];
+        if (entry.firstMuon > h.nMuons || entry.nMuons > h.nMuons - entry.firstMuon) {
+            G4cerr << "Error: " << fileName << ": event " << entry.eventID << " has muons "
+                   << entry.firstMuon << " + " << entry.nMuons << " of " << h.nMuons
+                   << " (corrupt primary cache)" << G4endl;
+            Close();
+            return false;
+        }
+    }
+
+    G4cout << "[GEN] primary cache " << fileName << ": " << h.nEvents << " events, "
+           << h.nMuons << " muons" << G4endl;
+    return true;
+}
+
+void Reader::Close() {
+    if (!fData) return;
+    ::munmap(const_cast<char*>(fData), fSize);
+    fData = nullptr;
+    fSize = 0;
+    fHeader = nullptr;
+    fMuons = nullptr;
+    fIndex = nullptr;
+}
+
+EventView Reader::Event(G4int eventID) const {
+    EventView view;
+    if (!fHeader || fHeader->nEvents == 0) return view;
+
+    const int64_t n = static_cast<int64_t>(fHeader->nEvents);
+    const int64_t offset = (static_cast<int64_t>(eventID) - fIndex[0].eventID) % n;
+    const auto& entry = fIndex[offset < 0 ? offset + n : offset];
+    view.muons = fMuons + entry.firstMuon;
+    view.nMuons = entry.nMuons;
+    view.weight = entry.weight;
+    view.seed = entry.seed;
+    view.trials = entry.trials;
+    view.accepted = entry.accepted != 0;
+    return view;
+}
+
+} // namespace PrimaryCache
@@ -0,0 +1,109 @@
+#ifndef PRIMARYCACHE_HH
+#define PRIMARYCACHE_HH
+
+#include "globals.hh"
+#include "GeneratorPool.hh"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <vector>
+
+// Record / replay of generated primaries.
+//
+// File layout (native endianness, all offsets in bytes):
+//   Header
+//   PrimaryMuon[nMuons]        streamed while the run is going
+//   IndexEntry[nEvents]        written at Close(), sorted by event ID
+// Replay maps the file and hands out pointers into it: global event
+// first + i gets index entry i (modulo nEvents), `first` being the first
+// recorded event, whatever the thread that processes it.
+namespace PrimaryCache {
+
+enum class Mode { Off, Record, Replay };
+
+// Process-wide settings, set on the master (GeneratorMessenger)
+struct Settings {
+    Mode     mode = Mode::Off;
+    G4String fileName = "primaries.bin";
+};
+Settings& GetSettings();
+
+struct Header {
+    char     magic[8];          // "EICPRIM\0"
+    uint32_t version;
+    uint32_t muonSize;          // sizeof(PrimaryMuon)
+    uint64_t nEvents;
+    uint64_t nMuons;
+    uint64_t muonOffset;
+    uint64_t indexOffset;
+};
+
+struct IndexEntry {
+    int32_t  eventID;
+    uint32_t nMuons;
+    uint64_t firstMuon;         // position in the muon array
+    double   weight;
+    uint64_t seed;
+    uint32_t trials;            // Pythia events behind this one (filter)
+    uint32_t accepted;          // 0: none passed within maxTrials
+};
+
+// Recording side: one file per run, Append() is called by every worker
+class Writer {
+public:
+    static Writer& Instance();
+
+    G4bool Open(const G4String& fileName);
+    void Close();
+    G4bool IsOpen() const { return fFile != nullptr; }
+
+    void Append(G4int eventID, const GeneratedEvent& event);
+
+private:
+    Writer() = default;
+
+    std::mutex fMutex;
+    std::FILE* fFile = nullptr;
+    std::vector<char> fBuffer;
+    std::vector<IndexEntry> fIndex;
+    uint64_t fNMuons = 0;
+};
+
+// Muons of one replayed event: points into the mapped file
+struct EventView {
+    const PrimaryMuon* muons = nullptr;
+    uint32_t nMuons = 0;
+    double   weight = 1.;
+    uint64_t seed = 0;
+    uint32_t trials = 1;
+    G4bool   accepted = true;
+};
+
+// Replay side: read-only mapping shared by all threads
+class Reader {
+public:
+    static Reader& Instance();
+    ~Reader();
+
+    G4bool Open(const G4String& fileName);
+    void Close();
+    G4bool IsOpen() const { return fData != nullptr; }
+
+    uint64_t NumberOfEvents() const { return fHeader ? fHeader->nEvents : 0; }
+    EventView Event(G4int eventID) const;
+
+private:
+    Reader() = default;
+
+    const char*       fData = nullptr;
+    std::size_t       fSize = 0;
+    const Header*     fHeader = nullptr;
+    const PrimaryMuon* fMuons = nullptr;
+    const IndexEntry* fIndex = nullptr;
+};
+
+} // namespace PrimaryCache
+
+#endif
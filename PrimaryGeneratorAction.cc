@@ -1,7 +1,6 @@
 #include "PrimaryGeneratorAction.hh"
 #include "EICDetectorConstruction.hh"
-#include "PrimaryGeneratorAction.hh"
-#include "EICDetectorConstruction.hh"
+#include "EventInformation.hh"
 
 #include "G4PrimaryVertex.hh"
 #include "G4ParticleTable.hh"
@@ -9,69 +8,88 @@
 #include "G4ParticleDefinition.hh"
 #include "G4Event.hh"
 #include "G4SystemOfUnits.hh"
+#include "G4Threading.hh"
+#include "Randomize.hh"
 #include "TLorentzVector.h"
 #include "TTree.h"
 #include "TFile.h"
+#include "GeneratorPool.hh"
+#include "PrimaryCache.hh"
+#include "AcceptanceFilter.hh"
+#include "GeneratorConfig.hh"
+#include "Production.hh"
+#include "Luminosity.hh"
+#include "Log.hh"
+
+#include <chrono>
+#include <cmath>
 
 
 PrimaryGeneratorAction::PrimaryGeneratorAction(EICDetectorConstruction* detector)
- : fDetector(detector),
+ : fPythia(nullptr),
+   fDetector(detector),
    fVertexPosition(0., 0., 0.)
+{}
+
+PrimaryGeneratorAction::~PrimaryGeneratorAction() {
+    delete fPythia;
+}
+
+void PrimaryGeneratorAction::ConfigurePythia(Pythia8::Pythia& pythia)
 {
-    fPythia = new Pythia8::Pythia();
-
-    // Config Pythia fixed target
-    fPythia->readString("Beams:idA = 2212");
-    fPythia->readString("Beams:idB = 2212");
-    fPythia->readString("Beams:eA = 100.");
-    fPythia->readString("Beams:eB = 0.");
-    fPythia->readString("Beams:frameType = 2");
-    //fPythia->readString("HardQCD:all = on");
-    
-    fPythia->readString("Charmonium:all = on");
-    fPythia->readString("443:onMode = off");
-    fPythia->readString("443:onIfMatch = 13 -13");
-    
-    fPythia->readString("100443:onMode = off");
-    fPythia->readString("100443:onIfMatch = 13 -13");
+    GeneratorConfig::Instance().Apply(pythia);
+}
 
-    
-    // ccbar
-    //fPythia->readString("HardQCD:hardccbar = on");
-
-    /*
-    // To muons
-    // D0 (421), D+ (411), D_s+ (431) and opp.c
-
-    // D0 → muons
-    fPythia->readString("421:onMode = off");
-    fPythia->readString("421:onIfAny = 13");
-
-    // anti-D0
-    fPythia->readString("-421:onMode = off");
-    fPythia->readString("-421:onIfAny = 13");
-
-    // D+
-    fPythia->readString("411:onMode = off");
-    fPythia->readString("411:onIfAny = 13");
-
-    // D-
-    fPythia->readString("-411:onMode = off");
-    fPythia->readString("-411:onIfAny = 13");
-
-    // Ds+
-    fPythia->readString("431:onMode = off");
-    fPythia->readString("431:onIfAny = 13");
-
-    // Ds-
-    fPythia->readString("-431:onMode = off");
-    fPythia->readString("-431:onIfAny = 13");
-     */
-    fPythia->init();
+void PrimaryGeneratorAction::SelectMuons(const Pythia8::Event& event, std::vector<PrimaryMuon>& muons)
+{
+    muons.clear();
+    for (int i = 0; i < event.size(); ++i) {
+        const auto& p = event[i];
+        if (!p.isFinal()) continue;
+        if( p.id() != 13 && p.id() != -13) continue; //muons
+        muons.push_back({p.id(), p.status(), p.px(), p.py(), p.pz(), p.e()});
+    }
 }
 
-PrimaryGeneratorAction::~PrimaryGeneratorAction() {
-    delete fPythia;
+void PrimaryGeneratorAction::NextAccepted(Pythia8::Pythia& pythia, GeneratedEvent& event)
+{
+    const auto& filter = AcceptanceFilter::GetSettings();
+
+    event.muons.clear();
+    event.weight = 1.;
+    event.accepted = true;
+    for (event.trials = 1; ; ++event.trials) {
+        if (pythia.next()) {
+            SelectMuons(pythia.event, event.muons);
+            if (AcceptanceFilter::Accept(event.muons, filter)) break;
+        }
+        if (event.trials >= filter.maxTrials) {
+            Log::Warning("no event in acceptance", "no event in acceptance after ",
+                         event.trials, " Pythia events");
+            event.muons.clear();
+            event.weight = 0.;
+            event.accepted = false;
+            return;
+        }
+    }
+    event.weight = pythia.info.weight();
+}
+
+void PrimaryGeneratorAction::ShootMuon(GeneratedEvent& event)
+{
+    const auto& gun = GeneratorConfig::Instance().GetGun();
+    const G4double p = gun.pMin + (gun.pMax - gun.pMin) * G4UniformRand();
+    const G4double cosTheta = 1. - (1. - std::cos(gun.thetaMax)) * G4UniformRand();
+    const G4double sinTheta = std::sqrt(1. - cosTheta * cosTheta);
+    const G4double phi = CLHEP::twopi * G4UniformRand();
+    const G4int pdg = G4UniformRand() < 0.5 ? 13 : -13;
+    const G4double mass = 0.1056583755;   // GeV
+
+    event.muons.assign(1, {pdg, 1, p * sinTheta * std::cos(phi), p * sinTheta * std::sin(phi),
+                           p * cosTheta, std::sqrt(p * p + mass * mass)});
+    event.weight = 1.;
+    event.trials = 1;
+    event.accepted = true;
 }
 
 void PrimaryGeneratorAction::GeneratePrimaries(G4Event* anEvent) {
@@ -79,8 +97,91 @@ void PrimaryGeneratorAction::GeneratePrimaries(G4Event* anEvent) {
         fVertexPosition = fDetector->GetTargetPosition();
     }
 
-    if (!fPythia->next()) return;
+    using Clock = std::chrono::steady_clock;
+    const auto start = Clock::now();
+
+    // Per-event seeds: the event does not depend on the thread or shard
+    // that runs it. Set here, after the run manager's own reseeding.
+    const G4int globalID = Production::GlobalEventID(anEvent->GetEventID());
+    const G4bool seeded = Production::IsSeeded();
+    Production::EventSeeds seeds{};
+    if (seeded) {
+        seeds = Production::SeedsFor(Production::GetSettings().seed, globalID);
+        long g4Seeds[3] = {seeds.geant4[0], seeds.geant4[1], 0};
+        G4Random::setTheSeeds(g4Seeds);
+    }
+
+    // Replay: muons straight from the mapped cache, no Pythia at all
+    auto& reader = PrimaryCache::Reader::Instance();
+    if (reader.IsOpen()) {
+        const auto view = reader.Event(globalID);
+        fCounters.generationTime += std::chrono::duration<G4double>(Clock::now() - start).count();
+        fCounters.trials += view.trials;
+        if (view.accepted) ++fCounters.accepted;
+        SetWeight(anEvent, view.weight);
+        AddPrimaries(anEvent, view.muons, view.nMuons);
+        return;
+    }
+
+    const GeneratedEvent* event = nullptr;
+    GeneratedEvent* pooled = nullptr;
+
+    auto& pool = GeneratorPool::Instance();
+    if (GeneratorConfig::Instance().GetProcess() == GeneratorConfig::Process::SingleMuon) {
+        // Particle gun: G4Random, already seeded for this event
+        ShootMuon(fEvent);
+        fEvent.seed = seeded ? static_cast<uint64_t>(seeds.geant4[0]) : 0;
+        event = &fEvent;
+    } else if (pool.IsRunning()) {
+        // Pre-generated: only the wait for the ring counts as generation time
+        pooled = pool.Acquire();
+        event = pooled;
+    } else {
+        // Pythia on this worker, created on first use and rebuilt only
+        // when the generator settings changed since
+        const G4int version = GeneratorConfig::Instance().GetVersion();
+        if (!fPythia || fPythiaVersion != version) {
+            delete fPythia;
+            fPythia = new Pythia8::Pythia();
+            ConfigurePythia(*fPythia);
+            if (!fPythia->init()) {
+                G4cerr << "Error: Pythia initialization failed" << G4endl;
+            }
+            fPythiaVersion = version;
+            // Without per-event seeds: one stream per worker and build, not
+            // Pythia's default seed on every worker
+            if (!seeded) {
+                const G4int key = (G4Threading::G4GetThreadId() << 16) + fPythiaBuilds++;
+                fPythiaSeed = Production::SeedsFor(Production::GetSettings().streamSeed, key).pythia;
+                fPythia->rndm.init(fPythiaSeed);
+            }
+        }
+        if (seeded) fPythia->rndm.init(seeds.pythia);
+        NextAccepted(*fPythia, fEvent);
+        fEvent.seed = static_cast<uint64_t>(seeded ? seeds.pythia : fPythiaSeed);
+        event = &fEvent;
+    }
+    fCounters.generationTime += std::chrono::duration<G4double>(Clock::now() - start).count();
+    if (!event) return;
+    fCounters.trials += event->trials;
+    if (event->accepted) ++fCounters.accepted;
+
+    auto& writer = PrimaryCache::Writer::Instance();
+    if (writer.IsOpen()) writer.Append(globalID, *event);
+
+    SetWeight(anEvent, event->weight);
+    AddPrimaries(anEvent, event->muons.data(), event->muons.size());
+    if (pooled) pool.Release(pooled);
+}
+
+void PrimaryGeneratorAction::SetWeight(G4Event* anEvent, G4double pythiaWeight) {
+    // Pythia weight undoes the phase-space bias. The filter trials and the
+    // week of luminosity enter once per run (Luminosity eventScale), not
+    // per event: an event passing after n trials is not worth n events
+    anEvent->SetUserInformation(new EventInformation(pythiaWeight));
+}
 
+void PrimaryGeneratorAction::AddPrimaries(G4Event* anEvent, const PrimaryMuon* muons, std::size_t nMuons) {
     G4PrimaryVertex* vertex = new G4PrimaryVertex(fVertexPosition, 0.);
 
     G4ParticleTable* particleTable = G4ParticleTable::GetParticleTable();
@@ -88,23 +189,19 @@ void PrimaryGeneratorAction::GeneratePrimaries(G4Event* anEvent) {
     G4PrimaryParticle* firstPrimary = nullptr;
     G4PrimaryParticle* lastPrimary = nullptr;
 
-    for (int i = 0; i < fPythia->event.size(); ++i) {
-        const auto& p = fPythia->event[i];
-        if (!p.isFinal()) continue;
+    for (std::size_t i = 0; i < nMuons; ++i) {
+        const PrimaryMuon& mu = muons[i];
+        G4ParticleDefinition* particleDef = particleTable->FindParticle(mu.pdg);
 
-        G4ParticleDefinition* particleDef = particleTable->FindParticle(p.id());
-        
-        if( p.id() != 13 && p.id() != -13) continue; //muons
-        
         if (!particleDef) {
-            G4cerr << "Unknown particle ID " << p.id() << " from Pythia" << G4endl;
+            Log::Warning("unknown particle", "Unknown particle ID ", mu.pdg, " from Pythia");
             continue;
         }
         
         G4PrimaryParticle* primary = new G4PrimaryParticle(particleDef,
-                                                         p.px() * GeV,
-                                                         p.py() * GeV,
-                                                         p.pz() * GeV);
+                                                         mu.px * GeV,
+                                                         mu.py * GeV,
+                                                         mu.pz * GeV);
         if (!firstPrimary) {
             firstPrimary = primary;
             lastPrimary = primary;
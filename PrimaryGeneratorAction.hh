@@ -5,6 +5,10 @@
 #include "G4ThreeVector.hh"
 #include "Pythia8/Pythia.h"
 #include "Rtypes.h"
+#include "GeneratorPool.hh"
+
+#include <cstddef>
+#include <vector>
 
 class TFile;
 class TTree;
@@ -20,10 +24,38 @@ public:
 
     void SetVertexPosition(const G4ThreeVector& pos) { fVertexPosition = pos; }
 
+    // Cumulative over the runs of this thread
+    struct Counters {
+        G4double generationTime = 0.;  // s obtaining events (Pythia, pool wait or cache)
+        G4long   trials   = 0;         // Pythia events behind the accepted ones
+        G4long   accepted = 0;         // events that passed the filter
+    };
+    const Counters& GetCounters() const { return fCounters; }
+
+    // GeneratorConfig settings, shared with the generator pool threads
+    static void ConfigurePythia(Pythia8::Pythia& pythia);
+    // Final-state mu+/mu- of a Pythia event
+    static void SelectMuons(const Pythia8::Event& event, std::vector<PrimaryMuon>& muons);
+    // Pythia events until one passes the AcceptanceFilter; a failed next()
+    // counts as a trial and is retried. None within maxTrials: an empty,
+    // unaccepted event of weight 0. Sets muons, weight, trials and accepted.
+    static void NextAccepted(Pythia8::Pythia& pythia, GeneratedEvent& event);
+    // One muon of either charge from G4Random, GeneratorConfig::Gun ranges
+    static void ShootMuon(GeneratedEvent& event);
+
 private:
+    void SetWeight(G4Event* anEvent, G4double pythiaWeight);
+    void AddPrimaries(G4Event* anEvent, const PrimaryMuon* muons, std::size_t nMuons);
+
     Pythia8::Pythia* fPythia;
+    G4int fPythiaVersion = -1;   // GeneratorConfig version fPythia was built from
+    G4int fPythiaBuilds = 0;     // unseeded runs: a new stream per rebuild
+    G4int fPythiaSeed = 0;       // unseeded runs: seed of this worker's stream
     EICDetectorConstruction* fDetector;
     G4ThreeVector fVertexPosition;
+
+    GeneratedEvent fEvent;   // synchronous mode, reused
+    Counters fCounters;
 };
 
 #endif
@@ -0,0 +1,88 @@
+#include "Production.hh"
+#include "GeneratorConfig.hh"
+#include "TrackOutput.hh"
+#include "Luminosity.hh"
+
+#include "G4ios.hh"
+
+#include "TFile.h"
+#include "TTree.h"
+
+#include <cstring>
+
+namespace Production {
+
+Settings& GetSettings() {
+    static Settings settings;
+    return settings;
+}
+
+namespace {
+    uint64_t SplitMix64(uint64_t& state) {
+        uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+}
+
+EventSeeds SeedsFor(uint64_t baseSeed, G4int globalEvent) {
+    // Decorrelated start point per event, then one stream for all engines
+    uint64_t state = baseSeed;
+    state = SplitMix64(state) ^ static_cast<uint64_t>(static_cast<uint32_t>(globalEvent));
+    SplitMix64(state);
+
+    EventSeeds seeds;
+    seeds.pythia    = 1 + static_cast<G4int>(SplitMix64(state) % 899999999ULL);
+    seeds.geant4[0] = 1 + static_cast<long>(SplitMix64(state) % 2147483646ULL);
+    seeds.geant4[1] = 1 + static_cast<long>(SplitMix64(state) % 2147483646ULL);
+    return seeds;
+}
+
+G4String OutputFileName(const G4String& stem) {
+    const auto& settings = GetSettings();
+    if (settings.shard < 0) return stem + ".root";
+    return stem + "_shard" + std::to_string(settings.shard) + ".root";
+}
+
+void WriteRunInfo(const G4String& fileName, G4int nEventsProcessed) {
+    TFile file(fileName.c_str(), "UPDATE");
+    if (file.IsZombie()) {
+        G4cerr << "Error: Could not add RunInfo to " << fileName << G4endl;
+        return;
+    }
+
+    const auto& settings = GetSettings();
+    const auto& config = GeneratorConfig::Instance();
+    Int_t     shard      = settings.shard;
+    Int_t     firstEvent = settings.firstEvent;
+    Int_t     nEvents    = nEventsProcessed;
+    ULong64_t seed       = settings.seed;
+    Double_t  beamEnergy = config.GetBeamEnergy();
+    const auto& lumi = Luminosity::GetSettings();
+    Long64_t  trials     = lumi.trials;
+    Long64_t  eventsPerWeek = lumi.eventsPerWeek;
+    Double_t  eventScale = lumi.eventScale;
+    char      process[16];
+    std::strncpy(process, GeneratorConfig::ProcessName(config.GetProcess()), sizeof(process));
+    process[sizeof(process)-1] = '\0';
+    char      tree[16];
+    std::strncpy(tree, TrackOutput::TreeName(), sizeof(tree));
+    tree[sizeof(tree)-1] = '\0';
+
+    TTree info("RunInfo", "Production shard and settings");
+    info.Branch("Shard", &shard, "Shard/I");
+    info.Branch("FirstEvent", &firstEvent, "FirstEvent/I");
+    info.Branch("NEvents", &nEvents, "NEvents/I");
+    info.Branch("Seed", &seed, "Seed/l");
+    info.Branch("BeamEnergy_GeV", &beamEnergy, "BeamEnergy_GeV/D");
+    info.Branch("Trials", &trials, "Trials/L");
+    info.Branch("EventsPerWeek", &eventsPerWeek, "EventsPerWeek/L");
+    info.Branch("EventScale", &eventScale, "EventScale/D");
+    info.Branch("Process", process, "Process/C");
+    info.Branch("Tree", tree, "Tree/C");
+    info.Fill();
+    info.Write("", TObject::kOverwrite);
+}
+
+} // namespace Production
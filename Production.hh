@@ -0,0 +1,48 @@
+#ifndef PRODUCTION_HH
+#define PRODUCTION_HH
+
+#include "globals.hh"
+
+#include <cstdint>
+
+// Sharded production: global event numbering and per-event seeds.
+//
+// Event `i` of a run is global event firstEvent + i. With a base seed set,
+// each global event gets its own seeds for Pythia and Geant4, both drawn
+// from one SplitMix64 stream keyed by (base seed, global event). An event is
+// then reproduced bit for bit whatever the shard, thread or thread count.
+namespace Production {
+
+// Set once from the command line (main.cc)
+struct Settings {
+    G4int    shard      = -1;   // -1 = not a sharded production
+    G4int    firstEvent = 0;
+    G4int    nEvents    = -1;   // -1 = not given
+    uint64_t seed       = 0;    // 0 = no per-event seeds
+    // Runs without --seed: base of the per-worker Pythia streams, drawn at
+    // start-up, so the workers do not all replay Pythia's default stream
+    uint64_t streamSeed = 0;
+};
+Settings& GetSettings();
+
+inline G4bool IsSeeded() { return GetSettings().seed != 0; }
+
+// Global number of event `eventID` of the current run
+inline G4int GlobalEventID(G4int eventID) { return GetSettings().firstEvent + eventID; }
+
+struct EventSeeds {
+    G4int pythia;     // Pythia8::Rndm::init range: [1, 900000000)
+    long  geant4[2];  // G4Random::setTheSeeds, positive
+};
+EventSeeds SeedsFor(uint64_t baseSeed, G4int globalEvent);
+
+// "tracks_output" -> "tracks_output.root", or "tracks_output_shard<K>.root"
+G4String OutputFileName(const G4String& stem);
+
+// RunInfo tree (one entry) added to a ROOT file: shard, event range, seed
+// and generator settings, read back by mergeShards
+void WriteRunInfo(const G4String& fileName, G4int nEventsProcessed);
+
+} // namespace Production
+
+#endif
@@ -0,0 +1,92 @@
+#include "Readout.hh"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    const double kTwoPi = 2. * M_PI;
+
+    uint32_t Clamp(double index, uint32_t n) {
+        if (index <= 0.) return 0;
+        const auto i = static_cast<uint32_t>(index);
+        return i < n ? i : n - 1;
+    }
+}
+
+ReadoutMap::ReadoutMap(const GeometryDescription::Volume& volume)
+  : fName(volume.name),
+    fKind(volume.readout),
+    fRMin(volume.dims[0]),
+    fRMax(volume.dims[1]),
+    fHalfZ(volume.dims[2]),
+    fLsb(volume.adc[0]),
+    fThreshold(volume.adc[1])
+{
+    if (fKind == GeometryDescription::Readout::Disk) {
+        const double pitchR = volume.pitch[0];
+        const auto nRings = static_cast<uint32_t>(std::ceil((fRMax - fRMin) / pitchR));
+        fInvPitchR = 1. / pitchR;
+        fRings.reserve(nRings);
+        for (uint32_t i = 0; i < nRings; ++i) {
+            const double r = std::min(fRMin + (i + 0.5) * pitchR, fRMax);
+            const auto cells = std::max<uint32_t>(1, static_cast<uint32_t>(std::ceil(kTwoPi * r / volume.pitch[1])));
+            fRings.push_back({fChannels, cells, cells / kTwoPi});
+            fChannels += cells;
+        }
+    } else {
+        const double r = 0.5 * (fRMin + fRMax);
+        const auto cells = std::max<uint32_t>(1, static_cast<uint32_t>(std::ceil(kTwoPi * r / volume.pitch[0])));
+        fZCells = std::max<uint32_t>(1, static_cast<uint32_t>(std::ceil(2. * fHalfZ / volume.pitch[1])));
+        fInvPitchZ = fZCells / (2. * fHalfZ);
+        fRings.push_back({0, cells, cells / kTwoPi});
+        fChannels = cells * fZCells;
+    }
+}
+
+uint32_t ReadoutMap::Channel(double x, double y, double z) const {
+    const double phi = std::atan2(y, x) + M_PI;   // [0, 2 pi]
+    if (fKind == GeometryDescription::Readout::Disk) {
+        const double r = std::sqrt(x * x + y * y);
+        const auto& ring = fRings[Clamp((r - fRMin) * fInvPitchR, fRings.size())];
+        return ring.first + Clamp(phi * ring.cellsPerRad, ring.cells);
+    }
+    const auto& ring = fRings[0];
+    return Clamp((z + fHalfZ) * fInvPitchZ, fZCells) * ring.cells + Clamp(phi * ring.cellsPerRad, ring.cells);
+}
+
+void ReadoutMap::Centre(uint32_t channel, double& r, double& phi, double& z) const {
+    if (fKind == GeometryDescription::Readout::Disk) {
+        // Last ring starting at or before the channel
+        const auto it = std::upper_bound(fRings.begin(), fRings.end(), channel,
+                                         [](uint32_t c, const Ring& ring) { return c < ring.first; }) - 1;
+        r = std::min(fRMin + (it - fRings.begin() + 0.5) / fInvPitchR, fRMax);
+        phi = (channel - it->first + 0.5) / it->cellsPerRad - M_PI;
+        z = 0.;
+        return;
+    }
+    const auto& ring = fRings[0];
+    r = 0.5 * (fRMin + fRMax);
+    phi = (channel % ring.cells + 0.5) / ring.cellsPerRad - M_PI;
+    z = (channel / ring.cells + 0.5) / fInvPitchZ - fHalfZ;
+}
+
+void Digitizer::Digitize(std::vector<DigitRecord>& digits) {
+    digits.clear();
+    std::sort(fDeposits.begin(), fDeposits.end(),
+              [](const std::pair<uint64_t, double>& a, const std::pair<uint64_t, double>& b) {
+                  return a.first < b.first;
+              });
+    for (std::size_t i = 0; i < fDeposits.size();) {
+        const uint64_t key = fDeposits[i].first;
+        double edep = 0.;
+        for (; i < fDeposits.size() && fDeposits[i].first == key; ++i) edep += fDeposits[i].second;
+
+        const auto detector = static_cast<uint16_t>(key >> 32);
+        const auto& map = fMaps[detector];
+        if (edep < map.Threshold()) continue;
+        const double counts = std::round(edep / map.Lsb());
+        digits.push_back({detector, static_cast<uint16_t>(std::min<double>(counts, kMaxADC)),
+                          static_cast<uint32_t>(key)});
+    }
+    fDeposits.clear();
+}
@@ -0,0 +1,70 @@
+#ifndef READOUT_HH
+#define READOUT_HH
+
+#include "GeometryDescription.hh"
+#include "EventRecord.hh"
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+// Channel numbering of a segmented sensitive tube (GeometryDescription
+// readout=, pitch=, adc=). Local coordinates of the tube, cm.
+//  disk:   rings of pitch[0] in r from rMin, each cut into phi cells of
+//          about pitch[1] of arc, so that cells keep the same size outwards
+//  barrel: pads of pitch[0] of arc (at the mean radius) by pitch[1] in z
+// The ring table is built once; a lookup is one table read and a multiply
+// per coordinate. No Geant4 dependency: reconstruction uses the same maps.
+class ReadoutMap {
+public:
+    explicit ReadoutMap(const GeometryDescription::Volume& volume);
+
+    const std::string& Name() const { return fName; }
+    uint32_t Channels() const { return fChannels; }
+    double Lsb() const { return fLsb; }               // keV per ADC count
+    double Threshold() const { return fThreshold; }   // keV
+
+    uint32_t Channel(double x, double y, double z) const;
+    // Centre of a channel: r, phi, z (local, cm)
+    void Centre(uint32_t channel, double& r, double& phi, double& z) const;
+
+private:
+    struct Ring {
+        uint32_t first;         // first channel of the ring
+        uint32_t cells;
+        double   cellsPerRad;
+    };
+
+    std::string fName;
+    GeometryDescription::Readout fKind;
+    double   fRMin, fRMax, fHalfZ;
+    double   fInvPitchR = 0.;   // disk
+    double   fInvPitchZ = 0.;   // barrel
+    uint32_t fZCells = 1;       // barrel
+    std::vector<Ring> fRings;   // disk: by ring; barrel: the single phi ring
+    uint32_t fChannels = 0;
+    double   fLsb, fThreshold;
+};
+
+// Energy deposits of one event summed per channel, turned into ADC counts.
+// Detector d is readout map d (readout volumes in description order).
+class Digitizer {
+public:
+    static constexpr uint32_t kMaxADC = 65535;
+
+    explicit Digitizer(const std::vector<ReadoutMap>& maps) : fMaps(maps) {}
+
+    void Clear() { fDeposits.clear(); }
+    void Add(uint16_t detector, double x, double y, double z, double edepKeV) {
+        const uint32_t channel = fMaps[detector].Channel(x, y, z);
+        fDeposits.emplace_back(uint64_t(detector) << 32 | channel, edepKeV);
+    }
+    // Channels above threshold, sorted by detector and channel; clears
+    void Digitize(std::vector<DigitRecord>& digits);
+
+private:
+    const std::vector<ReadoutMap>& fMaps;
+    std::vector<std::pair<uint64_t, double>> fDeposits;   // (detector, channel), keV
+};
+
+#endif
@@ -0,0 +1,270 @@
+#include "RegionMessenger.hh"
+#include "DetectorRegions.hh"
+#include "StackingAction.hh"
+#include "SteppingAction.hh"
+#include "FastShowerModel.hh"
+#include "StepProfiler.hh"
+
+#include "G4UIdirectory.hh"
+#include "G4UIcommand.hh"
+#include "G4UIparameter.hh"
+#include "G4UIcmdWithABool.hh"
+#include "G4UIcmdWithADoubleAndUnit.hh"
+#include "G4UIcmdWithAString.hh"
+#include "G4UIcmdWithAnInteger.hh"
+#include "G4RunManager.hh"
+#include "G4SystemOfUnits.hh"
+#include "G4ios.hh"
+
+#include <sstream>
+
+RegionMessenger::RegionMessenger()
+{
+    fRegionDirectory = new G4UIdirectory("/eic/region/");
+    fRegionDirectory->SetGuidance("Production cuts and user limits per detector region:");
+    fRegionDirectory->SetGuidance("  Tracking, BarrelCalo, ForwardCalo, Magnet. 0 = default / no limit.");
+
+    fCutCmd = NewRegionCommand("/eic/region/cut", "Production cut (all particles) of a region.", "mm");
+    fMaxStepCmd = NewRegionCommand("/eic/region/maxStep", "Maximum step length in a region.", "mm");
+    fMinEkinCmd = NewRegionCommand("/eic/region/minEkin",
+                                   "Tracks below this kinetic energy are stopped in a region.", "MeV");
+
+    fStackDirectory = new G4UIdirectory("/eic/stack/");
+    fStackDirectory->SetGuidance("Secondary track killing outside the tracking region.");
+
+    fKillCmd = new G4UIcmdWithABool("/eic/stack/killSecondaries", this);
+    fKillCmd->SetGuidance("Kill non-muon secondaries below /eic/stack/killBelow");
+    fKillCmd->SetGuidance("unless they are created in the Tracking region.");
+    fKillCmd->SetParameterName("enable", true);
+    fKillCmd->SetDefaultValue(true);
+    fKillCmd->SetToBeBroadcasted(false);
+    fKillCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+    fKillBelowCmd = new G4UIcmdWithADoubleAndUnit("/eic/stack/killBelow", this);
+    fKillBelowCmd->SetGuidance("Kinetic energy threshold of the secondary killing.");
+    fKillBelowCmd->SetParameterName("E", false);
+    fKillBelowCmd->SetRange("E>=0");
+    fKillBelowCmd->SetDefaultUnit("MeV");
+    fKillBelowCmd->SetToBeBroadcasted(false);
+    fKillBelowCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+    fEarlyEndDirectory = new G4UIdirectory("/eic/earlyEnd/");
+    fEarlyEndDirectory->SetGuidance("End the event once every primary muon has left the envelope");
+    fEarlyEndDirectory->SetGuidance("of the sensitive volumes (r > rMax, z < zMin or z > zMax), stopped or decayed.");
+
+    fEarlyEndModeCmd = new G4UIcmdWithAString("/eic/earlyEnd/mode", this);
+    fEarlyEndModeCmd->SetGuidance("  off     : track every particle (default)");
+    fEarlyEndModeCmd->SetGuidance("  measure : track every particle, report the time after the decision");
+    fEarlyEndModeCmd->SetGuidance("  abort   : drop the remaining tracks of a decided event");
+    fEarlyEndModeCmd->SetParameterName("mode", false);
+    fEarlyEndModeCmd->SetCandidates("off measure abort");
+    fEarlyEndModeCmd->SetToBeBroadcasted(false);
+    fEarlyEndModeCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+    fEarlyEndRMaxCmd = new G4UIcmdWithADoubleAndUnit("/eic/earlyEnd/rMax", this);
+    fEarlyEndRMaxCmd->SetGuidance("Outer radius of the envelope.");
+    fEarlyEndRMaxCmd->SetParameterName("r", false);
+    fEarlyEndRMaxCmd->SetRange("r>0");
+    fEarlyEndRMaxCmd->SetDefaultUnit("cm");
+    fEarlyEndRMaxCmd->SetToBeBroadcasted(false);
+    fEarlyEndRMaxCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+    fEarlyEndZMinCmd = new G4UIcmdWithADoubleAndUnit("/eic/earlyEnd/zMin", this);
+    fEarlyEndZMinCmd->SetGuidance("Upstream end of the envelope.");
+    fEarlyEndZMinCmd->SetParameterName("z", false);
+    fEarlyEndZMinCmd->SetDefaultUnit("cm");
+    fEarlyEndZMinCmd->SetToBeBroadcasted(false);
+    fEarlyEndZMinCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+    fEarlyEndZMaxCmd = new G4UIcmdWithADoubleAndUnit("/eic/earlyEnd/zMax", this);
+    fEarlyEndZMaxCmd->SetGuidance("Downstream end of the envelope.");
+    fEarlyEndZMaxCmd->SetParameterName("z", false);
+    fEarlyEndZMaxCmd->SetDefaultUnit("cm");
+    fEarlyEndZMaxCmd->SetToBeBroadcasted(false);
+    fEarlyEndZMaxCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+    fFastSimDirectory = new G4UIdirectory("/eic/fastsim/");
+    fFastSimDirectory->SetGuidance("Parameterised e+/e-/gamma showers in the calorimeter regions.");
+
+    fFastSimEnableCmd = new G4UIcommand("/eic/fastsim/enable", this);
+    fFastSimEnableCmd->SetGuidance("Switch the shower parameterisation of a region (off by default).");
+    auto region = new G4UIparameter("region", 's', false);
+    region->SetParameterCandidates("BarrelCalo ForwardCalo");
+    fFastSimEnableCmd->SetParameter(region);
+    auto enable = new G4UIparameter("enable", 'b', true);
+    enable->SetDefaultValue(true);
+    fFastSimEnableCmd->SetParameter(enable);
+    fFastSimEnableCmd->SetToBeBroadcasted(false);
+    fFastSimEnableCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+    fFastSimEMinCmd = new G4UIcmdWithADoubleAndUnit("/eic/fastsim/eMin", this);
+    fFastSimEMinCmd->SetGuidance("Particles below this kinetic energy are tracked in full.");
+    fFastSimEMinCmd->SetParameterName("E", false);
+    fFastSimEMinCmd->SetRange("E>=0");
+    fFastSimEMinCmd->SetDefaultUnit("MeV");
+    fFastSimEMinCmd->SetToBeBroadcasted(false);
+    fFastSimEMinCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+    fFastSimSpotsCmd = new G4UIcmdWithAnInteger("/eic/fastsim/spotsPerGeV", this);
+    fFastSimSpotsCmd->SetGuidance("Energy spots per GeV of shower (at least 10 per shower).");
+    fFastSimSpotsCmd->SetParameterName("N", false);
+    fFastSimSpotsCmd->SetRange("N>=1");
+    fFastSimSpotsCmd->SetToBeBroadcasted(false);
+    fFastSimSpotsCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+    fProfileDirectory = new G4UIdirectory("/eic/profile/");
+    fProfileDirectory->SetGuidance("Steps, track length and time by logical volume and particle.");
+    fProfileDirectory->SetGuidance("Report and JSON file at end of run.");
+
+    fProfileEnableCmd = new G4UIcmdWithABool("/eic/profile/enable", this);
+    fProfileEnableCmd->SetGuidance("Profile the stepping (off by default).");
+    fProfileEnableCmd->SetParameterName("enable", true);
+    fProfileEnableCmd->SetDefaultValue(true);
+    fProfileEnableCmd->SetToBeBroadcasted(false);
+    fProfileEnableCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+    fProfileSamplingCmd = new G4UIcmdWithAnInteger("/eic/profile/sampling", this);
+    fProfileSamplingCmd->SetGuidance("Profile one event in N (global event number).");
+    fProfileSamplingCmd->SetParameterName("N", false);
+    fProfileSamplingCmd->SetRange("N>=1");
+    fProfileSamplingCmd->SetToBeBroadcasted(false);
+    fProfileSamplingCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+    fProfileFileCmd = new G4UIcmdWithAString("/eic/profile/file", this);
+    fProfileFileCmd->SetGuidance("JSON output of the profile (default step_profile.json).");
+    fProfileFileCmd->SetParameterName("file", false);
+    fProfileFileCmd->SetToBeBroadcasted(false);
+    fProfileFileCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+}
+
+RegionMessenger::~RegionMessenger()
+{
+    delete fCutCmd;
+    delete fMaxStepCmd;
+    delete fMinEkinCmd;
+    delete fRegionDirectory;
+    delete fKillCmd;
+    delete fKillBelowCmd;
+    delete fStackDirectory;
+    delete fEarlyEndModeCmd;
+    delete fEarlyEndRMaxCmd;
+    delete fEarlyEndZMinCmd;
+    delete fEarlyEndZMaxCmd;
+    delete fEarlyEndDirectory;
+    delete fFastSimEnableCmd;
+    delete fFastSimEMinCmd;
+    delete fFastSimSpotsCmd;
+    delete fFastSimDirectory;
+    delete fProfileEnableCmd;
+    delete fProfileSamplingCmd;
+    delete fProfileFileCmd;
+    delete fProfileDirectory;
+}
+
+G4UIcommand* RegionMessenger::NewRegionCommand(const char* path, const char* guidance, const char* unit)
+{
+    auto command = new G4UIcommand(path, this);
+    command->SetGuidance(guidance);
+    auto region = new G4UIparameter("region", 's', false);
+    region->SetParameterCandidates("Tracking BarrelCalo ForwardCalo Magnet");
+    command->SetParameter(region);
+    auto value = new G4UIparameter("value", 'd', false);
+    value->SetParameterRange("value>=0");
+    command->SetParameter(value);
+    auto unitParameter = new G4UIparameter("unit", 's', true);
+    unitParameter->SetDefaultValue(unit);
+    command->SetParameter(unitParameter);
+    command->SetToBeBroadcasted(false);
+    command->AvailableForStates(G4State_PreInit, G4State_Idle);
+    return command;
+}
+
+void RegionMessenger::SetNewValue(G4UIcommand* command, G4String newValue)
+{
+    auto& stacking = StackingAction::GetSettings();
+    auto& earlyEnd = SteppingAction::GetSettings();
+
+    if (command == fKillCmd) {
+        stacking.enabled = fKillCmd->GetNewBoolValue(newValue);
+        return;
+    }
+    if (command == fKillBelowCmd) {
+        stacking.killBelow = fKillBelowCmd->GetNewDoubleValue(newValue);
+        return;
+    }
+    if (command == fEarlyEndModeCmd) {
+        earlyEnd.mode = newValue == "abort"   ? SteppingAction::EarlyEnd::Abort
+                      : newValue == "measure" ? SteppingAction::EarlyEnd::Measure
+                                              : SteppingAction::EarlyEnd::Off;
+        return;
+    }
+    if (command == fEarlyEndRMaxCmd) {
+        earlyEnd.rMax = fEarlyEndRMaxCmd->GetNewDoubleValue(newValue);
+        return;
+    }
+    if (command == fEarlyEndZMinCmd) {
+        earlyEnd.zMin = fEarlyEndZMinCmd->GetNewDoubleValue(newValue);
+        return;
+    }
+    if (command == fEarlyEndZMaxCmd) {
+        earlyEnd.zMax = fEarlyEndZMaxCmd->GetNewDoubleValue(newValue);
+        return;
+    }
+
+    auto& profile = StepProfiler::GetSettings();
+    if (command == fProfileEnableCmd) {
+        profile.enabled = fProfileEnableCmd->GetNewBoolValue(newValue);
+        return;
+    }
+    if (command == fProfileSamplingCmd) {
+        profile.sampling = fProfileSamplingCmd->GetNewIntValue(newValue);
+        return;
+    }
+    if (command == fProfileFileCmd) {
+        profile.fileName = newValue;
+        return;
+    }
+
+    auto& fastSim = FastShowerModel::GetSettings();
+    if (command == fFastSimEnableCmd) {
+        std::istringstream is(newValue);
+        G4String name, flag;
+        is >> name >> flag;
+        DetectorRegions::Id id;
+        if (!DetectorRegions::FromName(name, id)) return;
+        fastSim.enabled[id] = G4UIcommand::ConvertToBool(flag);
+        G4cout << "[REGION] " << name << ": fast shower simulation "
+               << (fastSim.enabled[id] ? "on" : "off") << G4endl;
+        return;
+    }
+    if (command == fFastSimEMinCmd) {
+        fastSim.eMin = fFastSimEMinCmd->GetNewDoubleValue(newValue);
+        return;
+    }
+    if (command == fFastSimSpotsCmd) {
+        fastSim.spots = fFastSimSpotsCmd->GetNewIntValue(newValue);
+        return;
+    }
+
+    std::istringstream is(newValue);
+    G4String name, unit;
+    G4double value = 0.;
+    is >> name >> value >> unit;
+    DetectorRegions::Id id;
+    if (!DetectorRegions::FromName(name, id)) return;
+    value *= G4UIcommand::ValueOf(unit);
+
+    auto& limits = DetectorRegions::GetSettings().limits[id];
+    if (command == fCutCmd) {
+        limits.cut = value;
+    } else if (command == fMaxStepCmd) {
+        limits.maxStep = value;
+    } else if (command == fMinEkinCmd) {
+        limits.minEkin = value;
+    }
+    DetectorRegions::Apply();
+    // Cuts changed in Idle: physics tables rebuilt at the next run
+    if (command == fCutCmd) G4RunManager::GetRunManager()->PhysicsHasBeenModified();
+    G4cout << "[REGION] " << name << ": cut " << limits.cut / mm << " mm, maxStep "
+           << limits.maxStep / mm << " mm, minEkin " << limits.minEkin / MeV << " MeV" << G4endl;
+}
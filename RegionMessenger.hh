@@ -0,0 +1,52 @@
+#ifndef REGIONMESSENGER_HH
+#define REGIONMESSENGER_HH
+
+#include "G4UImessenger.hh"
+
+class G4UIdirectory;
+class G4UIcommand;
+class G4UIcmdWithABool;
+class G4UIcmdWithADoubleAndUnit;
+class G4UIcmdWithAString;
+class G4UIcmdWithAnInteger;
+
+// /eic/region/, /eic/stack/, /eic/earlyEnd/, /eic/fastsim/ and /eic/profile/
+// commands, applied on the master to DetectorRegions, StackingAction,
+// SteppingAction, FastShowerModel and StepProfiler settings
+class RegionMessenger : public G4UImessenger {
+public:
+    RegionMessenger();
+    virtual ~RegionMessenger();
+
+    virtual void SetNewValue(G4UIcommand* command, G4String newValue) override;
+
+private:
+    G4UIcommand* NewRegionCommand(const char* path, const char* guidance, const char* unit);
+
+    G4UIdirectory*             fRegionDirectory;
+    G4UIcommand*               fCutCmd;
+    G4UIcommand*               fMaxStepCmd;
+    G4UIcommand*               fMinEkinCmd;
+
+    G4UIdirectory*             fStackDirectory;
+    G4UIcmdWithABool*          fKillCmd;
+    G4UIcmdWithADoubleAndUnit* fKillBelowCmd;
+
+    G4UIdirectory*             fEarlyEndDirectory;
+    G4UIcmdWithAString*        fEarlyEndModeCmd;
+    G4UIcmdWithADoubleAndUnit* fEarlyEndRMaxCmd;
+    G4UIcmdWithADoubleAndUnit* fEarlyEndZMinCmd;
+    G4UIcmdWithADoubleAndUnit* fEarlyEndZMaxCmd;
+
+    G4UIdirectory*             fFastSimDirectory;
+    G4UIcommand*               fFastSimEnableCmd;
+    G4UIcmdWithADoubleAndUnit* fFastSimEMinCmd;
+    G4UIcmdWithAnInteger*      fFastSimSpotsCmd;
+
+    G4UIdirectory*             fProfileDirectory;
+    G4UIcmdWithABool*          fProfileEnableCmd;
+    G4UIcmdWithAnInteger*      fProfileSamplingCmd;
+    G4UIcmdWithAString*        fProfileFileCmd;
+};
+
+#endif
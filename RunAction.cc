@@ -1,20 +1,300 @@
 #include "RunAction.hh"
 #include "G4Run.hh"
+#include "G4AccumulableManager.hh"
+#include "G4MTRunManager.hh"
+#include "G4Threading.hh"
 #include "AnalysisManager.hh"
+#include "TrackOutput.hh"
+#include "AsyncWriter.hh"
+#include "GeneratorPool.hh"
+#include "PrimaryCache.hh"
+#include "AcceptanceFilter.hh"
+#include "Production.hh"
+#include "Luminosity.hh"
+#include "GeneratorConfig.hh"
+#include "FieldSetup.hh"
+#include "StackingAction.hh"
+#include "StepProfiler.hh"
+#include "Log.hh"
+#include "G4RunManager.hh"
 #include "G4ios.hh"
 
-RunAction::RunAction() : G4UserRunAction() {}
+#include <cmath>
+
+RunAction::Summary RunAction::fgLastRun;
+
+RunAction::RunAction()
+ : G4UserRunAction(),
+   fIOTime(0.),
+   fBytesWritten(0.),
+   fWorkerTime(0.),
+   fGenerationTime(0.),
+   fTrials(0),
+   fAccepted(0),
+   fDimuonEvents(0),
+   fSteps(0),
+   fKilled(0),
+   fDecided(0),
+   fDroppedTracks(0),
+   fRemainingTime(0.),
+   fFieldCalls(0)
+{
+    auto accumulableManager = G4AccumulableManager::Instance();
+    accumulableManager->RegisterAccumulable(fIOTime);
+    accumulableManager->RegisterAccumulable(fBytesWritten);
+    accumulableManager->RegisterAccumulable(fWorkerTime);
+    accumulableManager->RegisterAccumulable(fGenerationTime);
+    accumulableManager->RegisterAccumulable(fTrials);
+    accumulableManager->RegisterAccumulable(fAccepted);
+    accumulableManager->RegisterAccumulable(fDimuonEvents);
+    accumulableManager->RegisterAccumulable(fSteps);
+    accumulableManager->RegisterAccumulable(fKilled);
+    accumulableManager->RegisterAccumulable(fDecided);
+    accumulableManager->RegisterAccumulable(fDroppedTracks);
+    accumulableManager->RegisterAccumulable(fRemainingTime);
+    accumulableManager->RegisterAccumulable(fFieldCalls);
+}
 
 RunAction::~RunAction() {}
 
-void RunAction::BeginOfRunAction(const G4Run*)
+PrimaryGeneratorAction::Counters RunAction::GeneratorCounters() const
 {
-    G4cout << "### Run started ###" << G4endl;
+    auto generator = static_cast<const PrimaryGeneratorAction*>(
+        G4RunManager::GetRunManager()->GetUserPrimaryGeneratorAction());
+    return generator ? generator->GetCounters() : PrimaryGeneratorAction::Counters();
 }
 
-void RunAction::EndOfRunAction(const G4Run*)
+SteppingAction::Counters RunAction::SteppingCounters() const
 {
-    G4cout << "### Run ended: writing data ###" << G4endl;
-    AnalysisManager::GetInstance()->Write();
+    auto stepping = static_cast<const SteppingAction*>(
+        G4RunManager::GetRunManager()->GetUserSteppingAction());
+    return stepping ? stepping->GetCounters() : SteppingAction::Counters();
+}
+
+G4long RunAction::KilledTracks() const
+{
+    auto stacking = static_cast<const StackingAction*>(
+        G4RunManager::GetRunManager()->GetUserStackingAction());
+    return stacking ? stacking->GetKilled() : 0;
+}
+
+void RunAction::BeginOfRunAction(const G4Run* run)
+{
+    G4AccumulableManager::Instance()->Reset();
+
+    const auto& settings = TrackOutput::GetSettings();
+
+    if (IsMaster()) {
+        G4cout << "### Run started ###" << G4endl;
+        fTimer.Start();
+        if (settings.async) AsyncWriter::Instance().Start("tracks_output_writer.root", settings.queueSize);
+
+        // Primary cache first: replaying makes Pythia (and the pool) unnecessary
+        const auto& cache = PrimaryCache::GetSettings();
+        G4bool replay = false;
+        if (cache.mode == PrimaryCache::Mode::Record) {
+            PrimaryCache::Writer::Instance().Open(cache.fileName);
+        } else if (cache.mode == PrimaryCache::Mode::Replay) {
+            auto& reader = PrimaryCache::Reader::Instance();
+            replay = reader.Open(cache.fileName);
+            const G4int nRequested = run->GetNumberOfEventToBeProcessed();
+            if (replay && reader.NumberOfEvents() < static_cast<uint64_t>(nRequested)) {
+                G4cout << "[GEN] Warning: " << nRequested << " events requested, cache has "
+                       << reader.NumberOfEvents() << "; events will be reused" << G4endl;
+            }
+        }
+
+        // Weighted production: the events of this run stand for one week
+        // of beam on target. The scale is set at end of run, once the
+        // Pythia events behind the accepted ones are known
+        auto& lumi = Luminosity::GetSettings();
+        lumi.eventScale = 1.;
+        lumi.eventsPerWeek = 0;
+        if (lumi.sigma_mb > 0.) {
+            lumi.eventsPerWeek = Luminosity::ComputeEvents(lumi.sigma_mb, lumi.target);
+            if (lumi.eventsPerWeek > 0) {
+                G4cout << "[GEN] sigma = " << lumi.sigma_mb << " mb on " << lumi.target
+                       << ": " << lumi.eventsPerWeek << " events/week"
+                       << (GeneratorConfig::Instance().GetBias().enabled ? " (biased)" : "") << G4endl;
+            }
+        }
+
+        const auto& pool = GeneratorPool::GetSettings();
+        const G4bool gun = GeneratorConfig::Instance().GetProcess() == GeneratorConfig::Process::SingleMuon;
+        if (pool.threads > 0 && !replay && !gun) {
+            if (Production::IsSeeded()) {
+                // Pre-generated events are not tied to an event number
+                G4cout << "[GEN] Warning: per-event seeding, pre-generation threads not used" << G4endl;
+            } else {
+                GeneratorPool::Instance().Start(pool);
+            }
+        }
+        return;
+    }
+
+    fCountersAtStart = GeneratorCounters();
+    fSteppingAtStart = SteppingCounters();
+    fKilledAtStart = KilledTracks();
+
+    // Field settings changed since the last run take effect here
+    auto& field = FieldSetup::ThreadInstance();
+    field.Update();
+    fFieldCallsAtStart = field.GetCalls();
+    fTimer.Start();
+
+    // Each worker writes its own file (or feeds the writer thread), merged by
+    // the master at end of run
+    if (settings.async) {
+        TrackOutput::GetInstance()->OpenAsync();
+    } else {
+        TrackOutput::GetInstance()->Open(TrackOutput::WorkerFileName(G4Threading::G4GetThreadId()));
+    }
 }
 
+void RunAction::EndOfRunAction(const G4Run* run)
+{
+    if (!IsMaster()) {
+        auto output = TrackOutput::GetInstance();
+        output->Close();
+        fIOTime += output->GetIOTime();
+        fBytesWritten += output->GetBytesWritten();
+
+        fTimer.Stop();
+        fWorkerTime += fTimer.GetRealElapsed();
+        const auto counters = GeneratorCounters();
+        fGenerationTime += counters.generationTime - fCountersAtStart.generationTime;
+        fTrials += counters.trials - fCountersAtStart.trials;
+        fAccepted += counters.accepted - fCountersAtStart.accepted;
+        fDimuonEvents += output->GetDimuonEvents();
+        const auto stepping = SteppingCounters();
+        fSteps += stepping.steps - fSteppingAtStart.steps;
+        fDecided += stepping.decided - fSteppingAtStart.decided;
+        fDroppedTracks += stepping.droppedTracks - fSteppingAtStart.droppedTracks;
+        fRemainingTime += stepping.remainingTime - fSteppingAtStart.remainingTime;
+        fKilled += KilledTracks() - fKilledAtStart;
+        fFieldCalls += FieldSetup::ThreadInstance().GetCalls() - fFieldCallsAtStart;
+        StepProfiler::ThreadInstance().Flush();
+        AnalysisManager::ThreadInstance().Merge();
+        Log::EndOfThreadRun();
+        G4AccumulableManager::Instance()->Merge();
+        return;
+    }
+
+    G4AccumulableManager::Instance()->Merge();
+
+    // Every Pythia event generated stands for eventsPerWeek / trials of a
+    // week, the rejected ones included: RunInfo EventScale, output.root
+    // spectra. Shards keep both numbers so mergeShards can renormalise.
+    auto& lumi = Luminosity::GetSettings();
+    lumi.trials = fTrials.GetValue();
+    if (lumi.eventsPerWeek > 0 && fTrials.GetValue() > 0) {
+        lumi.eventScale = static_cast<G4double>(lumi.eventsPerWeek) / fTrials.GetValue();
+        G4cout << "[GEN] event scale " << lumi.eventScale << " = " << lumi.eventsPerWeek
+               << " events/week / " << fTrials.GetValue() << " Pythia events" << G4endl;
+    }
+    const auto writerStats = AsyncWriter::Instance().Stop();
+    const auto poolStats = GeneratorPool::Instance().Stop();
+    PrimaryCache::Writer::Instance().Close();
+    PrimaryCache::Reader::Instance().Close();
+    fTimer.Stop();
+
+    G4cout << "### Run ended: writing data ###" << G4endl;
+    G4Timer mergeTimer;
+    mergeTimer.Start();
+    const G4String outputName = Production::OutputFileName("tracks_output");
+    if (TrackOutput::Merge(TrackOutput::TakeWorkerFiles(), outputName)) {
+        Production::WriteRunInfo(outputName, run->GetNumberOfEvent());
+    }
+    AnalysisManager::Write();
+    mergeTimer.Stop();
+
+    const G4int nEvents = run->GetNumberOfEvent();
+    const G4double wall = fTimer.GetRealElapsed();
+    fgLastRun = {nEvents, wall, fWorkerTime.GetValue(), fSteps.GetValue(),
+                 fBytesWritten.GetValue() + writerStats.bytesWritten};
+    G4int nThreads = 1;
+    if (auto mt = G4MTRunManager::GetMasterRunManager()) nThreads = mt->GetNumberOfThreads();
+
+    G4cout << "[RUN] " << nEvents << " events, " << nThreads << " thread(s), "
+           << wall << " s -> "
+           << (wall > 0. ? nEvents / wall : 0.) << " events/s" << G4endl;
+    if (nEvents > 0) {
+        G4cout << "[RUN] " << G4double(fSteps.GetValue()) / nEvents << " steps/event, "
+               << fWorkerTime.GetValue() / nEvents << " s/event (worker time), "
+               << fKilled.GetValue() << " secondaries killed" << G4endl;
+    }
+    const auto fieldType = FieldSetup::GetSettings().type;
+    if (fieldType != FieldSetup::Type::None && nEvents > 0) {
+        const G4double worker = fWorkerTime.GetValue();
+        G4cout << "[FIELD] " << FieldSetup::TypeName(fieldType) << ": "
+               << G4double(fFieldCalls.GetValue()) / nEvents << " evaluations/event, "
+               << (worker > 0. ? fFieldCalls.GetValue() / worker : 0.) << " per worker-second" << G4endl;
+    }
+    // Early event end: in Measure mode, the worker time spent after the
+    // outcome was decided is what Abort mode saves
+    const auto earlyEnd = SteppingAction::GetSettings().mode;
+    if (earlyEnd == SteppingAction::EarlyEnd::Measure && nEvents > 0) {
+        const G4double worker = fWorkerTime.GetValue();
+        G4cout << "[RUN] early end (measure): " << fDecided.GetValue() << " events decided early ("
+               << 100. * fDecided.GetValue() / nEvents << "%), " << fRemainingTime.GetValue()
+               << " s of " << worker << " s worker time after the decision ("
+               << (worker > 0. ? 100. * fRemainingTime.GetValue() / worker : 0.) << "% saveable)" << G4endl;
+    } else if (earlyEnd == SteppingAction::EarlyEnd::Abort && nEvents > 0) {
+        G4cout << "[RUN] early end (abort): " << fDecided.GetValue() << " events cut short ("
+               << 100. * fDecided.GetValue() / nEvents << "%), " << fDroppedTracks.GetValue()
+               << " stacked tracks dropped" << G4endl;
+    }
+    StepProfiler::Report();
+    G4cout << "[IO] workers: " << fIOTime.GetValue() << " s, "
+           << fBytesWritten.GetValue() / 1.e6 << " MB written; merge: "
+           << mergeTimer.GetRealElapsed() << " s" << G4endl;
+    if (TrackOutput::GetSettings().async) {
+        G4cout << "[IO] writer thread: " << writerStats.events << " events in "
+               << writerStats.batches << " batches, " << writerStats.ioTime << " s, "
+               << writerStats.bytesWritten / 1.e6 << " MB written; queue depth mean "
+               << writerStats.meanDepth << " max " << writerStats.maxDepth
+               << "; worker stall " << writerStats.stallTime << " s" << G4endl;
+    }
+
+    // Generation vs tracking on the workers. With the pool, the worker-side
+    // generation time is only the wait for the ring.
+    const G4double generation = fGenerationTime.GetValue();
+    const G4double tracking = fWorkerTime.GetValue() - generation;
+    G4cout << "[GEN] workers: generation " << generation << " s, tracking " << tracking
+           << " s (" << (fWorkerTime.GetValue() > 0. ? 100. * generation / fWorkerTime.GetValue() : 0.)
+           << "% generation)" << G4endl;
+    if (poolStats.threads > 0) {
+        G4cout << "[GEN] pool: " << poolStats.threads << " thread(s), "
+               << poolStats.generated << " events generated (" << poolStats.discarded
+               << " unused), Pythia " << poolStats.generateTime << " s; ring full "
+               << poolStats.producerWait << " s, ring empty " << poolStats.consumerWait
+               << " s" << G4endl;
+    }
+
+    // Generator threads needed to keep every worker busy
+    const G4double perEventGen = poolStats.generated > 0
+        ? poolStats.generateTime / poolStats.generated
+        : (nEvents > 0 ? generation / nEvents : 0.);
+    const G4double perEventTrack = nEvents > 0 ? tracking / nEvents : 0.;
+    if (perEventTrack > 0.) {
+        G4cout << "[GEN] " << perEventGen * 1e3 << " ms/event generation, "
+               << perEventTrack * 1e3 << " ms/event tracking -> ~"
+               << std::ceil(nThreads * perEventGen / perEventTrack)
+               << " generator thread(s) for " << nThreads << " worker(s)" << G4endl;
+    }
+
+    // Acceptance filter: normalisation and yield per CPU-second (workers
+    // plus generator threads), to compare runs with the filter on and off
+    if (fTrials.GetValue() > fAccepted.GetValue() || AcceptanceFilter::GetSettings().enabled) {
+        G4cout << "[GEN] filter: " << fTrials.GetValue() << " Pythia events, "
+               << fAccepted.GetValue() << " accepted (efficiency "
+               << (fTrials.GetValue() > 0 ? G4double(fAccepted.GetValue()) / fTrials.GetValue() : 0.)
+               << ")" << G4endl;
+    }
+    const G4double cpu = fWorkerTime.GetValue() + poolStats.generateTime;
+    G4cout << "[GEN] " << fDimuonEvents.GetValue() << " dimuon events, "
+           << (cpu > 0. ? fDimuonEvents.GetValue() / cpu : 0.) << " per CPU-second" << G4endl;
+
+    // Workers, generator and writer threads have handed in their counts
+    Log::Summary();
+}
@@ -2,6 +2,10 @@
 #define RUNACTION_HH
 
 #include "G4UserRunAction.hh"
+#include "G4Timer.hh"
+#include "G4Accumulable.hh"
+#include "PrimaryGeneratorAction.hh"
+#include "SteppingAction.hh"
 
 class RunAction : public G4UserRunAction {
 public:
@@ -10,7 +14,51 @@ public:
 
     virtual void BeginOfRunAction(const G4Run*);
     virtual void EndOfRunAction(const G4Run*);
+
+    // Master side: totals of the last completed run (Benchmark)
+    struct Summary {
+        G4int    events = 0;
+        G4double wall = 0.;           // s, event loop (merge excluded)
+        G4double workerTime = 0.;     // s, summed over the workers
+        G4long   steps = 0;
+        G4double bytesWritten = 0.;   // workers and writer thread
+    };
+    static const Summary& GetLastRun() { return fgLastRun; }
+
+private:
+    // Worker side: counters of this thread's PrimaryGeneratorAction
+    PrimaryGeneratorAction::Counters GeneratorCounters() const;
+    // Worker side: stepping counters and killed secondaries of this thread so far
+    SteppingAction::Counters SteppingCounters() const;
+    G4long KilledTracks() const;
+
+    G4Timer fTimer;
+    PrimaryGeneratorAction::Counters fCountersAtStart;
+    SteppingAction::Counters fSteppingAtStart;
+    G4long fKilledAtStart = 0;
+    G4long fFieldCallsAtStart = 0;
+
+    // Summed over the workers at end of run
+    G4Accumulable<G4double> fIOTime;
+    G4Accumulable<G4double> fBytesWritten;
+    // Worker wall time in the event loop, and the part spent obtaining events
+    G4Accumulable<G4double> fWorkerTime;
+    G4Accumulable<G4double> fGenerationTime;
+    // Acceptance filter bookkeeping and its yield
+    G4Accumulable<G4long>   fTrials;
+    G4Accumulable<G4long>   fAccepted;
+    G4Accumulable<G4long>   fDimuonEvents;
+    // Tracking load: steps, and secondaries killed by the StackingAction
+    G4Accumulable<G4long>   fSteps;
+    G4Accumulable<G4long>   fKilled;
+    // Early event end: events decided, tracks dropped, time after the decision
+    G4Accumulable<G4long>   fDecided;
+    G4Accumulable<G4long>   fDroppedTracks;
+    G4Accumulable<G4double> fRemainingTime;
+    // Magnetic field evaluations
+    G4Accumulable<G4long>   fFieldCalls;
+
+    static Summary fgLastRun;
 };
 
 #endif
-
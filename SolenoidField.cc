@@ -0,0 +1,39 @@
+#include "SolenoidField.hh"
+
+#include "G4SystemOfUnits.hh"
+
+#include <cmath>
+
+SolenoidField::SolenoidField(std::shared_ptr<const FieldGrid> grid, const G4ThreeVector& origin)
+ : fGrid(std::move(grid)),
+   fOrigin(origin)
+{}
+
+SolenoidField::SolenoidField(G4double bz, G4double rBore, G4double halfLength, const G4ThreeVector& origin)
+ : fOrigin(origin),
+   fBz(bz),
+   fRBore2(rBore * rBore),
+   fHalfLength(halfLength)
+{}
+
+void SolenoidField::GetFieldValue(const G4double point[4], G4double* bField) const
+{
+    ++fCalls;
+    bField[0] = bField[1] = bField[2] = 0.;
+
+    const G4double x = point[0] - fOrigin.x();
+    const G4double y = point[1] - fOrigin.y();
+    const G4double z = point[2] - fOrigin.z();
+
+    if (fGrid) {
+        G4double b[3];
+        if (fGrid->Evaluate(x / mm, y / mm, z / mm, b)) {
+            bField[0] = b[0] * tesla;
+            bField[1] = b[1] * tesla;
+            bField[2] = b[2] * tesla;
+        }
+        return;
+    }
+
+    if (x * x + y * y < fRBore2 && std::abs(z) < fHalfLength) bField[2] = fBz;
+}
@@ -0,0 +1,36 @@
+#ifndef SOLENOIDFIELD_HH
+#define SOLENOIDFIELD_HH
+
+#include "G4MagneticField.hh"
+#include "G4ThreeVector.hh"
+#include "FieldGrid.hh"
+
+#include <memory>
+
+// Solenoid field of one thread: a shared FieldGrid (map in mm / tesla,
+// placed at `origin`) or, without a map, a uniform Bz inside the coil bore.
+// Zero elsewhere. Keeps its own evaluation count.
+class SolenoidField : public G4MagneticField {
+public:
+    // Field map
+    SolenoidField(std::shared_ptr<const FieldGrid> grid, const G4ThreeVector& origin);
+    // Uniform fallback: Bz for r < rBore, |z - origin.z| < halfLength
+    SolenoidField(G4double bz, G4double rBore, G4double halfLength, const G4ThreeVector& origin);
+    virtual ~SolenoidField() = default;
+
+    virtual void GetFieldValue(const G4double point[4], G4double* bField) const override;
+
+    // Calls since construction
+    G4long GetCalls() const { return fCalls; }
+
+private:
+    std::shared_ptr<const FieldGrid> fGrid;
+    G4ThreeVector fOrigin;
+    G4double fBz = 0.;
+    G4double fRBore2 = 0.;
+    G4double fHalfLength = 0.;
+
+    mutable G4long fCalls = 0;
+};
+
+#endif
@@ -0,0 +1,27 @@
+#include "StackingAction.hh"
+#include "DetectorRegions.hh"
+
+#include "G4Track.hh"
+#include "G4ParticleDefinition.hh"
+#include "G4LogicalVolume.hh"
+#include "G4VPhysicalVolume.hh"
+
+#include <cstdlib>
+
+StackingAction::Settings StackingAction::fgSettings;
+
+G4ClassificationOfNewTrack StackingAction::ClassifyNewTrack(const G4Track* track)
+{
+    const auto& settings = fgSettings;
+    if (!settings.enabled || track->GetParentID() == 0) return fUrgent;
+    if (std::abs(track->GetDefinition()->GetPDGEncoding()) == 13) return fUrgent;
+    if (track->GetKineticEnergy() >= settings.killBelow) return fUrgent;
+
+    // Secondaries carry the touchable of their creation point
+    if (!fTracking) fTracking = DetectorRegions::GetRegion(DetectorRegions::Tracking);
+    const auto volume = track->GetVolume();
+    if (volume && volume->GetLogicalVolume()->GetRegion() == fTracking) return fUrgent;
+
+    ++fKilled;
+    return fKill;
+}
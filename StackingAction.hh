@@ -0,0 +1,37 @@
+#ifndef STACKINGACTION_HH
+#define STACKINGACTION_HH
+
+#include "G4UserStackingAction.hh"
+#include "G4SystemOfUnits.hh"
+#include "globals.hh"
+
+class G4Region;
+
+// Optional track killing: non-muon secondaries below a kinetic energy
+// threshold are dropped unless they start in the tracking region, so
+// that showers in the passive material are not developed.
+class StackingAction : public G4UserStackingAction {
+public:
+    // Process-wide settings, set on the master (RegionMessenger)
+    struct Settings {
+        G4bool   enabled   = false;
+        G4double killBelow = 10. * MeV;
+    };
+    static Settings& GetSettings() { return fgSettings; }
+
+    StackingAction() = default;
+    virtual ~StackingAction() = default;
+
+    virtual G4ClassificationOfNewTrack ClassifyNewTrack(const G4Track* track) override;
+
+    // Cumulative over the runs of this thread
+    G4long GetKilled() const { return fKilled; }
+
+private:
+    static Settings fgSettings;
+
+    G4Region* fTracking = nullptr;
+    G4long fKilled = 0;
+};
+
+#endif
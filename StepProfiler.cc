@@ -0,0 +1,162 @@
+#include "StepProfiler.hh"
+
+#include "G4Step.hh"
+#include "G4Track.hh"
+#include "G4LogicalVolume.hh"
+#include "G4VPhysicalVolume.hh"
+#include "G4ParticleDefinition.hh"
+#include "G4ios.hh"
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+
+StepProfiler::Settings StepProfiler::fgSettings;
+std::mutex StepProfiler::fgMutex;
+G4long StepProfiler::fgEvents = 0;
+std::map<std::string, StepProfiler::Entry> StepProfiler::fgVolumes;
+std::map<std::string, StepProfiler::Entry> StepProfiler::fgParticles;
+
+namespace {
+    using Row = std::pair<std::string, StepProfiler::Entry>;
+
+    // Most expensive first
+    std::vector<Row> SortByTime(const std::map<std::string, StepProfiler::Entry>& table) {
+        std::vector<Row> rows(table.begin(), table.end());
+        std::sort(rows.begin(), rows.end(),
+                  [](const Row& a, const Row& b) { return a.second.time > b.second.time; });
+        return rows;
+    }
+
+    void Add(StepProfiler::Entry& to, const StepProfiler::Entry& from) {
+        to.steps += from.steps;
+        to.length += from.length;
+        to.time += from.time;
+    }
+
+    void PrintTable(const char* title, const std::vector<Row>& rows, G4double total,
+                    G4long events, std::size_t maxRows) {
+        G4cout << "[PROFILE] " << std::left << std::setw(20) << title << std::right
+               << std::setw(8) << "time %" << std::setw(14) << "steps/event"
+               << std::setw(14) << "cm/event" << std::setw(10) << "us/step" << G4endl;
+        for (std::size_t i = 0; i < rows.size() && i < maxRows; ++i) {
+            const auto& e = rows[i].second;
+            G4cout << "[PROFILE] " << std::left << std::setw(20) << rows[i].first << std::right
+                   << std::fixed << std::setprecision(1)
+                   << std::setw(8) << (total > 0. ? 100. * e.time / total : 0.)
+                   << std::setw(14) << G4double(e.steps) / events
+                   << std::setw(14) << e.length / 10. / events
+                   << std::setprecision(3)
+                   << std::setw(10) << (e.steps > 0 ? 1e6 * e.time / e.steps : 0.)
+                   << std::defaultfloat << std::setprecision(6) << G4endl;
+        }
+    }
+
+    void WriteRows(std::ofstream& out, const char* key, const std::vector<Row>& rows) {
+        out << "  \"" << key << "\": [";
+        for (std::size_t i = 0; i < rows.size(); ++i) {
+            const auto& e = rows[i].second;
+            out << (i ? ",\n" : "\n") << "    {\"name\": \"" << rows[i].first
+                << "\", \"steps\": " << e.steps << ", \"length_mm\": " << e.length
+                << ", \"time_s\": " << e.time << "}";
+        }
+        out << "\n  ]";
+    }
+}
+
+StepProfiler& StepProfiler::ThreadInstance() {
+    static G4ThreadLocal StepProfiler* instance = nullptr;
+    if (!instance) instance = new StepProfiler();
+    return *instance;
+}
+
+void StepProfiler::BeginOfEvent(G4int globalEventID) {
+    const auto& s = fgSettings;
+    fActive = s.enabled && globalEventID % std::max(s.sampling, 1) == 0;
+    if (!fActive) return;
+    ++fEvents;
+    fLast = std::chrono::steady_clock::now();
+}
+
+void StepProfiler::Record(const G4Step* step) {
+    const auto now = std::chrono::steady_clock::now();
+    const G4double time = std::chrono::duration<G4double>(now - fLast).count();
+    fLast = now;
+    const G4double length = step->GetStepLength();
+
+    const auto* lv = step->GetPreStepPoint()->GetPhysicalVolume()->GetLogicalVolume();
+    const auto id = static_cast<std::size_t>(lv->GetInstanceID());
+    if (id >= fVolumes.size()) {
+        fVolumes.resize(id + 1);
+        fVolumeLV.resize(id + 1, nullptr);
+    }
+    fVolumeLV[id] = lv;
+    auto& volume = fVolumes[id];
+    ++volume.steps;
+    volume.length += length;
+    volume.time += time;
+
+    // A handful of species per event, mostly the same one step after step
+    const auto* particle = step->GetTrack()->GetParticleDefinition();
+    if (fLastParticle >= fParticles.size() || fParticles[fLastParticle].first != particle) {
+        fLastParticle = 0;
+        while (fLastParticle < fParticles.size() && fParticles[fLastParticle].first != particle) {
+            ++fLastParticle;
+        }
+        if (fLastParticle == fParticles.size()) fParticles.push_back({particle, Entry()});
+    }
+    auto& species = fParticles[fLastParticle].second;
+    ++species.steps;
+    species.length += length;
+    species.time += time;
+}
+
+void StepProfiler::Flush() {
+    fActive = false;
+    if (fEvents == 0) return;
+    {
+        std::lock_guard<std::mutex> lock(fgMutex);
+        fgEvents += fEvents;
+        for (std::size_t i = 0; i < fVolumes.size(); ++i) {
+            if (fVolumes[i].steps > 0) Add(fgVolumes[fVolumeLV[i]->GetName()], fVolumes[i]);
+        }
+        for (const auto& p : fParticles) Add(fgParticles[p.first->GetParticleName()], p.second);
+    }
+    fEvents = 0;
+    fVolumes.clear();
+    fVolumeLV.clear();
+    fParticles.clear();
+    fLastParticle = 0;
+}
+
+void StepProfiler::Report() {
+    std::lock_guard<std::mutex> lock(fgMutex);
+    if (fgEvents == 0) return;
+
+    const auto volumes = SortByTime(fgVolumes);
+    const auto particles = SortByTime(fgParticles);
+    Entry total;
+    for (const auto& v : volumes) Add(total, v.second);
+
+    G4cout << "[PROFILE] " << fgEvents << " events profiled (1 in " << fgSettings.sampling
+           << "), " << total.steps << " steps, " << total.time << " s" << G4endl;
+    PrintTable("volume", volumes, total.time, fgEvents, 15);
+    PrintTable("particle", particles, total.time, fgEvents, 10);
+
+    std::ofstream out(fgSettings.fileName);
+    if (!out) {
+        G4cerr << "Error: Could not write " << fgSettings.fileName << G4endl;
+    } else {
+        out << "{\n  \"events\": " << fgEvents << ",\n  \"sampling\": " << fgSettings.sampling
+            << ",\n  \"steps\": " << total.steps << ",\n  \"time_s\": " << total.time << ",\n";
+        WriteRows(out, "volumes", volumes);
+        out << ",\n";
+        WriteRows(out, "particles", particles);
+        out << "\n}\n";
+        G4cout << "[PROFILE] written to " << fgSettings.fileName << G4endl;
+    }
+
+    fgEvents = 0;
+    fgVolumes.clear();
+    fgParticles.clear();
+}
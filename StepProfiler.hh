@@ -0,0 +1,76 @@
+#ifndef STEPPROFILER_HH
+#define STEPPROFILER_HH
+
+#include "globals.hh"
+
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+class G4Step;
+class G4LogicalVolume;
+class G4ParticleDefinition;
+
+// Where the tracking time goes: steps, track length and wall time by
+// logical volume and by particle species.
+//
+// One event in `sampling` is profiled. Each worker fills its own tables,
+// with no locks in the stepping loop: volumes by G4LogicalVolume instance
+// ID, particles in a short list with the last hit cached. The tables are
+// added to the run totals once per run (Flush, worker end of run); the
+// master prints them sorted by time and writes them as JSON (Report).
+//
+// The time of a step is the wall time since the previous step of the
+// thread, so it includes the user actions, the SD and the stacking of its
+// secondaries. It goes to the volume the step started in.
+class StepProfiler {
+public:
+    // Process-wide settings, set on the master (RegionMessenger)
+    struct Settings {
+        G4bool   enabled  = false;
+        G4int    sampling = 1;                    // profile 1 event in N
+        G4String fileName = "step_profile.json";
+    };
+    static Settings& GetSettings() { return fgSettings; }
+
+    struct Entry {
+        G4long   steps = 0;
+        G4double length = 0.;   // mm
+        G4double time = 0.;     // s
+    };
+
+    // Profiler of the calling thread
+    static StepProfiler& ThreadInstance();
+
+    // Worker side, from the SteppingAction
+    void BeginOfEvent(G4int globalEventID);
+    void Step(const G4Step* step) { if (fActive) Record(step); }
+    // Worker end of run: tables of this thread added to the run totals
+    void Flush();
+
+    // Master end of run: sorted report and JSON file, then a fresh start
+    static void Report();
+
+private:
+    StepProfiler() = default;
+    void Record(const G4Step* step);
+
+    G4bool fActive = false;
+    G4long fEvents = 0;
+    std::chrono::steady_clock::time_point fLast;
+    std::vector<Entry> fVolumes;                      // by G4LogicalVolume instance ID
+    std::vector<const G4LogicalVolume*> fVolumeLV;
+    std::vector<std::pair<const G4ParticleDefinition*, Entry>> fParticles;
+    std::size_t fLastParticle = 0;
+
+    static Settings fgSettings;
+    static std::mutex fgMutex;
+    static G4long fgEvents;
+    static std::map<std::string, Entry> fgVolumes;
+    static std::map<std::string, Entry> fgParticles;
+};
+
+#endif
@@ -0,0 +1,75 @@
+#include "SteppingAction.hh"
+
+#include "G4Step.hh"
+#include "G4Track.hh"
+#include "G4Event.hh"
+#include "G4EventManager.hh"
+#include "G4StackManager.hh"
+#include "G4PrimaryVertex.hh"
+#include "G4PrimaryParticle.hh"
+#include "Production.hh"
+
+#include <cstdlib>
+
+SteppingAction::Settings SteppingAction::fgSettings;
+
+void SteppingAction::BeginOfEvent(const G4Event* event)
+{
+    fProfiler.BeginOfEvent(Production::GlobalEventID(event->GetEventID()));
+
+    fMode = fgSettings.mode;
+    fDecided = false;
+    fMuonsLeft = 0;
+    fMuonDone.clear();
+    if (fMode == EarlyEnd::Off) return;
+
+    // Primaries get track IDs 1..n in vertex / particle order
+    fMuonDone.push_back(1);   // no track 0
+    for (G4int v = 0; v < event->GetNumberOfPrimaryVertex(); ++v) {
+        for (auto p = event->GetPrimaryVertex(v)->GetPrimary(); p; p = p->GetNext()) {
+            const G4bool muon = std::abs(p->GetPDGcode()) == 13;
+            fMuonDone.push_back(muon ? 0 : 1);
+            if (muon) ++fMuonsLeft;
+        }
+    }
+}
+
+void SteppingAction::EndOfEvent()
+{
+    if (fDecided && fMode == EarlyEnd::Measure) {
+        fCounters.remainingTime +=
+            std::chrono::duration<G4double>(std::chrono::steady_clock::now() - fDecisionTime).count();
+    }
+}
+
+void SteppingAction::UserSteppingAction(const G4Step* step)
+{
+    ++fCounters.steps;
+    fProfiler.Step(step);
+    if (fMuonsLeft == 0) return;
+
+    const auto track = step->GetTrack();
+    if (track->GetParentID() != 0) return;
+    const auto id = track->GetTrackID();
+    if (id >= static_cast<G4int>(fMuonDone.size()) || fMuonDone[id]) return;
+
+    const auto& pos = step->GetPostStepPoint()->GetPosition();
+    const auto& s = fgSettings;
+    const G4bool outside = pos.perp2() > s.rMax * s.rMax || pos.z() > s.zMax || pos.z() < s.zMin;
+    if (!outside && track->GetTrackStatus() == fAlive) return;
+
+    fMuonDone[id] = 1;
+    if (--fMuonsLeft > 0) return;
+
+    // Every primary muon is done: nothing else can reach the SD
+    fDecided = true;
+    ++fCounters.decided;
+    if (fMode == EarlyEnd::Measure) {
+        fDecisionTime = std::chrono::steady_clock::now();
+        return;
+    }
+    auto stack = G4EventManager::GetEventManager()->GetStackManager();
+    fCounters.droppedTracks += stack->GetNTotalTrack();
+    stack->clear();
+    track->SetTrackStatus(fKillTrackAndSecondaries);
+}
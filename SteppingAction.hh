@@ -0,0 +1,71 @@
+#ifndef STEPPINGACTION_HH
+#define STEPPINGACTION_HH
+
+#include "G4UserSteppingAction.hh"
+#include "G4SystemOfUnits.hh"
+#include "globals.hh"
+#include "StepProfiler.hh"
+
+#include <chrono>
+#include <vector>
+
+class G4Event;
+
+// Step counter and early event end.
+//
+// Only the primary muons can still produce SD hits once they are out of
+// the instrumented envelope (the cylinder around every sensitive volume).
+// When every primary muon has left it, stopped or decayed, the event is
+// decided: in Abort mode the current track, its secondaries and the
+// stacks are dropped and the event ends normally (SD EndOfEvent, output);
+// in Measure mode nothing is dropped and the time still spent on the
+// event is recorded, i.e. what Abort would save.
+// Energy deposited by the dropped shower particles in the barrel EMCal
+// (EdepTotal) is lost in Abort mode.
+// Also feeds the StepProfiler of its thread when profiling is on.
+class SteppingAction : public G4UserSteppingAction {
+public:
+    enum class EarlyEnd { Off, Measure, Abort };
+
+    // Process-wide settings, set on the master (RegionMessenger).
+    // Envelope around the SD volumes, from the target upstream of the FVTX
+    // to the end of the barrel EMCal, out to its outer surface.
+    struct Settings {
+        EarlyEnd mode = EarlyEnd::Off;
+        G4double rMax = 133. * cm;
+        G4double zMin = -341. * cm;
+        G4double zMax = 200. * cm;
+    };
+    static Settings& GetSettings() { return fgSettings; }
+
+    // Cumulative over the runs of this thread
+    struct Counters {
+        G4long   steps = 0;
+        G4long   decided = 0;        // events decided before their end
+        G4long   droppedTracks = 0;  // stacked tracks dropped (Abort)
+        G4double remainingTime = 0.; // s from decision to end of event (Measure)
+    };
+    const Counters& GetCounters() const { return fCounters; }
+
+    SteppingAction() = default;
+    virtual ~SteppingAction() = default;
+
+    virtual void UserSteppingAction(const G4Step* step) override;
+
+    // From the EventAction
+    void BeginOfEvent(const G4Event* event);
+    void EndOfEvent();
+
+private:
+    static Settings fgSettings;
+
+    Counters fCounters;
+    StepProfiler& fProfiler = StepProfiler::ThreadInstance();
+    EarlyEnd fMode = EarlyEnd::Off;            // fixed for the event
+    std::vector<char> fMuonDone;                // by primary track ID
+    G4int fMuonsLeft = 0;
+    G4bool fDecided = false;
+    std::chrono::steady_clock::time_point fDecisionTime;
+};
+
+#endif
@@ -0,0 +1,512 @@
+#include "TrackFinder.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+
+namespace {
+    const double kTwoPi = 2. * M_PI;
+
+    uint32_t Clamp(double index, uint32_t n) {
+        if (index <= 0.) return 0;
+        const auto i = static_cast<uint32_t>(index);
+        return i < n ? i : n - 1;
+    }
+}
+
+TrackFinder::Settings& TrackFinder::GetSettings() {
+    static Settings settings;
+    return settings;
+}
+
+std::vector<TrackFinder::Layer> TrackFinder::DiskLayers(const GeometryDescription& description,
+                                                        std::vector<const GeometryDescription::Volume*>& volumes) {
+    volumes.clear();
+    for (const auto& v : description.volumes) {
+        if ((v.subsystem == "FVTX" || v.subsystem == "InnerTracker")
+            && v.shape == GeometryDescription::Shape::Tube) {
+            volumes.push_back(&v);
+        }
+    }
+    std::vector<Layer> layers;
+    for (const auto* v : volumes) {
+        double position[3];
+        description.WorldPosition(*v, position);
+        Layer layer;
+        layer.z = position[2];
+        layer.rMin = v->dims[0];
+        layer.rMax = v->dims[1];
+        if (v->readout != GeometryDescription::Readout::None) {
+            layer.sigma = std::max(v->pitch[0], v->pitch[1]) / std::sqrt(12.);
+        }
+        layers.push_back(layer);
+    }
+    // By z, volumes alongside
+    std::vector<std::size_t> order(layers.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b) { return layers[a].z < layers[b].z; });
+    std::vector<Layer> sortedLayers;
+    std::vector<const GeometryDescription::Volume*> sortedVolumes;
+    for (auto i : order) {
+        sortedLayers.push_back(layers[i]);
+        sortedVolumes.push_back(volumes[i]);
+    }
+    volumes = std::move(sortedVolumes);
+    return sortedLayers;
+}
+
+TrackFinder::TrackFinder(const std::vector<Layer>& layers, double cell) {
+    std::vector<int> byZ(layers.size());
+    std::iota(byZ.begin(), byZ.end(), 0);
+    std::stable_sort(byZ.begin(), byZ.end(), [&](int a, int b) { return layers[a].z < layers[b].z; });
+
+    fOrder.resize(layers.size());
+    uint32_t base = 0;
+    for (std::size_t i = 0; i < byZ.size(); ++i) {
+        const Layer& layer = layers[byZ[i]];
+        fOrder[byZ[i]] = int(i);
+        Grid g;
+        g.z = layer.z;
+        g.rMin = layer.rMin;
+        g.rMax = layer.rMax;
+        g.sigma = layer.sigma;
+        g.weight = 1. / (layer.sigma * layer.sigma);
+        g.nR = std::max<uint32_t>(1, uint32_t(std::ceil((layer.rMax - layer.rMin) / cell)));
+        g.nPhi = std::max<uint32_t>(1, uint32_t(std::ceil(kTwoPi * layer.rMax / cell)));
+        g.cellsPerCm = layer.rMax > layer.rMin ? g.nR / (layer.rMax - layer.rMin) : 0.;
+        g.cellsPerRad = g.nPhi / kTwoPi;
+        g.base = base;
+        base += g.nR * g.nPhi;
+        fGrids.push_back(g);
+    }
+    fCellStart.assign(base, 0);
+    fCellCount.assign(base, 0);
+}
+
+void TrackFinder::Clear() {
+    for (auto cell : fOccupied) fCellCount[cell] = 0;
+    fOccupied.clear();
+    fX.clear();
+    fY.clear();
+    fZ.clear();
+    fId.clear();
+    fLayer.clear();
+    fCell.clear();
+}
+
+void TrackFinder::AddHit(int layer, double x, double y, double z, int32_t id) {
+    fX.push_back(x);
+    fY.push_back(y);
+    fZ.push_back(z);
+    fId.push_back(id);
+    fLayer.push_back(uint16_t(fOrder[layer]));
+}
+
+void TrackFinder::BuildGrids() {
+    // Cell of each hit; scanning, the first cell of its layer
+    fCell.resize(fX.size());
+    for (uint32_t h = 0; h < fX.size(); ++h) {
+        const Grid& g = fGrids[fLayer[h]];
+        if (fScan) {
+            fCell[h] = g.base;
+            continue;
+        }
+        const double r = std::sqrt(fX[h] * fX[h] + fY[h] * fY[h]);
+        const double phi = std::atan2(fY[h], fX[h]) + M_PI;   // [0, 2 pi]
+        fCell[h] = g.base + Clamp((r - g.rMin) * g.cellsPerCm, g.nR) * g.nPhi + Clamp(phi * g.cellsPerRad, g.nPhi);
+    }
+
+    // Counting sort over the occupied cells; fScratch: rank of a hit in its cell
+    for (auto cell : fOccupied) fCellCount[cell] = 0;
+    fOccupied.clear();
+    fScratch.resize(fCell.size());
+    for (uint32_t h = 0; h < fCell.size(); ++h) {
+        if (fCellCount[fCell[h]] == 0) fOccupied.push_back(fCell[h]);
+        fScratch[h] = fCellCount[fCell[h]]++;
+    }
+    std::sort(fOccupied.begin(), fOccupied.end());
+    uint32_t start = 0;
+    for (auto cell : fOccupied) {
+        fCellStart[cell] = start;
+        start += fCellCount[cell];
+    }
+    fSorted.resize(fCell.size());
+    for (uint32_t h = 0; h < fCell.size(); ++h) fSorted[fCellStart[fCell[h]] + fScratch[h]] = h;
+
+    // Grids in global cell order: the hits of a layer are contiguous
+    fLayerStart.assign(fGrids.size() + 1, 0);
+    for (auto l : fLayer) ++fLayerStart[l + 1];
+    for (std::size_t l = 1; l < fLayerStart.size(); ++l) fLayerStart[l] += fLayerStart[l - 1];
+}
+
+void TrackFinder::Line::Add(double w, double z, double u, double x, double y) {
+    sw  += w;
+    sz  += w * z;
+    szz += w * z * z;
+    su  += w * u;
+    szu += w * z * u;
+    suu += w * u * u;
+    sx  += w * x;
+    sxz += w * x * z;
+    sxu += w * x * u;
+    sxx += w * x * x;
+    sy  += w * y;
+    syz += w * y * z;
+    syu += w * y * u;
+    syy += w * y * y;
+}
+
+TrackFinder::Line::Solution TrackFinder::Line::Solve() const {
+    // Normal matrix [sw sz su; sz szz szu; su szu suu], inverse by cofactors.
+    // Written out again in Fit(), where it must inline into the simd loop
+    Solution s;
+    const double c00 = szz * suu - szu * szu;
+    const double c01 = su * szu - sz * suu;
+    const double c02 = sz * szu - szz * su;
+    const double invDet = 1. / (sw * c00 + sz * c01 + su * c02);
+    s.i00 = c00 * invDet;
+    s.i01 = c01 * invDet;
+    s.i02 = c02 * invDet;
+    s.i11 = (sw * suu - su * su) * invDet;
+    s.i12 = (su * sz - sw * szu) * invDet;
+    s.i22 = (sw * szz - sz * sz) * invDet;
+    s.ax = s.i00 * sx + s.i01 * sxz + s.i02 * sxu;
+    s.bx = s.i01 * sx + s.i11 * sxz + s.i12 * sxu;
+    s.cx = s.i02 * sx + s.i12 * sxz + s.i22 * sxu;
+    s.ay = s.i00 * sy + s.i01 * syz + s.i02 * syu;
+    s.by = s.i01 * sy + s.i11 * syz + s.i12 * syu;
+    s.cy = s.i02 * sy + s.i12 * syz + s.i22 * syu;
+    return s;
+}
+
+void TrackFinder::Line::At(double z, double u, double& x, double& y, double& variance) const {
+    if (su == 0.) {
+        // No point past fieldZ (or no field): the straight line, c only
+        // from its prior
+        const double invDet = 1. / (sw * szz - sz * sz);
+        const double bx = (sw * sxz - sz * sx) * invDet;
+        const double by = (sw * syz - sz * sy) * invDet;
+        x = (sx - bx * sz) / sw + bx * z;
+        y = (sy - by * sz) / sw + by * z;
+        variance = (szz - 2. * z * sz + z * z * sw) * invDet + u * u / suu;
+        return;
+    }
+    const Solution s = Solve();
+    x = s.ax + s.bx * z + s.cx * u;
+    y = s.ay + s.by * z + s.cy * u;
+    variance = s.i00 + z * z * s.i11 + u * u * s.i22 + 2. * (z * s.i01 + u * s.i02 + z * u * s.i12);
+}
+
+double TrackFinder::Line::Chi2(std::size_t n) const {
+    // As in Fit(): minimum of the sum of squares, sxx - parameters . right-hand
+    // side; 2n measurements and the prior on cx, cy for 6 parameters
+    const Solution s = Solve();
+    const double chi2 = sxx - (s.ax * sx + s.bx * sxz + s.cx * sxu) + syy - (s.ay * sy + s.by * syz + s.cy * syu);
+    return std::max(0., chi2) / (2. * double(n) - 4.);
+}
+
+template <class F>
+void TrackFinder::ForEach(int l, double x, double y, double w, F&& f) const {
+    const Grid& g = fGrids[l];
+    const double r = std::sqrt(x * x + y * y);
+    if (r + w < g.rMin || r - w > g.rMax) return;
+    const double w2 = w * w;
+    auto visit = [&](uint32_t begin, uint32_t end) {
+        for (uint32_t k = begin; k < end; ++k) {
+            const uint32_t h = fSorted[k];
+            const double dx = fX[h] - x, dy = fY[h] - y;
+            const double d2 = dx * dx + dy * dy;
+            if (d2 <= w2) f(h, d2);
+        }
+    };
+    if (fScan) {
+        visit(fLayerStart[l], fLayerStart[l + 1]);
+        return;
+    }
+
+    const uint32_t r0 = Clamp((r - w - g.rMin) * g.cellsPerCm, g.nR);
+    const uint32_t r1 = Clamp((r + w - g.rMin) * g.cellsPerCm, g.nR);
+    // Phi cells of the circle of radius w; all of them around the axis
+    int64_t p0 = 0, p1 = int64_t(g.nPhi) - 1;
+    if (r > w) {
+        const double phi = std::atan2(y, x) + M_PI;
+        const double dphi = std::asin(w / r);
+        const auto lo = int64_t(std::floor((phi - dphi) * g.cellsPerRad));
+        const auto hi = int64_t(std::floor((phi + dphi) * g.cellsPerRad));
+        if (hi - lo + 1 < int64_t(g.nPhi)) {
+            p0 = lo;
+            p1 = hi;
+        }
+    }
+    // Wide window on a sparse layer: the hits of the layer are fewer than the cells
+    if (int64_t(r1 - r0 + 1) * (p1 - p0 + 1) > int64_t(fLayerStart[l + 1] - fLayerStart[l])) {
+        visit(fLayerStart[l], fLayerStart[l + 1]);
+        return;
+    }
+
+    const auto nPhi = int64_t(g.nPhi);
+    for (uint32_t ir = r0; ir <= r1; ++ir) {
+        for (int64_t p = p0; p <= p1; ++p) {
+            const uint32_t cell = g.base + ir * g.nPhi + uint32_t((p % nPhi + nPhi) % nPhi);
+            if (const uint32_t count = fCellCount[cell]) visit(fCellStart[cell], fCellStart[cell] + count);
+        }
+    }
+}
+
+int64_t TrackFinder::Nearest(const Config& config, int l, const Line& line) const {
+    const Grid& g = fGrids[l];
+    const double z = g.z - config.vertexZ;
+    double x, y, variance;
+    line.At(z, Bend(z), x, y, variance);
+    const double w = std::max(config.window, 3. * std::sqrt(variance + g.sigma * g.sigma));
+    const double r = std::sqrt(x * x + y * y);
+    if (r < g.rMin || r > g.rMax) return -2;
+
+    int64_t best = -1;
+    double bestD2 = 0.;
+    ForEach(l, x, y, w, [&](uint32_t h, double d2) {
+        if (fClaimed[h]) return;
+        if (best < 0 || d2 < bestD2) {
+            best = h;
+            bestD2 = d2;
+        }
+    });
+    return best;
+}
+
+void TrackFinder::AddToLine(const Config& config, uint32_t hit, Line& line) const {
+    const double z = fZ[hit] - config.vertexZ;
+    line.Add(fGrids[fLayer[hit]].weight, z, Bend(z), fX[hit], fY[hit]);
+}
+
+void TrackFinder::Extend(const Config& config, int first, int end, Line& line,
+                         std::vector<uint32_t>& hits) const {
+    const int step = end > first ? 1 : -1;
+    int holes = 0;
+    for (int l = first; l != end; l += step) {
+        const int64_t h = Nearest(config, l, line);
+        if (h == -1 && ++holes > config.maxHoles) break;
+        if (h < 0) continue;
+        hits.push_back(uint32_t(h));
+        AddToLine(config, uint32_t(h), line);
+    }
+}
+
+void TrackFinder::Find(const Config& config) {
+    const std::size_t n = fX.size();
+    fTracks.clear();
+    fTrackHits.clear();
+    fCandStart.assign(1, 0);
+    fCandHits.clear();
+    fClaimed.assign(n, 0);
+    fUsed.assign(n, 0);
+    if (n == 0) return;
+    fScan = int64_t(n) < config.scanHits;
+    BuildGrids();
+
+    // Bending past the coil entry: |c| = 0.003 Bz tan(theta) / p at most
+    // (1/cm for T and GeV), tan(theta) within the disks in the field.
+    // Without field u is 0 everywhere and a unit prior keeps c at 0
+    double maxSlope = 0.;
+    for (const auto& g : fGrids) {
+        if (g.z > config.fieldZ) maxSlope = std::max(maxSlope, g.rMax / (g.z - config.vertexZ));
+    }
+    const double maxBend = 0.003 * std::abs(config.fieldBz) * maxSlope / config.minMomentum;
+    fBendZ = maxBend > 0. ? config.fieldZ - config.vertexZ : std::numeric_limits<double>::infinity();
+    fPrior = maxBend > 0. ? 1. / (maxBend * maxBend) : 1.;
+    Line prior;
+    prior.suu = fPrior;
+
+    // The target as a first point: windows stay narrow while only the
+    // coarse FVTX hits are on the line
+    Line target = prior;
+    target.Add(1. / (config.vertexSigma * config.vertexSigma), 0., 0., 0., 0.);
+
+    const int nLayers = int(fGrids.size());
+    const auto minHits = std::size_t(std::max(3, config.minHits));
+    for (int pass = 0; pass < 2; ++pass)
+    for (int a = 0; a + 2 < nLayers; ++a) {
+        if ((3. * fGrids[a].sigma > config.window) != (pass == 1)) continue;
+        for (uint32_t k = fLayerStart[a]; k < fLayerStart[a + 1]; ++k) {
+            const uint32_t h1 = fSorted[k];
+            if (fClaimed[h1] || fZ[h1] <= config.vertexZ) continue;
+            Line line1 = target;
+            AddToLine(config, h1, line1);
+
+            bool found = false;
+            for (int b = a + 1; b <= a + 2 && b + 1 < nLayers && !found; ++b) {
+                const double zb = fGrids[b].z - config.vertexZ;
+                double x, y, variance;
+                line1.At(zb, Bend(zb), x, y, variance);
+                const double sigma = fGrids[b].sigma;
+                const double w = std::max(config.seedWindow, 3. * std::sqrt(variance + sigma * sigma));
+                // Second hits nearest first: the result does not depend on the grid
+                fSeconds.clear();
+                ForEach(b, x, y, w, [&](uint32_t h2, double d2) {
+                    if (!fClaimed[h2] && fZ[h2] > fZ[h1]) fSeconds.emplace_back(d2, h2);
+                });
+                std::sort(fSeconds.begin(), fSeconds.end());
+                for (const auto& second : fSeconds) {
+                    const uint32_t h2 = second.second;
+                    Line line2 = line1;
+                    AddToLine(config, h2, line2);
+                    for (int c = b + 1; c <= b + 2 && c < nLayers; ++c) {
+                        const int64_t h3 = Nearest(config, c, line2);
+                        if (h3 < 0) continue;
+                        fCandidate.assign({h1, h2, uint32_t(h3)});
+                        AddToLine(config, uint32_t(h3), line2);
+                        Extend(config, c + 1, nLayers, line2, fCandidate);
+                        Extend(config, a - 1, -1, line2, fCandidate);
+                        // Only a candidate that passes the selection claims its
+                        // hits; a rejected one leaves them to the next seeds
+                        Line fit = prior;
+                        for (auto h : fCandidate) AddToLine(config, h, fit);
+                        if (fCandidate.size() >= minHits && fit.Chi2(fCandidate.size()) <= config.maxChi2) {
+                            std::sort(fCandidate.begin(), fCandidate.end(),
+                                      [this](uint32_t i, uint32_t j) { return fLayer[i] < fLayer[j]; });
+                            fCandHits.insert(fCandHits.end(), fCandidate.begin(), fCandidate.end());
+                            fCandStart.push_back(uint32_t(fCandHits.size()));
+                            for (auto h : fCandidate) fClaimed[h] = 1;
+                            found = true;
+                        }
+                        break;
+                    }
+                    if (found) break;
+                }
+            }
+        }
+    }
+
+    Fit(config);
+    Select(config);
+}
+
+void TrackFinder::Fit(const Config& config) {
+    const std::size_t nc = fCandStart.size() - 1;
+    for (auto* v : {&fSw, &fSz, &fSzz, &fSu, &fSzu, &fSx, &fSxz, &fSxu, &fSxx, &fSy, &fSyz, &fSyu, &fSyy,
+                    &fN, &fX0, &fY0, &fTx, &fTy, &fCx, &fCy, &fChi2}) {
+        v->assign(nc, 0.);
+    }
+    fSuu.assign(nc, fPrior);
+
+    // Weighted sums, z from the target
+    for (std::size_t i = 0; i < nc; ++i) {
+        for (uint32_t k = fCandStart[i]; k < fCandStart[i + 1]; ++k) {
+            const uint32_t h = fCandHits[k];
+            const double w = fGrids[fLayer[h]].weight;
+            const double z = fZ[h] - config.vertexZ, u = Bend(z), x = fX[h], y = fY[h];
+            fSw[i]  += w;
+            fSz[i]  += w * z;
+            fSzz[i] += w * z * z;
+            fSu[i]  += w * u;
+            fSzu[i] += w * z * u;
+            fSuu[i] += w * u * u;
+            fSx[i]  += w * x;
+            fSxz[i] += w * x * z;
+            fSxu[i] += w * x * u;
+            fSxx[i] += w * x * x;
+            fSy[i]  += w * y;
+            fSyz[i] += w * y * z;
+            fSyu[i] += w * y * u;
+            fSyy[i] += w * y * y;
+        }
+        fN[i] = fCandStart[i + 1] - fCandStart[i];
+    }
+
+    // Closed-form solution, no branches
+    const double* __restrict sw  = fSw.data();
+    const double* __restrict sz  = fSz.data();
+    const double* __restrict szz = fSzz.data();
+    const double* __restrict su  = fSu.data();
+    const double* __restrict szu = fSzu.data();
+    const double* __restrict suu = fSuu.data();
+    const double* __restrict sx  = fSx.data();
+    const double* __restrict sxz = fSxz.data();
+    const double* __restrict sxu = fSxu.data();
+    const double* __restrict sxx = fSxx.data();
+    const double* __restrict sy  = fSy.data();
+    const double* __restrict syz = fSyz.data();
+    const double* __restrict syu = fSyu.data();
+    const double* __restrict syy = fSyy.data();
+    const double* __restrict nh  = fN.data();
+    double* __restrict x0   = fX0.data();
+    double* __restrict y0   = fY0.data();
+    double* __restrict tx   = fTx.data();
+    double* __restrict ty   = fTy.data();
+    double* __restrict cx   = fCx.data();
+    double* __restrict cy   = fCy.data();
+    double* __restrict chi2 = fChi2.data();
+
+#pragma omp simd
+    for (std::size_t i = 0; i < nc; ++i) {
+        // As in Line::Solve()
+        const double c00 = szz[i] * suu[i] - szu[i] * szu[i];
+        const double c01 = su[i] * szu[i] - sz[i] * suu[i];
+        const double c02 = sz[i] * szu[i] - szz[i] * su[i];
+        const double invDet = 1. / (sw[i] * c00 + sz[i] * c01 + su[i] * c02);
+        const double i00 = c00 * invDet, i01 = c01 * invDet, i02 = c02 * invDet;
+        const double i11 = (sw[i] * suu[i] - su[i] * su[i]) * invDet;
+        const double i12 = (su[i] * sz[i] - sw[i] * szu[i]) * invDet;
+        const double i22 = (sw[i] * szz[i] - sz[i] * sz[i]) * invDet;
+        const double ax = i00 * sx[i] + i01 * sxz[i] + i02 * sxu[i];
+        const double bx = i01 * sx[i] + i11 * sxz[i] + i12 * sxu[i];
+        const double kx = i02 * sx[i] + i12 * sxz[i] + i22 * sxu[i];
+        const double ay = i00 * sy[i] + i01 * syz[i] + i02 * syu[i];
+        const double by = i01 * sy[i] + i11 * syz[i] + i12 * syu[i];
+        const double ky = i02 * sy[i] + i12 * syz[i] + i22 * syu[i];
+        const double c2 = sxx[i] - (ax * sx[i] + bx * sxz[i] + kx * sxu[i])
+                        + syy[i] - (ay * sy[i] + by * syz[i] + ky * syu[i]);
+        x0[i] = ax;
+        y0[i] = ay;
+        tx[i] = bx;
+        ty[i] = by;
+        cx[i] = kx;
+        cy[i] = ky;
+        chi2[i] = std::max(0., c2) / (2. * nh[i] - 4.);
+    }
+}
+
+void TrackFinder::Select(const Config& config) {
+    const std::size_t nc = fCandStart.size() - 1;
+    fScratch.resize(nc);
+    std::iota(fScratch.begin(), fScratch.end(), 0);
+    std::sort(fScratch.begin(), fScratch.end(), [this](uint32_t a, uint32_t b) {
+        return fN[a] != fN[b] ? fN[a] > fN[b] : fChi2[a] < fChi2[b];
+    });
+
+    for (auto i : fScratch) {
+        if (!(fChi2[i] <= config.maxChi2)) continue;
+        const auto begin = fCandHits.begin() + fCandStart[i], end = fCandHits.begin() + fCandStart[i + 1];
+        if (std::any_of(begin, end, [this](uint32_t h) { return fUsed[h]; })) continue;
+
+        Track track;
+        track.x0 = fX0[i];
+        track.y0 = fY0[i];
+        track.tx = fTx[i];
+        track.ty = fTy[i];
+        track.cx = fCx[i];
+        track.cy = fCy[i];
+        track.chi2 = fChi2[i];
+        track.firstHit = uint32_t(fTrackHits.size());
+        track.nHits = uint32_t(end - begin);
+        for (auto it = begin; it != end; ++it) fUsed[*it] = 1;
+        fTrackHits.insert(fTrackHits.end(), begin, end);
+        fTracks.push_back(track);
+    }
+}
+
+int32_t TrackFinder::MajorityId(const Track& track, uint32_t& count) const {
+    int32_t best = -1;
+    count = 0;
+    for (uint32_t i = 0; i < track.nHits; ++i) {
+        const int32_t id = fId[fTrackHits[track.firstHit + i]];
+        uint32_t n = 0;
+        for (uint32_t j = 0; j < track.nHits; ++j) n += fId[fTrackHits[track.firstHit + j]] == id;
+        if (n > count) {
+            best = id;
+            count = n;
+        }
+    }
+    return best;
+}
@@ -0,0 +1,171 @@
+#ifndef TRACKFINDER_HH
+#define TRACKFINDER_HH
+
+#include "GeometryDescription.hh"
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+// Track reconstruction in the forward disks: the FVTX, then the LD and HD
+// disks a track from the target crosses downstream. Global coordinates in
+// cm. Tracks are straight from the target up to fieldZ, the coil entry,
+// and bend past it in the solenoid field (fieldBz): x(z) and y(z) take a
+// parabola term c (z - fieldZ)^2 / 2, the small-angle helix of a forward
+// track. c has a Gaussian prior of width 0.003 fieldBz tan(theta) /
+// minMomentum, the largest theta of the disks in the field; without it c is 0
+// and the fit is a straight line.
+//  1. hits of each layer binned in an (r, phi) grid: counting sort over the
+//     occupied cells only, so an event costs its hits, not the grid size.
+//     Below scanHits hits an event is sorted by layer only and every
+//     window scans its layer: cheaper at low multiplicity
+//  2. seeds: a hit; a second one around the line from the target through
+//     it; the nearest third one around the line through all three. At most
+//     one layer skipped between them. Seeds start in the precise layers
+//     (3 sigma within window) first, in the coarse FVTX ones only from the hits
+//     left over
+//  3. extension through the next layers, then back through the previous
+//     ones: nearest hit around the line through the target and the hits so
+//     far; stops after maxHoles layers crossed without a hit
+// Each window is 3 sigma of the extrapolation (target and hits weighted by
+// their resolution) and of the layer, at least seedWindow / window.
+// A candidate with minHits and a fit within maxChi2 claims its hits: they
+// start no seed and join no other candidate. Rejected ones claim nothing.
+//  4. all candidates fitted at once: weighted least squares x(z), y(z) in
+//     closed form (3x3 normal equations by cofactors) over
+//     structure-of-arrays sums, a loop without branches
+//  5. candidates by number of hits then chi2, each hit on one track only
+// No Geant4 dependency: EICSensitiveDetector runs it after each event
+// (/eic/reco/enable), tools/recoDigits on stored digits.
+class TrackFinder {
+public:
+    struct Layer {
+        double z = 0.;                 // global, cm
+        double rMin = 0., rMax = 0.;   // cm
+        double sigma = 0.01;           // hit resolution, cm
+    };
+
+    struct Config {
+        double vertexZ     = -300.;    // target, cm; beam on the z axis
+        double vertexSigma = 0.1;      // cm, in x and y
+        double seedWindow  = 1.;       // cm
+        double window      = 0.5;      // cm
+        int    minHits     = 4;
+        int    maxHoles    = 2;
+        double maxChi2     = 20.;      // per degree of freedom
+        double fieldBz     = 0.;       // T, 0: straight tracks
+        double fieldZ      = -202.;    // global cm, where the bending starts
+        double minMomentum = 2.;       // GeV, sets the bending allowed
+        int    scanHits    = 3000;     // fewer hits in the event: no grid
+    };
+
+    // Process-wide settings, set on the master (TrackOutputMessenger)
+    struct Settings {
+        bool   enabled = false;        // in-process, after each event
+        Config config;
+    };
+    static Settings& GetSettings();
+
+    struct Track {
+        double   x0, y0;               // at vertexZ, cm
+        double   tx, ty;               // dx/dz, dy/dz before fieldZ
+        double   cx, cy;               // d2x/dz2, d2y/dz2 past fieldZ, 1/cm
+        double   chi2;                 // per degree of freedom
+        uint32_t firstHit, nHits;      // in TrackHits()
+    };
+
+    // FVTX and InnerTracker disks of a description (subsystem=), by z.
+    // Resolution: coarser readout pitch / sqrt(12). `volumes` gets the
+    // volume of each layer
+    static std::vector<Layer> DiskLayers(const GeometryDescription& description,
+                                         std::vector<const GeometryDescription::Volume*>& volumes);
+
+    // Layers in any order, AddHit takes their index. `cell`: grid cell in r
+    // and in r * phi at rMax, cm
+    explicit TrackFinder(const std::vector<Layer>& layers, double cell = 1.);
+
+    void Clear();
+    void AddHit(int layer, double x, double y, double z, int32_t id);
+    void Find(const Config& config);
+
+    std::size_t Hits() const { return fX.size(); }
+    const std::vector<Track>& Tracks() const { return fTracks; }
+    const std::vector<uint32_t>& TrackHits() const { return fTrackHits; }
+    int32_t HitId(uint32_t hit) const { return fId[hit]; }
+    // Most frequent hit id of a track (the MC track in the simulation)
+    // and the number of its hits carrying it
+    int32_t MajorityId(const Track& track, uint32_t& count) const;
+
+private:
+    struct Grid {
+        double   z, rMin, rMax, sigma, weight;
+        double   cellsPerCm;           // r
+        double   cellsPerRad;          // phi
+        uint32_t nR, nPhi;
+        uint32_t base;                 // first global cell
+    };
+
+    // Weighted least squares x = ax + bx z + cx u, y likewise, with z from
+    // the target and u = Bend(z), built point by point. suu starts at the
+    // prior weight of c
+    struct Line {
+        double sw = 0., sz = 0., szz = 0., su = 0., szu = 0., suu = 0.;
+        double sx = 0., sxz = 0., sxu = 0., sxx = 0., sy = 0., syz = 0., syu = 0., syy = 0.;
+        struct Solution {
+            double ax, bx, cx, ay, by, cy;
+            double i00, i01, i02, i11, i12, i22; // inverse normal matrix
+        };
+        void Add(double w, double z, double u, double x, double y);
+        Solution Solve() const;
+        // Position at z, and its variance in x (same in y)
+        void At(double z, double u, double& x, double& y, double& variance) const;
+        // Chi2 per degree of freedom of the fit through n points
+        double Chi2(std::size_t n) const;
+    };
+
+    // Parabola term at z from the target: 0 before the field
+    double Bend(double z) const { return z > fBendZ ? 0.5 * (z - fBendZ) * (z - fBendZ) : 0.; }
+    void BuildGrids();
+    // Hits of layer l within w of (x, y): f(hit, distance squared)
+    template <class F> void ForEach(int l, double x, double y, double w, F&& f) const;
+    // Nearest hit of layer l around the extrapolation of `line`; -1 if
+    // none, -2 if the line misses the layer
+    int64_t Nearest(const Config& config, int l, const Line& line) const;
+    void AddToLine(const Config& config, uint32_t hit, Line& line) const;
+    // Nearest hits of the layers from `first` to `end` (excluded, either
+    // direction), each added to the line
+    void Extend(const Config& config, int first, int end, Line& line, std::vector<uint32_t>& hits) const;
+    void Fit(const Config& config);
+    void Select(const Config& config);
+
+    std::vector<Grid> fGrids;          // by z
+    std::vector<int>  fOrder;          // caller's layer -> grid
+    bool              fScan = false;   // this event: one cell per layer
+    double            fBendZ = 0.;     // this event: fieldZ from the target, or infinity
+    double            fPrior = 1.;     // this event: weight of the prior on c
+
+    // Hits, structure of arrays
+    std::vector<double>   fX, fY, fZ;
+    std::vector<int32_t>  fId;
+    std::vector<uint16_t> fLayer;      // grid
+    std::vector<uint32_t> fCell;       // global cell
+    std::vector<uint32_t> fCellStart;  // into fSorted; valid where fCellCount > 0
+    std::vector<uint32_t> fCellCount;  // this event, zero elsewhere
+    std::vector<uint32_t> fOccupied;   // cells with hits, sorted
+    std::vector<uint32_t> fSorted;     // hits by layer and cell
+    std::vector<uint32_t> fLayerStart; // into fSorted, by grid, then the end
+    std::vector<uint8_t>  fClaimed;    // on a candidate within maxChi2: starts no seed
+    std::vector<uint8_t>  fUsed;       // on an accepted track
+
+    // Candidates: hits, then the fit
+    std::vector<uint32_t> fCandStart, fCandHits, fCandidate, fScratch;
+    std::vector<std::pair<double, uint32_t>> fSeconds;   // seed second hits, by distance
+    std::vector<double>   fSw, fSz, fSzz, fSu, fSzu, fSuu, fSx, fSxz, fSxu, fSxx, fSy, fSyz, fSyu, fSyy, fN;
+    std::vector<double>   fX0, fY0, fTx, fTy, fCx, fCy, fChi2;
+
+    std::vector<Track>    fTracks;
+    std::vector<uint32_t> fTrackHits;
+};
+
+#endif
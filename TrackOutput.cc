@@ -0,0 +1,503 @@
+#include "TrackOutput.hh"
+#include "AsyncWriter.hh"
+#include "Log.hh"
+
+#include "G4ios.hh"
+
+#include "Compression.h"
+#include "TBranch.h"
+#include "TFile.h"
+#include "TTree.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <numeric>
+#include <queue>
+#include <utility>
+
+TrackOutput::Settings TrackOutput::fgSettings;
+std::mutex TrackOutput::fgFilesMutex;
+std::vector<std::string> TrackOutput::fgWorkerFiles;
+
+namespace {
+    G4ThreadLocal TrackOutput* instance = nullptr;
+
+    using Clock = std::chrono::steady_clock;
+
+    G4double SecondsSince(Clock::time_point start) {
+        return std::chrono::duration<G4double>(Clock::now() - start).count();
+    }
+}
+
+TrackOutput* TrackOutput::GetInstance() {
+    if (!instance) {
+        instance = new TrackOutput();
+    }
+    return instance;
+}
+
+TrackOutput::TrackOutput() {
+    std::memset(&fRow, 0, sizeof(fRow));
+}
+
+TrackOutput::~TrackOutput() {
+    Close();
+    for (auto batch : fBatches) delete batch;
+    delete fCompact;
+    delete fDigits;
+}
+
+G4int TrackOutput::CompressionSettings(const G4String& algorithm, G4int level) {
+    using Algo = ROOT::RCompressionSetting::EAlgorithm;
+    if (algorithm == "zlib") return ROOT::CompressionSettings(Algo::kZLIB, level);
+    if (algorithm == "lzma") return ROOT::CompressionSettings(Algo::kLZMA, level);
+    if (algorithm == "lz4")  return ROOT::CompressionSettings(Algo::kLZ4,  level);
+    if (algorithm == "zstd") return ROOT::CompressionSettings(Algo::kZSTD, level);
+    return -1;
+}
+
+const char* TrackOutput::TreeName() {
+    switch (fgSettings.schema) {
+        case Schema::Legacy: return "TrackTree";
+        case Schema::Digits: return "Digits";
+        default:             return "Events";
+    }
+}
+
+G4String TrackOutput::WorkerFileName(G4int threadId) {
+    return "tracks_output_t" + std::to_string(threadId) + ".root";
+}
+
+void TrackOutput::Open(const G4String& fileName) {
+    Close();
+
+    fEventsSinceSave = 0;
+    fBytesAtLastSave = 0.;
+    fIOTime = 0.;
+    fBytesWritten = 0.;
+    fDimuonEvents = 0;
+    fSchema = fgSettings.schema;
+
+    const auto start = Clock::now();
+    fFile = new TFile(fileName.c_str(), "RECREATE");
+    if (!fFile || fFile->IsZombie()) {
+        G4cerr << "Error: Could not create track output file " << fileName << G4endl;
+        delete fFile;
+        fFile = nullptr;
+        return;
+    }
+
+    // Branches take the file's compression when they are created
+    if (fgSettings.compression >= 0) fFile->SetCompressionSettings(fgSettings.compression);
+    if (fSchema == Schema::Legacy) {
+        BookLegacy();
+    } else if (fSchema == Schema::Digits) {
+        BookDigits();
+    } else {
+        BookCompact();
+    }
+
+    // Flushing is driven by Write(), not by ROOT's default 300 MB autosave
+    fTree->SetBasketSize("*", fgSettings.basketSize);
+    fTree->SetAutoSave(0);
+    fIOTime += SecondsSince(start);
+
+    std::lock_guard<std::mutex> lock(fgFilesMutex);
+    fgWorkerFiles.push_back(fileName);
+}
+
+void TrackOutput::BookLegacy() {
+    fTree = new TTree("TrackTree", "Track information per event");
+    fTree->SetDirectory(fFile);
+
+    fTree->Branch("EventID", &fRow.eventID, "EventID/I");
+    fTree->Branch("Weight", &fRow.weight, "Weight/D");
+    fTree->Branch("TrackID", &fRow.trackID, "TrackID/I");
+    fTree->Branch("ParticleName", fRow.particleName, "ParticleName/C");
+    fTree->Branch("PosX", &fRow.posX, "PosX/F");
+    fTree->Branch("PosY", &fRow.posY, "PosY/F");
+    fTree->Branch("PosZ", &fRow.posZ, "PosZ/F");
+    fTree->Branch("EnergyDeposit_GeV", &fRow.energyDep, "EnergyDeposit_GeV/F");
+    fTree->Branch("KineticEnergy_GeV", &fRow.kineticEnergy, "KineticEnergy_GeV/F");
+
+    fTree->Branch("Px_GeV", &fRow.px, "Px_GeV/F");
+    fTree->Branch("Py_GeV", &fRow.py, "Py_GeV/F");
+    fTree->Branch("Pz_GeV", &fRow.pz, "Pz_GeV/F");
+
+    fTree->Branch("x1", &fRow.x1, "x1/F");
+    fTree->Branch("x2", &fRow.x2, "x2/F");
+    fTree->Branch("xF", &fRow.xF, "xF/F");
+
+    fTree->Branch("y", &fRow.y, "y/F");
+
+    fTree->Branch("pT", &fRow.pT, "pT/F");
+    fTree->Branch("e", &fRow.e, "e/F");
+    fTree->Branch("Mass", &fRow.mass, "Mass/F");
+
+    fTree->Branch("Theta_rad", &fRow.theta, "Theta_rad/F");
+    fTree->Branch("Phi_rad", &fRow.phi, "Phi_rad/F");
+}
+
+void TrackOutput::BookCompact() {
+    if (!fCompact) fCompact = new Compact();
+    auto& c = *fCompact;
+
+    fTree = new TTree("Events", "Muons and mu+mu- pairs per event");
+    fTree->SetDirectory(fFile);
+
+    fTree->Branch("EventID", &c.eventID, "EventID/I");
+    fTree->Branch("Weight", &c.weight, "Weight/D");
+    fTree->Branch("EdepTotal_GeV", &c.edepTotal, "EdepTotal_GeV/F");
+
+    fTree->Branch("nMuon", &c.nMuon, "nMuon/I");
+    fTree->Branch("Muon_TrackID", c.muTrackID, "Muon_TrackID[nMuon]/I");
+    fTree->Branch("Muon_PDG", c.muPDG, "Muon_PDG[nMuon]/I");
+    fTree->Branch("Muon_PosX", c.muPosX, "Muon_PosX[nMuon]/F");
+    fTree->Branch("Muon_PosY", c.muPosY, "Muon_PosY[nMuon]/F");
+    fTree->Branch("Muon_PosZ", c.muPosZ, "Muon_PosZ[nMuon]/F");
+    fTree->Branch("Muon_EnergyDeposit_GeV", c.muEdep, "Muon_EnergyDeposit_GeV[nMuon]/F");
+    fTree->Branch("Muon_KineticEnergy_GeV", c.muEkin, "Muon_KineticEnergy_GeV[nMuon]/F");
+    fTree->Branch("Muon_Px_GeV", c.muPx, "Muon_Px_GeV[nMuon]/F");
+    fTree->Branch("Muon_Py_GeV", c.muPy, "Muon_Py_GeV[nMuon]/F");
+    fTree->Branch("Muon_Pz_GeV", c.muPz, "Muon_Pz_GeV[nMuon]/F");
+    fTree->Branch("Muon_E_GeV", c.muE, "Muon_E_GeV[nMuon]/F");
+
+    // Pair_MuPlus / Pair_MuMinus index the Muon_* arrays of the same entry
+    fTree->Branch("nPair", &c.nPair, "nPair/I");
+    fTree->Branch("Pair_MuPlus", c.pairPlus, "Pair_MuPlus[nPair]/I");
+    fTree->Branch("Pair_MuMinus", c.pairMinus, "Pair_MuMinus[nPair]/I");
+    fTree->Branch("Pair_Mass", c.pairMass, "Pair_Mass[nPair]/F");
+    fTree->Branch("Pair_pT", c.pairPT, "Pair_pT[nPair]/F");
+    fTree->Branch("Pair_y", c.pairY, "Pair_y[nPair]/F");
+    fTree->Branch("Pair_xF", c.pairXF, "Pair_xF[nPair]/F");
+    fTree->Branch("Pair_x1", c.pairX1, "Pair_x1[nPair]/F");
+    fTree->Branch("Pair_x2", c.pairX2, "Pair_x2[nPair]/F");
+    fTree->Branch("Pair_Theta_rad", c.pairTheta, "Pair_Theta_rad[nPair]/F");
+    fTree->Branch("Pair_Phi_rad", c.pairPhi, "Pair_Phi_rad[nPair]/F");
+}
+
+void TrackOutput::BookDigits() {
+    if (!fDigits) fDigits = new Digits();
+    auto& d = *fDigits;
+
+    fTree = new TTree("Digits", "Tracker channels above threshold per event");
+    fTree->SetDirectory(fFile);
+
+    fTree->Branch("EventID", &d.eventID, "EventID/I");
+    fTree->Branch("Weight", &d.weight, "Weight/D");
+    // Digit_Detector: readout volume in description order (Readout.hh)
+    fTree->Branch("nDigit", &d.nDigit, "nDigit/I");
+    fTree->Branch("Digit_Detector", d.detector, "Digit_Detector[nDigit]/s");
+    fTree->Branch("Digit_Channel", d.channel, "Digit_Channel[nDigit]/i");
+    fTree->Branch("Digit_ADC", d.adc, "Digit_ADC[nDigit]/s");
+}
+
+void TrackOutput::OpenAsync() {
+    Close();
+
+    fIOTime = 0.;
+    fBytesWritten = 0.;
+    fDimuonEvents = 0;
+    fAsync = true;
+
+    const std::size_t nBuffers = std::max(2, fgSettings.buffers);
+    while (fBatches.size() < nBuffers) fBatches.push_back(new OutputBatch());
+    for (auto batch : fBatches) batch->size = 0;
+    fCurrentBatch = 0;
+}
+
+void TrackOutput::HandOff() {
+    const auto start = Clock::now();
+    auto& writer = AsyncWriter::Instance();
+    writer.Push(fBatches[fCurrentBatch]);
+
+    // Next buffer: wait until the writer is done with it
+    fCurrentBatch = (fCurrentBatch + 1) % fBatches.size();
+    auto next = fBatches[fCurrentBatch];
+    writer.WaitIdle(next);
+    next->size = 0;
+    fIOTime += SecondsSince(start);
+}
+
+void TrackOutput::Write(const EventRecord& record) {
+    if (!record.pairs.empty()) ++fDimuonEvents;
+
+    if (fAsync) {
+        auto batch = fBatches[fCurrentBatch];
+        if (batch->size == batch->events.size()) batch->events.emplace_back();
+        batch->events[batch->size++] = record;   // reuses the slot's capacity
+        if (static_cast<G4int>(batch->size) >= fgSettings.batchEvents) HandOff();
+        return;
+    }
+    if (!fTree) return;
+
+    const auto start = Clock::now();
+    if (fSchema == Schema::Legacy) {
+        FillLegacy(record);
+    } else if (fSchema == Schema::Digits) {
+        FillDigits(record);
+    } else {
+        FillCompact(record);
+    }
+    fIOTime += SecondsSince(start);
+
+    ++fEventsSinceSave;
+    const auto& cfg = fgSettings;
+    const G4bool byEvents = cfg.autoSaveEvents > 0 && fEventsSinceSave >= cfg.autoSaveEvents;
+    const G4bool byBytes  = cfg.autoSaveBytes > 0. &&
+                            fTree->GetTotBytes() - fBytesAtLastSave >= cfg.autoSaveBytes;
+    if (byEvents || byBytes) AutoSave();
+}
+
+void TrackOutput::FillLegacy(const EventRecord& record) {
+    fRow.eventID = record.eventID;
+    fRow.weight = record.weight;
+
+    for (const auto& pair : record.pairs) {
+        fRow.theta = pair.theta;
+        fRow.phi   = pair.phi;
+        fRow.xF    = pair.xF;
+        fRow.pT    = pair.pT;
+        fRow.mass  = pair.mass;
+        fRow.y     = pair.y;
+        fRow.x1    = pair.x1;
+        fRow.x2    = pair.x2;
+
+        for (auto index : {pair.iPlus, pair.iMinus}) {
+            const auto& mu = record.muons[index];
+            fRow.trackID = mu.trackID;
+            strncpy(fRow.particleName, mu.pdg < 0 ? "mu+" : "mu-", sizeof(fRow.particleName));
+            fRow.particleName[sizeof(fRow.particleName)-1] = '\0';
+
+            fRow.posX = mu.posX;
+            fRow.posY = mu.posY;
+            fRow.posZ = mu.posZ;
+            fRow.energyDep = mu.energyDep;
+            fRow.kineticEnergy = mu.kineticEnergy;
+
+            fRow.px = mu.px;
+            fRow.py = mu.py;
+            fRow.pz = mu.pz;
+            fRow.e = mu.e;
+
+            fTree->Fill();
+        }
+    }
+}
+
+void TrackOutput::FillCompact(const EventRecord& record) {
+    auto& c = *fCompact;
+    c.eventID = record.eventID;
+    c.weight = record.weight;
+    c.edepTotal = record.edepTotal;
+
+    const G4int nMuon = std::min<G4int>(record.muons.size(), kMaxMuons);
+    if (nMuon < static_cast<G4int>(record.muons.size())) {
+        Log::Warning("muons not written", "event ", record.eventID, " has ", record.muons.size(),
+                     " muons, only ", kMaxMuons, " written");
+    }
+    c.nMuon = nMuon;
+    for (G4int i = 0; i < nMuon; ++i) {
+        const auto& mu = record.muons[i];
+        c.muTrackID[i] = mu.trackID;
+        c.muPDG[i]     = mu.pdg;
+        c.muPosX[i]    = mu.posX;
+        c.muPosY[i]    = mu.posY;
+        c.muPosZ[i]    = mu.posZ;
+        c.muEdep[i]    = mu.energyDep;
+        c.muEkin[i]    = mu.kineticEnergy;
+        c.muPx[i]      = mu.px;
+        c.muPy[i]      = mu.py;
+        c.muPz[i]      = mu.pz;
+        c.muE[i]       = mu.e;
+    }
+
+    G4int nPair = 0;
+    for (const auto& pair : record.pairs) {
+        if (nPair == kMaxPairs) break;
+        if (pair.iPlus >= nMuon || pair.iMinus >= nMuon) continue;
+        c.pairPlus[nPair]  = pair.iPlus;
+        c.pairMinus[nPair] = pair.iMinus;
+        c.pairMass[nPair]  = pair.mass;
+        c.pairPT[nPair]    = pair.pT;
+        c.pairY[nPair]     = pair.y;
+        c.pairXF[nPair]    = pair.xF;
+        c.pairX1[nPair]    = pair.x1;
+        c.pairX2[nPair]    = pair.x2;
+        c.pairTheta[nPair] = pair.theta;
+        c.pairPhi[nPair]   = pair.phi;
+        ++nPair;
+    }
+    c.nPair = nPair;
+
+    fTree->Fill();
+}
+
+void TrackOutput::FillDigits(const EventRecord& record) {
+    auto& d = *fDigits;
+    d.eventID = record.eventID;
+    d.weight = record.weight;
+
+    const G4int nDigit = std::min<G4int>(record.digits.size(), kMaxDigits);
+    if (nDigit < static_cast<G4int>(record.digits.size())) {
+        Log::Warning("digits not written", "event ", record.eventID, " has ", record.digits.size(),
+                     " digits, only ", kMaxDigits, " written");
+    }
+    d.nDigit = nDigit;
+    for (G4int i = 0; i < nDigit; ++i) {
+        const auto& digit = record.digits[i];
+        d.detector[i] = digit.detector;
+        d.channel[i]  = digit.channel;
+        d.adc[i]      = digit.adc;
+    }
+
+    fTree->Fill();
+}
+
+void TrackOutput::AutoSave() {
+    const auto start = Clock::now();
+    fTree->AutoSave("SaveSelf;FlushBaskets");
+    fIOTime += SecondsSince(start);
+
+    fEventsSinceSave = 0;
+    fBytesAtLastSave = fTree->GetTotBytes();
+}
+
+void TrackOutput::Close() {
+    if (fAsync) {
+        // Hand off the partial batch and wait until everything is written
+        if (fBatches[fCurrentBatch]->size > 0) HandOff();
+        for (auto batch : fBatches) AsyncWriter::Instance().WaitIdle(batch);
+        fAsync = false;
+        return;
+    }
+    if (!fFile) return;
+
+    // Forced flush at end of run
+    const auto start = Clock::now();
+    fFile->cd();
+    fTree->Write("", TObject::kOverwrite);
+    fFile->Close();
+    fBytesWritten = fFile->GetBytesWritten();
+    delete fFile;   // owns fTree
+    fFile = nullptr;
+    fTree = nullptr;
+    fIOTime += SecondsSince(start);
+}
+
+std::vector<std::string> TrackOutput::TakeWorkerFiles() {
+    std::lock_guard<std::mutex> lock(fgFilesMutex);
+    std::vector<std::string> files;
+    files.swap(fgWorkerFiles);
+    std::sort(files.begin(), files.end());
+    return files;
+}
+
+G4bool TrackOutput::Merge(const std::vector<std::string>& inputs, const G4String& output) {
+    if (inputs.empty()) return false;
+
+    // Each input is read front to back when it is in EventID order (a
+    // worker file); the asynchronous writer's file holds the batches of all
+    // workers in arrival order and is read through its own sorted index
+    struct Input {
+        std::unique_ptr<TFile> file;
+        TTree* tree = nullptr;
+        Int_t eventID = 0;
+        std::vector<Int_t> ids;         // EventID of each entry
+        std::vector<Long64_t> order;    // entries by EventID; empty: in order already
+        std::size_t next = 0;
+        Long64_t Entry(std::size_t i) const { return order.empty() ? Long64_t(i) : order[i]; }
+    };
+
+    const char* treeName = TreeName();
+    std::vector<Input> sources;
+    sources.reserve(inputs.size());   // no reallocation: branches hold addresses into it
+    for (const auto& f : inputs) {
+        // In place: the EventID branch reads into the element
+        auto& in = sources.emplace_back();
+        in.file.reset(TFile::Open(f.c_str(), "READ"));
+        in.tree = in.file && !in.file->IsZombie() ? in.file->Get<TTree>(treeName) : nullptr;
+        if (!in.tree) {
+            G4cerr << "Error: No " << treeName << " in worker output " << f << G4endl;
+            sources.pop_back();
+            continue;
+        }
+        in.tree->SetBranchStatus("*", 0);
+        in.tree->SetBranchStatus("EventID", 1);
+        in.tree->SetBranchAddress("EventID", &in.eventID);
+        const Long64_t n = in.tree->GetEntries();
+        in.ids.resize(n);
+        for (Long64_t i = 0; i < n; ++i) {
+            in.tree->GetEntry(i);
+            in.ids[i] = in.eventID;
+        }
+        in.tree->SetBranchStatus("*", 1);
+        if (!std::is_sorted(in.ids.begin(), in.ids.end())) {
+            // Entries of one event stay in the order they were written
+            in.order.resize(n);
+            std::iota(in.order.begin(), in.order.end(), 0);
+            std::stable_sort(in.order.begin(), in.order.end(),
+                             [&in](Long64_t a, Long64_t b) { return in.ids[a] < in.ids[b]; });
+        }
+    }
+    if (sources.empty()) return false;
+
+    TFile out(output.c_str(), "RECREATE");
+    if (fgSettings.compression >= 0) out.SetCompressionSettings(fgSettings.compression);
+    if (out.IsZombie()) {
+        G4cerr << "Error: Could not create merged output " << output << G4endl;
+        return false;
+    }
+
+    // The clone reads the buffers of the input being copied; they exist
+    // once the input has read an entry
+    auto& first = sources.front();
+    if (!first.ids.empty()) first.tree->GetEntry(first.Entry(0));
+    out.cd();
+    TTree* merged = first.tree->CloneTree(0);
+    if (!merged) {
+        G4cerr << "Error: Could not clone " << treeName << " from the worker outputs" << G4endl;
+        return false;
+    }
+    merged->SetDirectory(&out);
+    // CloneTree keeps the compression of the input branches
+    if (fgSettings.compression >= 0) {
+        for (auto* branch : TRangeDynCast<TBranch>(merged->GetListOfBranches())) {
+            if (branch) branch->SetCompressionSettings(fgSettings.compression);
+        }
+    }
+    merged->SetBasketSize("*", fgSettings.basketSize);
+    merged->SetAutoSave(0);
+
+    // k-way merge on EventID; equal IDs (one event) come from one input
+    using Head = std::pair<Int_t, std::size_t>;   // next EventID, input
+    std::priority_queue<Head, std::vector<Head>, std::greater<Head>> heads;
+    for (std::size_t k = 0; k < sources.size(); ++k) {
+        if (!sources[k].ids.empty()) heads.emplace(sources[k].ids[sources[k].Entry(0)], k);
+    }
+    const Input* current = &first;
+    while (!heads.empty()) {
+        const std::size_t k = heads.top().second;
+        heads.pop();
+        auto& in = sources[k];
+        const Long64_t entry = in.Entry(in.next);
+        in.tree->GetEntry(entry);
+        if (current != &in) {
+            in.tree->CopyAddresses(merged);
+            current = &in;
+        }
+        merged->Fill();
+        if (++in.next < in.ids.size()) heads.emplace(in.ids[in.Entry(in.next)], k);
+    }
+
+    out.cd();
+    merged->Write("", TObject::kOverwrite);
+    out.Close();
+
+    for (const auto& f : inputs) std::remove(f.c_str());
+    return true;
+}
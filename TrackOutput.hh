@@ -0,0 +1,169 @@
+#ifndef TRACKOUTPUT_HH
+#define TRACKOUTPUT_HH
+
+#include "globals.hh"
+#include "Rtypes.h"
+#include "EventRecord.hh"
+
+#include <mutex>
+#include <string>
+#include <vector>
+
+class TFile;
+class TTree;
+struct OutputBatch;
+
+// Per-thread sink for the muon/pair output.
+// Every worker owns its own TFile/TTree (no shared state on the event path),
+// the master merges the per-thread files at the end of the run.
+//
+// Three layouts:
+//  - Compact (default): tree "Events", one entry per event, muon and pair
+//    collections as flat arrays; pairs point to muons by index.
+//  - Legacy: tree "TrackTree", two rows per mu+mu- pair, pair variables
+//    repeated on both rows.
+//  - Digits: tree "Digits", one entry per event, the tracker channels
+//    above threshold (detector, channel, ADC; Readout.hh), no MC truth.
+class TrackOutput {
+public:
+    enum class Schema { Compact, Legacy, Digits };
+
+    // Process-wide I/O settings, set on the master (TrackOutputMessenger)
+    // and picked up by the workers when they open their file.
+    struct Settings {
+        Schema   schema         = Schema::Compact;
+        G4int    autoSaveEvents = 1000;  // autosave every N events (0 = off)
+        G4double autoSaveBytes  = 0.;    // ... or every M bytes filled (0 = off)
+        G4int    basketSize     = 32000; // bytes per branch basket
+        G4int    compression    = -1;    // ROOT compression settings, -1 = ROOT default
+
+        // Asynchronous mode: events go to the AsyncWriter thread in batches
+        G4bool   async          = false;
+        G4int    batchEvents    = 100;   // events per hand-off
+        G4int    buffers        = 2;     // batches owned by each worker
+        G4int    queueSize      = 64;    // batches in flight, all workers
+    };
+    static Settings& GetSettings() { return fgSettings; }
+
+    // "zlib", "lzma", "lz4", "zstd" + level -> ROOT compression settings
+    // (-1 if the algorithm is unknown)
+    static G4int CompressionSettings(const G4String& algorithm, G4int level);
+
+    // Collection sizes of the compact layout; larger events are truncated
+    static constexpr G4int kMaxMuons = 64;
+    static constexpr G4int kMaxPairs = 1024;
+    static constexpr G4int kMaxDigits = 65536;
+
+    static TrackOutput* GetInstance();
+    ~TrackOutput();
+
+    void Open(const G4String& fileName);
+    // Worker side of the asynchronous mode: no file, events are batched
+    void OpenAsync();
+    void Close();
+    G4bool IsOpen() const { return fFile != nullptr || fAsync; }
+
+    // One call per event; applies the autosave policy
+    void Write(const EventRecord& record);
+
+    // Wall time spent in ROOT I/O and bytes written since the last Open()
+    G4double GetIOTime() const { return fIOTime; }
+    G4double GetBytesWritten() const { return fBytesWritten; }
+    // Events written with at least one mu+mu- pair since the last Open()
+    G4long GetDimuonEvents() const { return fDimuonEvents; }
+
+    // Tree written with the current settings
+    static const char* TreeName();
+
+    // File name used by worker thread `threadId`
+    static G4String WorkerFileName(G4int threadId);
+
+    // Files written by the workers since the last call (master side)
+    static std::vector<std::string> TakeWorkerFiles();
+
+    // Merge the per-thread files into `output`, entries ordered by EventID:
+    // a k-way merge over the files, each already in EventID order (the
+    // asynchronous writer's file through a sorted index). With --seed the
+    // result does not depend on the number of threads.
+    static G4bool Merge(const std::vector<std::string>& inputs, const G4String& output);
+
+private:
+    friend class AsyncWriter;   // owns the sink of its writer thread
+    TrackOutput();
+    TrackOutput(const TrackOutput&) = delete;
+    TrackOutput& operator=(const TrackOutput&) = delete;
+
+    // One row of the legacy TrackTree
+    struct Row {
+        Int_t   eventID;
+        Double_t weight;
+        Int_t   trackID;
+        char    particleName[50];
+        Float_t posX, posY, posZ;
+        Float_t energyDep;
+        Float_t kineticEnergy;
+        Float_t px, py, pz, e;
+        Float_t x1, x2, xF, y, pT, mass;
+        Float_t theta, phi;
+    };
+
+    // Branch buffers of the compact Events tree
+    struct Compact {
+        Int_t   eventID;
+        Double_t weight;
+        Float_t edepTotal;
+        Int_t   nMuon;
+        Int_t   muTrackID[kMaxMuons];
+        Int_t   muPDG[kMaxMuons];
+        Float_t muPosX[kMaxMuons], muPosY[kMaxMuons], muPosZ[kMaxMuons];
+        Float_t muEdep[kMaxMuons], muEkin[kMaxMuons];
+        Float_t muPx[kMaxMuons], muPy[kMaxMuons], muPz[kMaxMuons], muE[kMaxMuons];
+        Int_t   nPair;
+        Int_t   pairPlus[kMaxPairs], pairMinus[kMaxPairs];
+        Float_t pairMass[kMaxPairs], pairPT[kMaxPairs], pairY[kMaxPairs];
+        Float_t pairXF[kMaxPairs], pairX1[kMaxPairs], pairX2[kMaxPairs];
+        Float_t pairTheta[kMaxPairs], pairPhi[kMaxPairs];
+    };
+
+    // Branch buffers of the Digits tree
+    struct Digits {
+        Int_t    eventID;
+        Double_t weight;
+        Int_t    nDigit;
+        UShort_t detector[kMaxDigits];
+        UInt_t   channel[kMaxDigits];
+        UShort_t adc[kMaxDigits];
+    };
+
+    void BookLegacy();
+    void BookCompact();
+    void BookDigits();
+    void FillLegacy(const EventRecord& record);
+    void FillCompact(const EventRecord& record);
+    void FillDigits(const EventRecord& record);
+    void AutoSave();
+    void HandOff();
+
+    static Settings fgSettings;
+    static std::mutex fgFilesMutex;
+    static std::vector<std::string> fgWorkerFiles;
+
+    TFile*   fFile = nullptr;
+    TTree*   fTree = nullptr;
+    Schema   fSchema = Schema::Compact;
+    Row      fRow;
+    Compact* fCompact = nullptr;
+    Digits*  fDigits = nullptr;
+
+    G4bool fAsync = false;
+    std::vector<OutputBatch*> fBatches;
+    std::size_t fCurrentBatch = 0;
+
+    G4int    fEventsSinceSave = 0;
+    G4double fBytesAtLastSave = 0.;
+    G4double fIOTime = 0.;
+    G4double fBytesWritten = 0.;
+    G4long   fDimuonEvents = 0;
+};
+
+#endif
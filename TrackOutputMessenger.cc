@@ -0,0 +1,232 @@
+#include "TrackOutputMessenger.hh"
+#include "TrackOutput.hh"
+#include "Log.hh"
+#include "TrackFinder.hh"
+
+#include "G4UIdirectory.hh"
+#include "G4UIcommand.hh"
+#include "G4UIparameter.hh"
+#include "G4UIcmdWithAnInteger.hh"
+#include "G4UIcmdWithADouble.hh"
+#include "G4UIcmdWithABool.hh"
+#include "G4UIcmdWithAString.hh"
+#include "G4ios.hh"
+
+#include <sstream>
+
+TrackOutputMessenger::TrackOutputMessenger()
+{
+    fDirectory = new G4UIdirectory("/eic/output/");
+    fDirectory->SetGuidance("Track output (tracks_output.root) I/O settings.");
+
+    fSchemaCmd = new G4UIcmdWithAString("/eic/output/schema", this);
+    fSchemaCmd->SetGuidance("Output layout:");
+    fSchemaCmd->SetGuidance("  compact : tree Events, one entry per event, muon and pair arrays");
+    fSchemaCmd->SetGuidance("  legacy  : tree TrackTree, two rows per mu+mu- pair");
+    fSchemaCmd->SetGuidance("  digits  : tree Digits, tracker channels and ADC counts, no MC truth");
+    fSchemaCmd->SetParameterName("schema", false);
+    fSchemaCmd->SetCandidates("compact legacy digits");
+    fSchemaCmd->SetToBeBroadcasted(false);
+    fSchemaCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+    fAutoSaveEventsCmd = new G4UIcmdWithAnInteger("/eic/output/autoSaveEvents", this);
+    fAutoSaveEventsCmd->SetGuidance("Autosave the output tree every N events (0 = off).");
+    fAutoSaveEventsCmd->SetParameterName("N", false);
+    fAutoSaveEventsCmd->SetRange("N>=0");
+    fAutoSaveEventsCmd->SetToBeBroadcasted(false);
+    fAutoSaveEventsCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+    fAutoSaveBytesCmd = new G4UIcmdWithADouble("/eic/output/autoSaveBytes", this);
+    fAutoSaveBytesCmd->SetGuidance("Autosave the output tree every M bytes filled (0 = off).");
+    fAutoSaveBytesCmd->SetParameterName("M", false);
+    fAutoSaveBytesCmd->SetRange("M>=0");
+    fAutoSaveBytesCmd->SetToBeBroadcasted(false);
+    fAutoSaveBytesCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+    fBasketSizeCmd = new G4UIcmdWithAnInteger("/eic/output/basketSize", this);
+    fBasketSizeCmd->SetGuidance("Basket size of every output tree branch [bytes].");
+    fBasketSizeCmd->SetParameterName("size", false);
+    fBasketSizeCmd->SetRange("size>=1000");
+    fBasketSizeCmd->SetToBeBroadcasted(false);
+    fBasketSizeCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+    fCompressionCmd = new G4UIcommand("/eic/output/compression", this);
+    fCompressionCmd->SetGuidance("Compression algorithm and level of the output files.");
+    auto algo = new G4UIparameter("algorithm", 's', false);
+    algo->SetParameterCandidates("zlib lzma lz4 zstd");
+    fCompressionCmd->SetParameter(algo);
+    auto level = new G4UIparameter("level", 'i', true);
+    level->SetDefaultValue(4);
+    level->SetParameterRange("level>=0 && level<=9");
+    fCompressionCmd->SetParameter(level);
+    fCompressionCmd->SetToBeBroadcasted(false);
+    fCompressionCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+    fAsyncCmd = new G4UIcmdWithABool("/eic/output/async", this);
+    fAsyncCmd->SetGuidance("Write the output tree from a dedicated writer thread.");
+    fAsyncCmd->SetParameterName("async", true);
+    fAsyncCmd->SetDefaultValue(true);
+    fAsyncCmd->SetToBeBroadcasted(false);
+    fAsyncCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+    fBatchEventsCmd = new G4UIcmdWithAnInteger("/eic/output/asyncBatchEvents", this);
+    fBatchEventsCmd->SetGuidance("Events per batch handed to the writer thread.");
+    fBatchEventsCmd->SetParameterName("N", false);
+    fBatchEventsCmd->SetRange("N>=1");
+    fBatchEventsCmd->SetToBeBroadcasted(false);
+    fBatchEventsCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+    fBuffersCmd = new G4UIcmdWithAnInteger("/eic/output/asyncBuffers", this);
+    fBuffersCmd->SetGuidance("Batch buffers per worker thread (2 = double buffering).");
+    fBuffersCmd->SetParameterName("N", false);
+    fBuffersCmd->SetRange("N>=2");
+    fBuffersCmd->SetToBeBroadcasted(false);
+    fBuffersCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+    fQueueSizeCmd = new G4UIcmdWithAnInteger("/eic/output/asyncQueueSize", this);
+    fQueueSizeCmd->SetGuidance("Capacity of the worker -> writer queue [batches].");
+    fQueueSizeCmd->SetParameterName("N", false);
+    fQueueSizeCmd->SetRange("N>=2");
+    fQueueSizeCmd->SetToBeBroadcasted(false);
+    fQueueSizeCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+    fLogDirectory = new G4UIdirectory("/eic/log/");
+    fLogDirectory->SetGuidance("Messages of the per-event code paths (buffered per thread).");
+
+    fLogLevelCmd = new G4UIcmdWithAString("/eic/log/level", this);
+    fLogLevelCmd->SetGuidance("Lowest level printed (default info).");
+    fLogLevelCmd->SetParameterName("level", false);
+    fLogLevelCmd->SetCandidates("debug info warning error");
+    fLogLevelCmd->SetToBeBroadcasted(false);
+    fLogLevelCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+    fLogLimitCmd = new G4UIcmdWithAnInteger("/eic/log/limit", this);
+    fLogLimitCmd->SetGuidance("Messages printed per kind, thread and run; the others are counted");
+    fLogLimitCmd->SetGuidance("and reported at end of run. 0 = no limit.");
+    fLogLimitCmd->SetParameterName("N", false);
+    fLogLimitCmd->SetRange("N>=0");
+    fLogLimitCmd->SetToBeBroadcasted(false);
+    fLogLimitCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+    fRecoDirectory = new G4UIdirectory("/eic/reco/");
+    fRecoDirectory->SetGuidance("Track reconstruction in the FVTX and inner tracker disks.");
+
+    fRecoEnableCmd = new G4UIcmdWithABool("/eic/reco/enable", this);
+    fRecoEnableCmd->SetGuidance("Reconstruct tracks from the hits after each event, bending in the /eic/field/ solenoid");
+    fRecoEnableCmd->SetGuidance("(histograms in output.root).");
+    fRecoEnableCmd->SetParameterName("enable", true);
+    fRecoEnableCmd->SetDefaultValue(true);
+    fRecoEnableCmd->SetToBeBroadcasted(false);
+    fRecoEnableCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+    fRecoSeedWindowCmd = new G4UIcmdWithADouble("/eic/reco/seedWindow", this);
+    fRecoSeedWindowCmd->SetGuidance("Smallest search radius of a seed second hit [cm].");
+    fRecoSeedWindowCmd->SetParameterName("w", false);
+    fRecoSeedWindowCmd->SetRange("w>0");
+    fRecoSeedWindowCmd->SetToBeBroadcasted(false);
+    fRecoSeedWindowCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+    fRecoWindowCmd = new G4UIcmdWithADouble("/eic/reco/window", this);
+    fRecoWindowCmd->SetGuidance("Smallest search radius around an extrapolated track [cm].");
+    fRecoWindowCmd->SetParameterName("w", false);
+    fRecoWindowCmd->SetRange("w>0");
+    fRecoWindowCmd->SetToBeBroadcasted(false);
+    fRecoWindowCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+    fRecoMinHitsCmd = new G4UIcmdWithAnInteger("/eic/reco/minHits", this);
+    fRecoMinHitsCmd->SetGuidance("Hits of a track, at least.");
+    fRecoMinHitsCmd->SetParameterName("N", false);
+    fRecoMinHitsCmd->SetRange("N>=3");
+    fRecoMinHitsCmd->SetToBeBroadcasted(false);
+    fRecoMinHitsCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+    fRecoMaxHolesCmd = new G4UIcmdWithAnInteger("/eic/reco/maxHoles", this);
+    fRecoMaxHolesCmd->SetGuidance("Layers crossed without a hit before a track stops.");
+    fRecoMaxHolesCmd->SetParameterName("N", false);
+    fRecoMaxHolesCmd->SetRange("N>=0");
+    fRecoMaxHolesCmd->SetToBeBroadcasted(false);
+    fRecoMaxHolesCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+    fRecoMaxChi2Cmd = new G4UIcmdWithADouble("/eic/reco/maxChi2", this);
+    fRecoMaxChi2Cmd->SetGuidance("Largest chi2 per degree of freedom of a track.");
+    fRecoMaxChi2Cmd->SetParameterName("chi2", false);
+    fRecoMaxChi2Cmd->SetRange("chi2>0");
+    fRecoMaxChi2Cmd->SetToBeBroadcasted(false);
+    fRecoMaxChi2Cmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+}
+
+TrackOutputMessenger::~TrackOutputMessenger()
+{
+    delete fSchemaCmd;
+    delete fAutoSaveEventsCmd;
+    delete fAutoSaveBytesCmd;
+    delete fBasketSizeCmd;
+    delete fCompressionCmd;
+    delete fAsyncCmd;
+    delete fBatchEventsCmd;
+    delete fBuffersCmd;
+    delete fQueueSizeCmd;
+    delete fDirectory;
+    delete fLogLevelCmd;
+    delete fLogLimitCmd;
+    delete fLogDirectory;
+    delete fRecoEnableCmd;
+    delete fRecoSeedWindowCmd;
+    delete fRecoWindowCmd;
+    delete fRecoMinHitsCmd;
+    delete fRecoMaxHolesCmd;
+    delete fRecoMaxChi2Cmd;
+    delete fRecoDirectory;
+}
+
+void TrackOutputMessenger::SetNewValue(G4UIcommand* command, G4String newValue)
+{
+    auto& cfg = TrackOutput::GetSettings();
+
+    if (command == fSchemaCmd) {
+        cfg.schema = newValue == "legacy" ? TrackOutput::Schema::Legacy
+                   : newValue == "digits" ? TrackOutput::Schema::Digits
+                                          : TrackOutput::Schema::Compact;
+    } else if (command == fAutoSaveEventsCmd) {
+        cfg.autoSaveEvents = fAutoSaveEventsCmd->GetNewIntValue(newValue);
+    } else if (command == fAutoSaveBytesCmd) {
+        cfg.autoSaveBytes = fAutoSaveBytesCmd->GetNewDoubleValue(newValue);
+    } else if (command == fBasketSizeCmd) {
+        cfg.basketSize = fBasketSizeCmd->GetNewIntValue(newValue);
+    } else if (command == fCompressionCmd) {
+        std::istringstream is(newValue);
+        G4String algorithm;
+        G4int level = 4;
+        is >> algorithm >> level;
+        cfg.compression = TrackOutput::CompressionSettings(algorithm, level);
+        G4cout << "[OUTPUT] compression " << algorithm << " level " << level
+               << " (settings " << cfg.compression << ")" << G4endl;
+    } else if (command == fAsyncCmd) {
+        cfg.async = fAsyncCmd->GetNewBoolValue(newValue);
+    } else if (command == fBatchEventsCmd) {
+        cfg.batchEvents = fBatchEventsCmd->GetNewIntValue(newValue);
+    } else if (command == fBuffersCmd) {
+        cfg.buffers = fBuffersCmd->GetNewIntValue(newValue);
+    } else if (command == fQueueSizeCmd) {
+        cfg.queueSize = fQueueSizeCmd->GetNewIntValue(newValue);
+    } else if (command == fLogLevelCmd) {
+        Log::GetSettings().level = newValue == "debug"   ? Log::Level::Debug
+                                 : newValue == "warning" ? Log::Level::Warning
+                                 : newValue == "error"   ? Log::Level::Error
+                                                         : Log::Level::Info;
+    } else if (command == fLogLimitCmd) {
+        Log::GetSettings().limit = fLogLimitCmd->GetNewIntValue(newValue);
+    } else if (command == fRecoEnableCmd) {
+        TrackFinder::GetSettings().enabled = fRecoEnableCmd->GetNewBoolValue(newValue);
+    } else if (command == fRecoSeedWindowCmd) {
+        TrackFinder::GetSettings().config.seedWindow = fRecoSeedWindowCmd->GetNewDoubleValue(newValue);
+    } else if (command == fRecoWindowCmd) {
+        TrackFinder::GetSettings().config.window = fRecoWindowCmd->GetNewDoubleValue(newValue);
+    } else if (command == fRecoMinHitsCmd) {
+        TrackFinder::GetSettings().config.minHits = fRecoMinHitsCmd->GetNewIntValue(newValue);
+    } else if (command == fRecoMaxHolesCmd) {
+        TrackFinder::GetSettings().config.maxHoles = fRecoMaxHolesCmd->GetNewIntValue(newValue);
+    } else if (command == fRecoMaxChi2Cmd) {
+        TrackFinder::GetSettings().config.maxChi2 = fRecoMaxChi2Cmd->GetNewDoubleValue(newValue);
+    }
+}
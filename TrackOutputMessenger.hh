@@ -0,0 +1,47 @@
+#ifndef TRACKOUTPUTMESSENGER_HH
+#define TRACKOUTPUTMESSENGER_HH
+
+#include "G4UImessenger.hh"
+
+class G4UIdirectory;
+class G4UIcommand;
+class G4UIcmdWithAnInteger;
+class G4UIcmdWithADouble;
+class G4UIcmdWithABool;
+class G4UIcmdWithAString;
+
+// /eic/output/, /eic/log/ and /eic/reco/ commands, applied on the master
+// to TrackOutput::Settings, Log::Settings and TrackFinder::Settings
+class TrackOutputMessenger : public G4UImessenger {
+public:
+    TrackOutputMessenger();
+    virtual ~TrackOutputMessenger();
+
+    virtual void SetNewValue(G4UIcommand* command, G4String newValue) override;
+
+private:
+    G4UIdirectory*        fDirectory;
+    G4UIcmdWithAString*   fSchemaCmd;
+    G4UIcmdWithAnInteger* fAutoSaveEventsCmd;
+    G4UIcmdWithADouble*   fAutoSaveBytesCmd;
+    G4UIcmdWithAnInteger* fBasketSizeCmd;
+    G4UIcommand*          fCompressionCmd;
+    G4UIcmdWithABool*     fAsyncCmd;
+    G4UIcmdWithAnInteger* fBatchEventsCmd;
+    G4UIcmdWithAnInteger* fBuffersCmd;
+    G4UIcmdWithAnInteger* fQueueSizeCmd;
+
+    G4UIdirectory*        fLogDirectory;
+    G4UIcmdWithAString*   fLogLevelCmd;
+    G4UIcmdWithAnInteger* fLogLimitCmd;
+
+    G4UIdirectory*        fRecoDirectory;
+    G4UIcmdWithABool*     fRecoEnableCmd;
+    G4UIcmdWithADouble*   fRecoSeedWindowCmd;
+    G4UIcmdWithADouble*   fRecoWindowCmd;
+    G4UIcmdWithAnInteger* fRecoMinHitsCmd;
+    G4UIcmdWithAnInteger* fRecoMaxHolesCmd;
+    G4UIcmdWithADouble*   fRecoMaxChi2Cmd;
+};
+
+#endif
@@ -0,0 +1,123 @@
+// Field map evaluations per second: FieldGrid (r,z) and (x,y,z) grids of a
+// solenoid-like field, points along tracks (consecutive steps, as Geant4
+// asks for them) and at random.
+//
+// Usage: fieldMapBench [map.txt] [calls]
+//   (without a file, synthetic 2D and 3D grids over the solenoid volume)
+
+#include "FieldGrid.hh"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct Point { double x, y, z; };
+
+// Uniform 1.7 T in the bore, falling off beyond the coil ends
+double SolenoidBz(double r, double z) {
+    const double halfLength = 1920., rCoil = 1420.;
+    const double fall = std::exp(-std::pow(std::max(0., std::abs(z) - halfLength) / 500., 2));
+    return r < rCoil ? 1.7 * fall : -0.2 * fall;
+}
+
+FieldGrid MakeGrid(FieldGrid::Kind kind) {
+    FieldGrid grid;
+    if (kind == FieldGrid::Kind::RZ) {
+        const int n[3] = {181, 601, 1};                      // 10 mm
+        const double lo[3] = {0., -3000., 0.}, hi[3] = {1800., 3000., 0.};
+        grid.Init(kind, n, lo, hi);
+        for (int i = 0; i < n[0]; ++i) {
+            for (int k = 0; k < n[1]; ++k) {
+                float* b = grid.Node(i, k);
+                b[0] = 0.f;
+                b[1] = float(SolenoidBz(10. * i, -3000. + 10. * k));
+            }
+        }
+    } else {
+        const int n[3] = {91, 91, 301};                      // 40 mm x 40 mm x 20 mm
+        const double lo[3] = {-1800., -1800., -3000.}, hi[3] = {1800., 1800., 3000.};
+        grid.Init(kind, n, lo, hi);
+        for (int i = 0; i < n[0]; ++i) {
+            for (int j = 0; j < n[1]; ++j) {
+                for (int k = 0; k < n[2]; ++k) {
+                    const double x = -1800. + 40. * i, y = -1800. + 40. * j;
+                    float* b = grid.Node(i, j, k);
+                    b[0] = b[1] = 0.f;
+                    b[2] = float(SolenoidBz(std::sqrt(x * x + y * y), -3000. + 20. * k));
+                }
+            }
+        }
+    }
+    return grid;
+}
+
+// Straight tracks from the origin, 5 mm steps (a few per grid cell)
+std::vector<Point> TrackPoints(std::size_t n) {
+    std::mt19937 rng(12345);
+    std::uniform_real_distribution<double> u(-1., 1.);
+    std::vector<Point> points;
+    points.reserve(n);
+    while (points.size() < n) {
+        double dx = u(rng), dy = u(rng), dz = u(rng);
+        const double norm = std::sqrt(dx * dx + dy * dy + dz * dz);
+        dx /= norm; dy /= norm; dz /= norm;
+        for (double s = 0.; s < 1800. && points.size() < n; s += 5.) {
+            points.push_back({s * dx, s * dy, s * dz});
+        }
+    }
+    return points;
+}
+
+std::vector<Point> RandomPoints(std::size_t n) {
+    std::mt19937 rng(54321);
+    std::uniform_real_distribution<double> r(-1700., 1700.), z(-2900., 2900.);
+    std::vector<Point> points(n);
+    for (auto& p : points) p = {r(rng), r(rng), z(rng)};
+    return points;
+}
+
+double Run(const FieldGrid& grid, const std::vector<Point>& points, double& checksum) {
+    double b[3];
+    checksum = 0.;
+    const auto start = std::chrono::steady_clock::now();
+    for (const auto& p : points) {
+        if (grid.Evaluate(p.x, p.y, p.z, b)) checksum += b[2];
+    }
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return points.size() / seconds;
+}
+
+void Report(const char* name, const FieldGrid& grid, std::size_t calls) {
+    const auto tracks = TrackPoints(calls);
+    const auto random = RandomPoints(calls);
+    double c1, c2;
+    const double tracksRate = Run(grid, tracks, c1);
+    const double randomRate = Run(grid, random, c2);
+    std::printf("%-6s tracks : %8.2f M calls/s (checksum %g)\n", name, tracksRate / 1e6, c1);
+    std::printf("%-6s random : %8.2f M calls/s (checksum %g)\n", name, randomRate / 1e6, c2);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const std::size_t calls = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 5000000;
+    if (argc > 1) {
+        FieldGrid grid;
+        std::string error;
+        if (!grid.Load(argv[1], error)) {
+            std::fprintf(stderr, "%s\n", error.c_str());
+            return 1;
+        }
+        Report("map", grid, calls);
+        return 0;
+    }
+    Report("rz", MakeGrid(FieldGrid::Kind::RZ), calls);
+    Report("xyz", MakeGrid(FieldGrid::Kind::XYZ), calls);
+    return 0;
+}
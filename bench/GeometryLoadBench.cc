@@ -0,0 +1,80 @@
+// Geometry description loading: text expansion + parsing + validation
+// against the binary cache, for the detector description and for a large
+// synthetic variant (a finely segmented tracker). The Geant4 side of
+// Construct is not included.
+//
+// Usage: geometryLoadBench [description.geo] [repeats]
+//   (default geometry/ft-eic.geo, 200 repeats)
+
+#include "GeometryDescription.hh"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+
+namespace {
+
+const char* kCacheDir = "/tmp/geometryLoadBench";
+
+double Seconds(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// World, one envelope and layers x sectors tube segments
+std::string MakeVariant(int layers, int sectors) {
+    const std::string fileName = std::string(kCacheDir) + "/variant.geo";
+    std::ofstream out(fileName);
+    out << "material ArCO2 0.0018 G4_Ar 0.7 G4_CARBON_DIOXIDE 0.3 gas\n"
+        << "box World - G4_AIR 1000 1000 1000\n"
+        << "tube Tracker World G4_AIR 10 200 300 envelope\n";
+    for (int l = 0; l < layers; ++l) {
+        const double r = 20. + 1.5 * l;
+        for (int s = 0; s < sectors; ++s) {
+            out << "tube L" << l << "S" << s << " Tracker ArCO2 " << r << " " << r + 1. << " 2.5"
+                << " z=" << -290. + 5.5 * s << " copy=" << s << " sd region=Tracking\n";
+        }
+    }
+    return fileName;
+}
+
+void Report(const std::string& fileName, int repeats) {
+    GeometryDescription description;
+    std::string error;
+    bool fromCache;
+
+    double parse = 0., cached = 0.;
+    for (int i = 0; i < repeats; ++i) {
+        auto start = std::chrono::steady_clock::now();
+        if (!description.Load(fileName, "", error, fromCache)) {
+            std::fprintf(stderr, "%s\n", error.c_str());
+            std::exit(1);
+        }
+        parse += Seconds(start);
+
+        description.Load(fileName, kCacheDir, error, fromCache);   // first one writes the cache
+        start = std::chrono::steady_clock::now();
+        description.Load(fileName, kCacheDir, error, fromCache);
+        cached += Seconds(start);
+        if (!fromCache) {
+            std::fprintf(stderr, "cache not used for %s\n", fileName.c_str());
+            std::exit(1);
+        }
+    }
+    std::printf("%-40s %6zu volumes : parse %9.3f ms, cache %9.3f ms (x%.1f)\n",
+                fileName.c_str(), description.volumes.size(),
+                1e3 * parse / repeats, 1e3 * cached / repeats, parse / cached);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const std::string fileName = argc > 1 ? argv[1] : "geometry/ft-eic.geo";
+    const int repeats = argc > 2 ? std::atoi(argv[2]) : 200;
+    std::system((std::string("mkdir -p ") + kCacheDir).c_str());
+
+    Report(fileName, repeats);
+    Report(MakeVariant(40, 100), repeats / 20 > 0 ? repeats / 20 : 1);
+    return 0;
+}
@@ -0,0 +1,175 @@
+// Replays sensitive-detector steps through the old std::map<G4int, TrackInfo>
+// accumulation and through HitStore, end-of-event muon selection included.
+//
+// Usage: hitStoreBench [steps.txt] [repeat]
+//   steps.txt: one step per line "eventID trackID pdg edep x y z px py pz e"
+//   (without a file a shower-like sequence is generated)
+
+#include "HitStore.hh"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct Step {
+    int32_t eventID, trackID, pdg;
+    double  edep, x, y, z, px, py, pz, e;
+};
+
+std::vector<Step> LoadSteps(const char* fileName) {
+    std::vector<Step> steps;
+    std::ifstream in(fileName);
+    Step s;
+    while (in >> s.eventID >> s.trackID >> s.pdg >> s.edep
+              >> s.x >> s.y >> s.z >> s.px >> s.py >> s.pz >> s.e) {
+        steps.push_back(s);
+    }
+    return steps;
+}
+
+// Two primary muons plus an electromagnetic shower in the EMCal shells:
+// a few hundred secondaries, a handful of steps each, stack (LIFO) order.
+std::vector<Step> GenerateSteps(int nEvents) {
+    std::mt19937 rng(12345);
+    std::geometric_distribution<int> stepsPerTrack(0.25);
+    std::uniform_int_distribution<int> nSecondaries(200, 600);
+    std::uniform_real_distribution<double> u(0., 1.);
+    const int32_t codes[] = {11, -11, 22, 22, 22, 11, 2112, 211};
+
+    std::vector<Step> steps;
+    for (int ev = 0; ev < nEvents; ++ev) {
+        const int nTracks = 2 + nSecondaries(rng);
+        for (int32_t id = 1; id <= nTracks; ++id) {
+            const int32_t pdg = id == 1 ? -13 : id == 2 ? 13 : codes[rng() % 8];
+            const int n = 1 + stepsPerTrack(rng) + (id <= 2 ? 20 : 0);
+            for (int i = 0; i < n; ++i) {
+                steps.push_back({ev, id, pdg, u(rng), u(rng), u(rng), u(rng),
+                                 u(rng), u(rng), u(rng), 1. + u(rng)});
+            }
+        }
+    }
+    return steps;
+}
+
+std::string ParticleName(int32_t pdg) {
+    switch (pdg) {
+        case  13: return "mu-";
+        case -13: return "mu+";
+        case  11: return "e-";
+        case -11: return "e+";
+        case  22: return "gamma";
+        case 2112: return "neutron";
+        case 211: return "pi+";
+        default: return "unknown";
+    }
+}
+
+// The previous EICSensitiveDetector accumulation
+struct MapStore {
+    struct TrackInfo {
+        int32_t trackID;
+        std::string particleName;
+        double x, y, z, energyDep, kineticEnergy, px, py, pz, e;
+    };
+    std::map<int32_t, TrackInfo> trackInfos;
+
+    void Add(const Step& s) {
+        auto name = ParticleName(s.pdg);   // G4String copy per step
+        auto it = trackInfos.find(s.trackID);
+        if (it == trackInfos.end()) {
+            trackInfos[s.trackID] = {s.trackID, name, s.x, s.y, s.z, s.edep, s.e, s.px, s.py, s.pz, s.e};
+        } else {
+            it->second.energyDep += s.edep;
+        }
+    }
+    double EndOfEvent() {
+        std::vector<const TrackInfo*> plus, minus;
+        for (const auto& [id, info] : trackInfos) {
+            if (info.particleName == "mu+") plus.push_back(&info);
+            else if (info.particleName == "mu-") minus.push_back(&info);
+        }
+        double sum = 0.;
+        for (auto p : plus) for (auto m : minus) sum += p->energyDep + m->energyDep;
+        trackInfos.clear();
+        return sum;
+    }
+};
+
+struct FlatStore {
+    HitStore hits;
+    std::vector<const TrackHit*> plus, minus;
+
+    void Add(const Step& s) {
+        if (auto hit = hits.Find(s.trackID)) {
+            hit->energyDep += s.edep;
+            return;
+        }
+        auto& hit = hits.Insert(s.trackID);
+        hit.pdg = s.pdg;
+        hit.x = s.x; hit.y = s.y; hit.z = s.z;
+        hit.energyDep = s.edep;
+        hit.kineticEnergy = s.e;
+        hit.px = s.px; hit.py = s.py; hit.pz = s.pz; hit.e = s.e;
+    }
+    double EndOfEvent() {
+        plus.clear();
+        minus.clear();
+        for (const auto& hit : hits.Hits()) {
+            if (hit.pdg == -13) plus.push_back(&hit);
+            else if (hit.pdg == 13) minus.push_back(&hit);
+        }
+        double sum = 0.;
+        for (auto p : plus) for (auto m : minus) sum += p->energyDep + m->energyDep;
+        hits.Clear();
+        return sum;
+    }
+};
+
+template <class Store>
+double Replay(const std::vector<Step>& steps, int repeat, double& checksum) {
+    Store store;
+    checksum = 0.;
+    const auto start = std::chrono::steady_clock::now();
+    for (int r = 0; r < repeat; ++r) {
+        int32_t current = steps.empty() ? 0 : steps.front().eventID;
+        for (const auto& s : steps) {
+            if (s.eventID != current) {
+                checksum += store.EndOfEvent();
+                current = s.eventID;
+            }
+            store.Add(s);
+        }
+        checksum += store.EndOfEvent();
+    }
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const auto steps = argc > 1 ? LoadSteps(argv[1]) : GenerateSteps(2000);
+    const int repeat = argc > 2 ? std::atoi(argv[2]) : 5;
+    if (steps.empty()) {
+        std::fprintf(stderr, "No steps to replay\n");
+        return 1;
+    }
+
+    double sumMap = 0., sumFlat = 0.;
+    const double tMap  = Replay<MapStore>(steps, repeat, sumMap);
+    const double tFlat = Replay<FlatStore>(steps, repeat, sumFlat);
+
+    const double nSteps = double(steps.size()) * repeat;
+    std::printf("steps replayed : %.0f\n", nSteps);
+    std::printf("std::map       : %8.2f ns/step\n", 1e9 * tMap / nSteps);
+    std::printf("HitStore       : %8.2f ns/step\n", 1e9 * tFlat / nSteps);
+    std::printf("speedup        : %8.2fx\n", tMap / tFlat);
+    std::printf("checksums      : %s\n", sumMap == sumFlat ? "match" : "MISMATCH");
+    return sumMap == sumFlat ? 0 : 2;
+}
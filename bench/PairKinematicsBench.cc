@@ -0,0 +1,204 @@
+// Checks PairKinematics::Compute against the per-pair TLorentzVector code that
+// used to live in EICSensitiveDetector::EndOfEvent, then times both on
+// high muon multiplicity events (open-charm like: several mu+ and mu- each).
+//
+// Built with -DWITH_ROOT the reference uses ROOT's TLorentzVector, otherwise
+// a transcription of the same operations.
+//
+// Usage: pairKinematicsBench [nEvents] [maxMuonsPerSign]
+
+#include "PairKinematics.hh"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#ifdef WITH_ROOT
+#include "TLorentzVector.h"
+#endif
+
+namespace {
+
+struct Muon { double px, py, pz, e; };
+struct Event { std::vector<Muon> plus, minus; };
+struct Result { double theta, phi, xF, pT, mass, y, x1, x2; };
+
+std::vector<Event> GenerateEvents(int nEvents, int maxPerSign) {
+    std::mt19937 rng(4242);
+    std::uniform_int_distribution<int> mult(1, maxPerSign);
+    std::normal_distribution<double> pt(0., 0.8);
+    std::uniform_real_distribution<double> pz(2., 60.);
+    const double mMu = 0.1056583755;
+
+    auto muon = [&]() {
+        Muon m{pt(rng), pt(rng), pz(rng), 0.};
+        m.e = std::sqrt(m.px * m.px + m.py * m.py + m.pz * m.pz + mMu * mMu);
+        return m;
+    };
+
+    std::vector<Event> events(nEvents);
+    for (auto& ev : events) {
+        ev.plus.resize(mult(rng));
+        ev.minus.resize(mult(rng));
+        for (auto& m : ev.plus) m = muon();
+        for (auto& m : ev.minus) m = muon();
+    }
+    return events;
+}
+
+#ifdef WITH_ROOT
+Result Reference(const Muon& mup, const Muon& mum, double E_beam) {
+    double sqrt_s = sqrt(2.0 * E_beam * 0.938);
+    double s = sqrt_s * sqrt_s;
+
+    TLorentzVector p_pair(mup.px + mum.px, mup.py + mum.py, mup.pz + mum.pz, mup.e + mum.e);
+
+    Result r;
+    r.theta = p_pair.Theta();
+    r.phi   = p_pair.Phi();
+
+    double E_p = E_beam;
+    double E_t = 0.938;
+    double beta_cm = (E_p - E_t) / (E_p + E_t);
+    TVector3 boost_vector(0, 0, -beta_cm);
+
+    TLorentzVector p_pair_cm = p_pair;
+    p_pair_cm.Boost(boost_vector);
+
+    r.xF = 2.0 * p_pair_cm.Pz() / sqrt_s;
+    r.pT = p_pair_cm.Pt();
+    r.mass = p_pair_cm.M();
+    r.y = p_pair_cm.Rapidity();
+
+    double delta = std::sqrt(r.xF * r.xF + 4.0 * r.mass * r.mass / s);
+    r.x1 = 0.5 * (r.xF + delta);
+    r.x2 = 0.5 * (-r.xF + delta);
+    return r;
+}
+#else
+// TLorentzVector::Boost/Theta/Phi/Pt/M/Rapidity, spelled out
+Result Reference(const Muon& mup, const Muon& mum, double E_beam) {
+    double sqrt_s = sqrt(2.0 * E_beam * 0.938);
+    double s = sqrt_s * sqrt_s;
+
+    double x = mup.px + mum.px, y = mup.py + mum.py, z = mup.pz + mum.pz, t = mup.e + mum.e;
+
+    Result r;
+    const double perp = std::sqrt(x * x + y * y);
+    r.theta = (x == 0 && y == 0 && z == 0) ? 0 : std::atan2(perp, z);
+    r.phi   = (x == 0 && y == 0) ? 0 : std::atan2(y, x);
+
+    double E_p = E_beam;
+    double E_t = 0.938;
+    double beta_cm = (E_p - E_t) / (E_p + E_t);
+    const double bx = 0, by = 0, bz = -beta_cm;
+    const double b2 = bx * bx + by * by + bz * bz;
+    const double gamma = 1.0 / std::sqrt(1.0 - b2);
+    const double bp = bx * x + by * y + bz * z;
+    const double gamma2 = b2 > 0 ? (gamma - 1.0) / b2 : 0.0;
+    x = x + gamma2 * bp * bx + gamma * bx * t;
+    y = y + gamma2 * bp * by + gamma * by * t;
+    z = z + gamma2 * bp * bz + gamma * bz * t;
+    t = gamma * (t + bp);
+
+    r.xF = 2.0 * z / sqrt_s;
+    r.pT = std::sqrt(x * x + y * y);
+    const double mm = t * t - (x * x + y * y + z * z);
+    r.mass = mm < 0.0 ? -std::sqrt(-mm) : std::sqrt(mm);
+    r.y = 0.5 * std::log((t + z) / (t - z));
+
+    double delta = std::sqrt(r.xF * r.xF + 4.0 * r.mass * r.mass / s);
+    r.x1 = 0.5 * (r.xF + delta);
+    r.x2 = 0.5 * (-r.xF + delta);
+    return r;
+}
+#endif
+
+double RelDiff(double a, double b) {
+    return std::fabs(a - b) / std::max(1.0, std::max(std::fabs(a), std::fabs(b)));
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const int nEvents = argc > 1 ? std::atoi(argv[1]) : 200000;
+    const int maxPerSign = argc > 2 ? std::atoi(argv[2]) : 6;
+    const double E_beam = 100.0;
+
+    const auto events = GenerateEvents(nEvents, maxPerSign);
+    const auto beam = PairKinematics::BeamConstants::FixedTarget(E_beam, 0.938);
+
+    PairKinematics::MuonSoA plus, minus;
+    PairKinematics::PairSoA pairs;
+
+    // --- Validation ---
+    double maxDiff = 0.;
+    std::size_t nPairs = 0;
+    for (const auto& ev : events) {
+        plus.Clear();
+        minus.Clear();
+        for (std::size_t i = 0; i < ev.plus.size(); ++i)
+            plus.Add(i, ev.plus[i].px, ev.plus[i].py, ev.plus[i].pz, ev.plus[i].e);
+        for (std::size_t i = 0; i < ev.minus.size(); ++i)
+            minus.Add(i, ev.minus[i].px, ev.minus[i].py, ev.minus[i].pz, ev.minus[i].e);
+        PairKinematics::Compute(beam, plus, minus, pairs);
+
+        for (std::size_t k = 0; k < pairs.Size(); ++k, ++nPairs) {
+            const auto ref = Reference(ev.plus[pairs.iPlus[k]], ev.minus[pairs.iMinus[k]], E_beam);
+            for (double d : {RelDiff(ref.theta, pairs.theta[k]), RelDiff(ref.phi, pairs.phi[k]),
+                             RelDiff(ref.xF, pairs.xF[k]), RelDiff(ref.pT, pairs.pT[k]),
+                             RelDiff(ref.mass, pairs.mass[k]), RelDiff(ref.y, pairs.y[k]),
+                             RelDiff(ref.x1, pairs.x1[k]), RelDiff(ref.x2, pairs.x2[k])}) {
+                maxDiff = std::max(maxDiff, d);
+            }
+        }
+    }
+
+    // --- Timing ---
+    using Clock = std::chrono::steady_clock;
+    double sink = 0.;
+
+    auto start = Clock::now();
+    for (const auto& ev : events) {
+        for (const auto& mup : ev.plus) {
+            for (const auto& mum : ev.minus) {
+                const auto r = Reference(mup, mum, E_beam);
+                sink += r.theta + r.phi + r.xF + r.pT + r.mass + r.y + r.x1 + r.x2;
+            }
+        }
+    }
+    const double tRef = std::chrono::duration<double>(Clock::now() - start).count();
+
+    start = Clock::now();
+    for (const auto& ev : events) {
+        plus.Clear();
+        minus.Clear();
+        for (std::size_t i = 0; i < ev.plus.size(); ++i)
+            plus.Add(i, ev.plus[i].px, ev.plus[i].py, ev.plus[i].pz, ev.plus[i].e);
+        for (std::size_t i = 0; i < ev.minus.size(); ++i)
+            minus.Add(i, ev.minus[i].px, ev.minus[i].py, ev.minus[i].pz, ev.minus[i].e);
+        PairKinematics::Compute(beam, plus, minus, pairs);
+        for (std::size_t k = 0; k < pairs.Size(); ++k) {
+            sink += pairs.theta[k] + pairs.phi[k] + pairs.xF[k] + pairs.pT[k]
+                  + pairs.mass[k] + pairs.y[k] + pairs.x1[k] + pairs.x2[k];
+        }
+    }
+    const double tKernel = std::chrono::duration<double>(Clock::now() - start).count();
+
+    std::printf("events / pairs       : %d / %zu (<= %d muons per sign)\n", nEvents, nPairs, maxPerSign);
+#ifdef WITH_ROOT
+    std::printf("reference            : TLorentzVector\n");
+#else
+    std::printf("reference            : TLorentzVector transcription\n");
+#endif
+    std::printf("max relative diff    : %.3g\n", maxDiff);
+    std::printf("per-pair reference   : %8.2f ns/pair\n", 1e9 * tRef / nPairs);
+    std::printf("batch kernel         : %8.2f ns/pair\n", 1e9 * tKernel / nPairs);
+    std::printf("speedup              : %8.2fx   (checksum %g)\n", tRef / tKernel, sink);
+
+    return maxDiff < 1e-9 ? 0 : 2;
+}
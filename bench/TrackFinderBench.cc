@@ -0,0 +1,180 @@
+// TrackFinder throughput against hit multiplicity, on the forward disks of
+// the detector description: tracks from the target, helices in a uniform
+// Bz past the coil entry (straight without field), hits smeared by the
+// layer resolution, plus noise hits. Each multiplicity runs with the
+// (r, phi) grids, with a linear scan of the layer for every window, and
+// with the default choice between them (scanHits), and reports the
+// efficiency and fake rate of the default run. The runs may differ by a
+// few tracks: seeds claim their hits in cell order.
+//
+// Usage: trackFinderBench [description.geo] [tracksPerMultiplicity] [Bz]
+//   (default geometry/ft-eic.geo, 20000, 0 T; the simulation default is 1.7)
+
+#include "TrackFinder.hh"
+#include "GeometryDescription.hh"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct Hit {
+    int     layer;
+    double  x, y, z;
+    int32_t id;   // generated track, -1 for noise
+};
+
+struct Event {
+    std::vector<Hit> hits;
+    std::vector<int> reconstructable;   // tracks with minHits layers hit
+};
+
+// nTracks tracks per event from the target, theta in [0.01, 0.25] rad, 1/p
+// uniform up to 1 / minMomentum, either charge; noise: as many hits per
+// layer as tracks
+std::vector<Event> GenerateEvents(const std::vector<TrackFinder::Layer>& layers,
+                                  const TrackFinder::Config& config, int nEvents, int nTracks) {
+    const double vertexZ = config.vertexZ;
+    std::mt19937 rng(12345);
+    std::uniform_real_distribution<double> u(0., 1.);
+    std::normal_distribution<double> gauss(0., 1.);
+
+    std::vector<Event> events(nEvents);
+    for (auto& event : events) {
+        for (int t = 0; t < nTracks; ++t) {
+            const double theta = 0.01 + 0.24 * u(rng), phi = 2. * M_PI * u(rng);
+            const double x0 = 0.05 * gauss(rng), y0 = 0.05 * gauss(rng);
+            const double slope = std::tan(theta), tx = slope * std::cos(phi), ty = slope * std::sin(phi);
+            // Turning angle per cm of z past the coil entry: 0.003 q Bz / pz
+            const double p = config.minMomentum / (1. - u(rng));
+            const double k = (u(rng) < 0.5 ? -0.003 : 0.003) * config.fieldBz * std::sqrt(1. + slope * slope) / p;
+            int nHits = 0;
+            for (std::size_t l = 0; l < layers.size(); ++l) {
+                const auto& layer = layers[l];
+                double x = x0 + tx * (layer.z - vertexZ), y = y0 + ty * (layer.z - vertexZ);
+                if (k != 0. && layer.z > config.fieldZ) {
+                    const double straight = config.fieldZ - vertexZ, psi = k * (layer.z - config.fieldZ);
+                    x = x0 + tx * straight + slope / k * (std::sin(phi + psi) - std::sin(phi));
+                    y = y0 + ty * straight - slope / k * (std::cos(phi + psi) - std::cos(phi));
+                }
+                const double r = std::sqrt(x * x + y * y);
+                if (r < layer.rMin || r > layer.rMax) continue;
+                event.hits.push_back({int(l), x + layer.sigma * gauss(rng), y + layer.sigma * gauss(rng),
+                                      layer.z, t});
+                ++nHits;
+            }
+            if (nHits >= config.minHits) event.reconstructable.push_back(t);
+        }
+        for (std::size_t l = 0; l < layers.size(); ++l) {
+            const auto& layer = layers[l];
+            for (int n = 0; n < nTracks; ++n) {
+                // Uniform in the disk area
+                const double r = std::sqrt(layer.rMin * layer.rMin
+                                           + u(rng) * (layer.rMax * layer.rMax - layer.rMin * layer.rMin));
+                const double phi = 2. * M_PI * u(rng);
+                event.hits.push_back({int(l), r * std::cos(phi), r * std::sin(phi), layer.z, -1});
+            }
+        }
+        // Detector order, not track order
+        std::shuffle(event.hits.begin(), event.hits.end(), rng);
+    }
+    return events;
+}
+
+struct Result {
+    double seconds = 0.;
+    long   found = 0, fakes = 0, tracks = 0;
+};
+
+Result Run(TrackFinder& finder, const TrackFinder::Config& config, int scanHits,
+           const std::vector<Event>& events) {
+    TrackFinder::Config run = config;
+    run.scanHits = scanHits;
+    Result result;
+    std::vector<char> matched;
+    for (const auto& event : events) {
+        const auto start = std::chrono::steady_clock::now();
+        finder.Clear();
+        for (const auto& h : event.hits) finder.AddHit(h.layer, h.x, h.y, h.z, h.id);
+        finder.Find(run);
+        result.seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        // A track finds the generated track that gives at least 3/4 of its hits
+        matched.assign(event.hits.size(), 0);
+        for (const auto& track : finder.Tracks()) {
+            uint32_t count = 0;
+            const int32_t id = finder.MajorityId(track, count);
+            if (id < 0 || 4 * count < 3 * track.nHits) {
+                ++result.fakes;
+            } else if (!matched[id]) {
+                matched[id] = 1;
+                if (std::count(event.reconstructable.begin(), event.reconstructable.end(), id)) ++result.found;
+            }
+        }
+        result.tracks += long(finder.Tracks().size());
+    }
+    return result;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const std::string fileName = argc > 1 ? argv[1] : "geometry/ft-eic.geo";
+    const int tracksPerPoint = argc > 2 ? std::atoi(argv[2]) : 20000;
+    const double bz = argc > 3 ? std::atof(argv[3]) : 0.;
+
+    GeometryDescription description;
+    std::string error;
+    bool fromCache = false;
+    if (!description.Load(fileName, "", error, fromCache)) {
+        std::fprintf(stderr, "%s: %s\n", fileName.c_str(), error.c_str());
+        return 1;
+    }
+    std::vector<const GeometryDescription::Volume*> volumes;
+    const auto layers = TrackFinder::DiskLayers(description, volumes);
+    if (layers.size() < 3) {
+        std::fprintf(stderr, "%s: %zu tracking layers, 3 needed\n", fileName.c_str(), layers.size());
+        return 1;
+    }
+    if (const auto* target = description.Find("Target")) {
+        double position[3];
+        description.WorldPosition(*target, position);
+        TrackFinder::GetSettings().config.vertexZ = position[2];
+    }
+    TrackFinder::GetSettings().config.fieldBz = bz;
+    const auto& config = TrackFinder::GetSettings().config;
+
+    TrackFinder finder(layers);
+
+    std::printf("%zu layers from %s, vertex at z = %.2f cm, Bz %.2f T from z = %.0f cm, scan below %d hits\n",
+                layers.size(), fileName.c_str(), config.vertexZ, config.fieldBz, config.fieldZ, config.scanHits);
+    std::printf("%8s %10s %12s %12s %12s %9s %8s %8s\n", "tracks", "hits/evt", "grid us/evt",
+                "scan us/evt", "auto us/evt", "speedup", "eff", "fakes");
+    for (int nTracks : {1, 2, 5, 10, 20, 50, 100, 200, 500}) {
+        const int nEvents = std::max(10, tracksPerPoint / nTracks);
+        const auto events = GenerateEvents(layers, config, nEvents, nTracks);
+        long hits = 0, reconstructable = 0;
+        for (const auto& e : events) {
+            hits += long(e.hits.size());
+            reconstructable += long(e.reconstructable.size());
+        }
+
+        const Result g = Run(finder, config, 0, events);
+        const Result s = Run(finder, config, std::numeric_limits<int>::max(), events);
+        const Result a = Run(finder, config, config.scanHits, events);
+        // speedup: default choice over the faster of the two
+        std::printf("%8d %10.1f %12.2f %12.2f %12.2f %8.2fx %7.1f%% %7.1f%%\n", nTracks,
+                    double(hits) / nEvents, 1e6 * g.seconds / nEvents, 1e6 * s.seconds / nEvents,
+                    1e6 * a.seconds / nEvents, std::min(g.seconds, s.seconds) / a.seconds,
+                    reconstructable ? 100. * a.found / reconstructable : 0.,
+                    a.tracks ? 100. * a.fakes / a.tracks : 0.);
+    }
+    return 0;
+}
@@ -0,0 +1,25 @@
+#!/bin/bash
+# Full vs parameterised calorimeter showers: s/event of each and
+# validation plots (fastsim_validation.pdf) from the same sample.
+# Usage: bench/fastsim_compare.sh [threads] [events]
+
+THREADS=${1:-$(nproc)}
+EVENTS=${2:-500}
+
+echo "showers,steps_per_event,s_per_event"
+for mode in full fast; do
+    cfg=$(mktemp --suffix=.mac)
+    if [ $mode = fast ]; then
+        cat bench/fastsim.mac > $cfg
+    fi
+    cat >> $cfg <<MAC
+/run/printProgress 0
+/run/beamOn $EVENTS
+MAC
+    out=$(./mySimulation -t $THREADS --seed 4242 $cfg 2>/dev/null)
+    rm -f $cfg
+    mv tracks_output.root tracks_$mode.root
+    # [RUN] S steps/event, T s/event (worker time), K secondaries killed
+    echo "$out" | grep "steps/event" | tail -1 | awk -v m=$mode '{ print m "," $2 "," $4 }'
+done
+root -l -b -q 'bench/fastsim_compare.C("tracks_full.root", "tracks_fast.root")'
@@ -0,0 +1,30 @@
+#!/bin/bash
+# Tracking overhead of the solenoid field: steps/event and s/event without
+# field, with the uniform field and with a map (if given), and the field
+# evaluations per event.
+# Usage: bench/field_compare.sh [threads] [events] [map.txt]
+
+THREADS=${1:-$(nproc)}
+EVENTS=${2:-500}
+MAP=$3
+
+MODES="none uniform"
+[ -n "$MAP" ] && MODES="$MODES map"
+
+echo "field,steps_per_event,s_per_event,evaluations_per_event"
+for mode in $MODES; do
+    cfg=$(mktemp --suffix=.mac)
+    [ $mode = map ] && echo "/eic/field/map $MAP" >> $cfg
+    cat >> $cfg <<MAC
+/eic/field/type $mode
+/run/printProgress 0
+/run/beamOn $EVENTS
+MAC
+    out=$(./mySimulation -t $THREADS $cfg 2>/dev/null)
+    rm -f $cfg
+    # [RUN] S steps/event, T s/event (worker time), K secondaries killed
+    # [FIELD] type: E evaluations/event, R per worker-second
+    run=$(echo "$out" | grep "steps/event" | tail -1 | awk '{ print $2 "," $4 }')
+    calls=$(echo "$out" | grep "^\[FIELD\]" | tail -1 | awk '{ print $3 }')
+    echo "$mode,$run,${calls:-0}"
+done
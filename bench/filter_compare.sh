@@ -0,0 +1,26 @@
+#!/bin/bash
+# Accepted dimuon events per CPU-second with the FVTX acceptance filter off
+# and on (same number of Geant4 events).
+# Usage: bench/filter_compare.sh [threads] [events] [minMuons]
+
+THREADS=${1:-$(nproc)}
+EVENTS=${2:-2000}
+MINMU=${3:-1}
+
+echo "filter,dimuon_events,per_cpu_s,efficiency"
+for enable in false true; do
+    cfg=$(mktemp --suffix=.mac)
+    cat > $cfg <<MAC
+/eic/gen/filter/enable $enable
+/eic/gen/filter/minMuons $MINMU
+/run/printProgress 0
+/run/beamOn $EVENTS
+MAC
+    out=$(./mySimulation -t $THREADS $cfg 2>/dev/null)
+    rm -f $cfg
+    # [GEN] D dimuon events, R per CPU-second
+    yield=$(echo "$out" | grep "dimuon events" | tail -1)
+    # [GEN] filter: T Pythia events, A accepted (efficiency E)
+    eff=$(echo "$out" | grep "^\[GEN\] filter" | tail -1 | sed 's/.*efficiency \([^)]*\)).*/\1/')
+    echo "$yield" | awk -v f=$enable -v e=${eff:-1} '{ print f "," $2 "," $5 "," e }'
+done
@@ -0,0 +1,31 @@
+#!/bin/bash
+# Navigation cost of the geometry layout: every subdetector in the world
+# (--flat-geometry) against the barrel / forward / backward envelopes.
+# Same volumes in both, so steps/event should agree; us/step is the
+# worker time per step. Starts with the overlap check of both layouts.
+# Usage: bench/geometry_compare.sh [threads] [events]
+
+THREADS=${1:-$(nproc)}
+EVENTS=${2:-500}
+
+for layout in flat envelopes; do
+    flag=""
+    [ $layout = flat ] && flag="--flat-geometry"
+    ./mySimulation $flag --check-overlaps 2>/dev/null | grep "^\[GEOM\]" | sed "s/^/$layout: /"
+done
+
+echo "layout,steps_per_event,s_per_event,us_per_step"
+for layout in flat envelopes; do
+    flag=""
+    [ $layout = flat ] && flag="--flat-geometry"
+    cfg=$(mktemp --suffix=.mac)
+    cat > $cfg <<MAC
+/run/printProgress 0
+/run/beamOn $EVENTS
+MAC
+    out=$(./mySimulation -t $THREADS $flag $cfg 2>/dev/null)
+    rm -f $cfg
+    # [RUN] S steps/event, T s/event (worker time), K secondaries killed
+    echo "$out" | grep "steps/event" | tail -1 \
+        | awk -v l=$layout '{ printf "%s,%s,%s,%.3f\n", l, $2, $4, ($2 > 0 ? 1e6 * $4 / $2 : 0) }'
+done
@@ -0,0 +1,23 @@
+#!/bin/bash
+# Steps/event and s/event with default cuts and with the passive-region
+# settings (coarse cuts in calorimeters and magnet, secondary killing).
+# Usage: bench/regions_compare.sh [threads] [events]
+
+THREADS=${1:-$(nproc)}
+EVENTS=${2:-500}
+
+echo "settings,steps_per_event,s_per_event,killed"
+for mode in default regions; do
+    cfg=$(mktemp --suffix=.mac)
+    if [ $mode = regions ]; then
+        cat bench/regions.mac > $cfg
+    fi
+    cat >> $cfg <<MAC
+/run/printProgress 0
+/run/beamOn $EVENTS
+MAC
+    out=$(./mySimulation -t $THREADS $cfg 2>/dev/null)
+    rm -f $cfg
+    # [RUN] S steps/event, T s/event (worker time), K secondaries killed
+    echo "$out" | grep "steps/event" | tail -1 | awk -v m=$mode '{ print m "," $2 "," $4 "," $8 }'
+done
@@ -0,0 +1,20 @@
+#!/bin/bash
+# Standard simulation benchmark: every workload (charmonium, opencharm,
+# singlemuon) at a fixed seed and event count, for 1, 2, 4, ... threads up
+# to max_threads. One JSON object per line (workload, threads, events/s,
+# steps/s, peak RSS, output bytes/event...) in the output file.
+# Usage: bench/run_suite.sh [max_threads] [output.jsonl] [workloads]
+
+MAXT=${1:-$(nproc)}
+OUT=${2:-bench_sim.jsonl}
+WORKLOADS=${3:-all}
+
+rm -f $OUT
+t=1
+while [ $t -le $MAXT ]; do
+    # One process per thread count: init_s and peak RSS are per process
+    ./mySimulation -t $t --bench $WORKLOADS --bench-out $OUT > /dev/null 2>&1 \
+        || echo "Error: benchmark failed with $t thread(s)" >&2
+    if [ $t -lt $MAXT ] && [ $((t * 2)) -gt $MAXT ]; then t=$MAXT; else t=$((t * 2)); fi
+done
+cat $OUT
@@ -0,0 +1,22 @@
+#!/bin/bash
+# File size and read time of the compact (Events), legacy (TrackTree) and
+# digits (Digits) output layouts, same sample.
+# Usage: bench/schema_compare.sh [threads] [macro]
+
+THREADS=${1:-$(nproc)}
+MACRO=${2:-bench/schema.mac}
+
+echo "schema,bytes,read_all_s,read_mass_s"
+for schema in compact legacy digits; do
+    cfg=$(mktemp --suffix=.mac)
+    echo "/eic/output/schema $schema" > $cfg
+    echo "/control/execute $MACRO" >> $cfg
+    ./mySimulation -t $THREADS $cfg > /dev/null 2>&1
+    rm -f $cfg
+
+    mv tracks_output.root tracks_$schema.root
+    bytes=$(stat -c %s tracks_$schema.root)
+    times=$(root -l -b -q "bench/schema_compare.C(\"tracks_$schema.root\")" 2>/dev/null | grep "^\[READ\]")
+    # [READ] all <s> mass <s>
+    echo "$times" | awk -v s=$schema -v b=$bytes '{ print s "," b "," $3 "," $5 }'
+done
@@ -0,0 +1,15 @@
+#!/bin/bash
+# Events/s as a function of the number of worker threads.
+# Usage: bench/thread_scaling.sh [max_threads] [macro]
+
+MAXT=${1:-$(nproc)}
+MACRO=${2:-bench/scaling.mac}
+
+echo "threads,events,seconds,events_per_s"
+t=1
+while [ $t -le $MAXT ]; do
+    line=$(./mySimulation -t $t $MACRO 2>/dev/null | grep "^\[RUN\]" | tail -1)
+    # [RUN] N events, T thread(s), S s -> R events/s
+    echo "$line" | awk -v t=$t '{ print t "," $2 "," $6 "," $9 }'
+    if [ $t -lt $MAXT ] && [ $((t * 2)) -gt $MAXT ]; then t=$MAXT; else t=$((t * 2)); fi
+done
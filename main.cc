@@ -5,81 +5,161 @@
 
 #include "EICDetectorConstruction.hh"
 #include "ActionInitialization.hh"
+#include "Production.hh"
+#include "Luminosity.hh"
+#include "Benchmark.hh"
 #include "FTFP_BERT.hh"
+#include "G4StepLimiterPhysics.hh"
+#include "G4FastSimulationPhysics.hh"
 
+#include "TROOT.h"
+
+#include <chrono>
 #include <iostream>
 #include <cstdlib>
+#include <cctype>
 #include <cmath>
+#include <random>
+#include <string>
+#include <vector>
 
 
-namespace phys {
-  constexpr long double NA   = 6.02214076e23L;   // Avogadro [mol^-1]
-  constexpr long double WEEK = 7.0L*24.0L*3600.0L; // [s] = 604800
-  constexpr long double THICK = 1.0L;            // t = 1 cm (fixed target)
-  constexpr long double EFF   = 1.0L;            // Efficiency
-  // PHI = dN/dt [part/s]. 6.24e18 ~ 1 A ; 6.24e12 ~ 1 µA.
-  constexpr long double PHI  = 6.24e18L;         // beam (part/s)
-}
-
-inline bool GetMatProps(const std::string& nuc, long double& M, long double& rho) {
-  std::string k = nuc; for (auto& c : k) c = std::toupper(c);
-  if (k=="U"  || k=="URANIUM") { M=238.0L;  rho=18.95L;  return true; }
-  if (k=="C"  || k=="CARBON")  { M=12.01L;  rho=2.267L;  return true; }
-  if (k=="H"  || k=="HYDROGEN"){ M=1.008L;  rho=0.08988e-3L; return true; }
-  if (k=="AL" || k=="ALUMINUM"){ M=26.98L;  rho=2.70L;   return true; }
-  if (k=="CU" || k=="COPPER")  { M=63.546L; rho=8.96L;   return true; }
-  if (k=="PB" || k=="LEAD")    { M=207.2L;  rho=11.34L;  return true; }
-  return false;
-}
-
-static long long ComputeEvents(double sigma_mb, const std::string& nucleus) {
-  long double M=0.0L, rho=0.0L;
-  if (!GetMatProps(nucleus, M, rho)) {
-    std::cerr << "[ERROR] Unknown nucleus/material: " << nucleus << "\n";
-    return 0;
-  }
-
-  // Areal density [atoms/cm^2]
-  const long double RHOT = (phys::NA / M) * rho * phys::THICK;
-
-  // Luminosity [cm^-2 s^-1]
-  const long double L = phys::PHI * RHOT;
-
-  // sigma: mb -> barns -> cm^2
-  const long double sigma_b = (long double)sigma_mb * 1.0e-3L; // mb -> b
-  const long double sigma_c = sigma_b * 1.0e-24L;              // b  -> cm^2
+int main(int argc, char** argv) {
+    const auto startTime = std::chrono::steady_clock::now();
+
+    // --- Command line ---
+    //   [-t nThreads] [--first-event N] [--events N] [--seed S] [--shard K]
+    //   [--target NUC] [--geometry FILE] [--geometry-cache DIR] [--flat-geometry]
+    //   [--check-overlaps [points]] [--bench LIST|all] [--bench-out FILE]
+    //   [macro.mac | sigma_mb]
+    const std::string usage = std::string("Usage: ") + argv[0]
+        + " [-t nThreads] [--first-event N] [--events N] [--seed S] [--shard K]"
+          " [--target NUC] [--geometry FILE] [--geometry-cache DIR] [--flat-geometry]"
+          " [--check-overlaps [points]] [--bench LIST|all] [--bench-out FILE]"
+          " [macro.mac | sigma_mb]\n";
+    G4int nThreads = 1;
+    G4bool firstEventGiven = false;
+    std::string geometryFile = "geometry/ft-eic.geo";
+    std::string geometryCache = ".geocache";   // "" = no cache
+    G4bool flatGeometry = false;
+    G4int overlapPoints = 0;   // > 0: check the geometry and exit
+    std::string benchList;     // non-empty: run the benchmark workloads and exit
+    std::string benchOut;
+    auto& production = Production::GetSettings();
+    auto& lumi = Luminosity::GetSettings();
+    std::vector<std::string> args;
+    for (int i = 1; i < argc; ++i) {
+        std::string a = argv[i];
+        const bool hasValue = i + 1 < argc;
+        if ((a == "-t" || a == "--threads") && hasValue) {
+            nThreads = std::atoi(argv[++i]);
+        } else if (a == "--first-event" && hasValue) {
+            production.firstEvent = std::atoi(argv[++i]);
+            firstEventGiven = true;
+        } else if (a == "--events" && hasValue) {
+            production.nEvents = std::atoi(argv[++i]);
+        } else if (a == "--seed" && hasValue) {
+            production.seed = std::strtoull(argv[++i], nullptr, 10);
+        } else if (a == "--shard" && hasValue) {
+            production.shard = std::atoi(argv[++i]);
+        } else if (a == "--target" && hasValue) {
+            lumi.target = argv[++i];
+        } else if (a == "--geometry" && hasValue) {
+            geometryFile = argv[++i];
+        } else if (a == "--geometry-cache" && hasValue) {
+            geometryCache = argv[++i];
+        } else if (a == "--flat-geometry") {
+            flatGeometry = true;
+        } else if (a == "--check-overlaps") {
+            overlapPoints = 1000;
+            if (hasValue && std::isdigit(static_cast<unsigned char>(argv[i + 1][0]))) {
+                overlapPoints = std::atoi(argv[++i]);
+            }
+        } else if (a == "--bench" && hasValue) {
+            benchList = argv[++i];
+        } else if (a == "--bench-out" && hasValue) {
+            benchOut = argv[++i];
+        } else {
+            args.push_back(a);
+        }
+    }
+    if (nThreads < 1 || production.firstEvent < 0) {
+        std::cerr << usage;
+        return 1;
+    }
+    // Shard K of a production of equal shards starts at K * events
+    if (production.shard >= 0 && !firstEventGiven && production.nEvents > 0) {
+        production.firstEvent = production.shard * production.nEvents;
+    }
 
-  // Events over one week
-  long double N = L * phys::WEEK * sigma_c * phys::EFF;
+    // Benchmarks run the same events everywhere: fixed seed unless given
+    if (!benchList.empty() && production.seed == 0) production.seed = 12345;
+    if (production.seed == 0) {
+        std::random_device device;
+        production.streamSeed = (uint64_t(device()) << 32) | device();
+    }
 
-  // Clamp to signed 64-bit
-  if (N < 0.0L) N = 0.0L;
-  constexpr long double Nmax64 = 9.22e18L;
-  if (N > Nmax64) {
-    std::cerr << "[WARN] N exceeds 64-bit range; clamping to " << (long double)Nmax64 << "\n";
-    N = Nmax64;
-  }
-  return static_cast<long long>(llround(N));
-}
+    // Worker threads each open their own TFile
+    ROOT::EnableThreadSafety();
 
-int main(int argc, char** argv) {
     // --- Run manager ---
     auto runManager = new G4MTRunManager();
-    runManager->SetNumberOfThreads(1);
+    runManager->SetNumberOfThreads(nThreads);
 
     auto detector = new EICDetectorConstruction();
+    detector->SetDescription(geometryFile, geometryCache);
+    // Former layout, every subdetector in the world: navigation comparisons
+    detector->SetEnvelopes(!flatGeometry);
     runManager->SetUserInitialization(detector);
-    runManager->SetUserInitialization(new FTFP_BERT());
+    // Step limiter / user special cuts: DetectorRegions user limits
+    auto physicsList = new FTFP_BERT();
+    physicsList->RegisterPhysics(new G4StepLimiterPhysics());
+    // FastShowerModel in the calorimeter regions
+    auto fastSimulation = new G4FastSimulationPhysics();
+    fastSimulation->ActivateFastSimulation("e-");
+    fastSimulation->ActivateFastSimulation("e+");
+    fastSimulation->ActivateFastSimulation("gamma");
+    physicsList->RegisterPhysics(fastSimulation);
+    runManager->SetUserInitialization(physicsList);
     runManager->SetUserInitialization(new ActionInitialization(detector));
 
     // --- Initialize the kernel ---
     runManager->Initialize();
 
+    // ----- Overlap check mode: exit status 1 if any placement overlaps -----
+    if (overlapPoints > 0) {
+        const G4int overlaps = detector->CheckOverlaps(overlapPoints);
+        delete runManager;
+        return overlaps > 0 ? 1 : 0;
+    }
+
+    // ----- Benchmark mode: fixed workloads, one JSON line each -----
+    if (!benchList.empty()) {
+        const G4double initTime = std::chrono::duration<G4double>(std::chrono::steady_clock::now() - startTime).count();
+        const G4bool ok = Benchmark::Run(runManager, benchList, nThreads, initTime,
+                                         production.nEvents, benchOut);
+        delete runManager;
+        return ok ? 0 : 1;
+    }
+
     G4VisExecutive* visManager = nullptr;
     G4UIExecutive* ui = nullptr;
     G4UImanager* UImanager = G4UImanager::GetUIpointer();
 
-    if (argc == 1) {
+    // Macros can use {nEvents}, {firstEvent}, {shard}
+    UImanager->SetAlias(("nEvents " + std::to_string(production.nEvents >= 0 ? production.nEvents : 0)).c_str());
+    UImanager->SetAlias(("firstEvent " + std::to_string(production.firstEvent)).c_str());
+    UImanager->SetAlias(("shard " + std::to_string(production.shard)).c_str());
+
+    if (args.empty() && production.nEvents >= 0) {
+        // ----- Batch mode, event count from the command line -----
+        std::cout << "[INFO] events " << production.firstEvent << " - "
+                  << production.firstEvent + production.nEvents - 1
+                  << " (shard " << production.shard << ", seed " << production.seed;
+        if (production.seed == 0) std::cout << ", Pythia streams from " << production.streamSeed;
+        std::cout << ")" << std::endl;
+        runManager->BeamOn(production.nEvents);
+    } else if (args.empty()) {
         // ----- Interactive mode -----
         ui = new G4UIExecutive(argc, argv);
         visManager = new G4VisExecutive();
@@ -96,24 +176,26 @@ int main(int argc, char** argv) {
         delete ui;
     } else {
         // ----- Batch mode -----
-        std::string arg1 = argv[1];
+        std::string arg1 = args[0];
         if (arg1.find(".mac") != std::string::npos) {
             // Case: macro file
             UImanager->ApplyCommand("/control/execute " + arg1);
         } else {
             // Case: cross section in mb
-            double sigma_mb = std::atof(argv[1]);
+            double sigma_mb = std::atof(arg1.c_str());
             if (sigma_mb <= 0) {
-                std::cerr << "Usage: " << argv[0]
-                          << " [macro.mac | sigma_mb]\n";
+                std::cerr << usage;
                 delete runManager;
                 return 1;
             }
-            long long N = 100000;
-            //ComputeEvents(sigma_mb, "H");
-            
-            std::cout << "[INFO] sigma = " << sigma_mb
-                      << "  mb -> BeamOn(" << N << ")\n" << std::endl;
+            long long N = production.nEvents >= 0 ? production.nEvents : 100000;
+            // The week of luminosity is far more than N events: each event
+            // is weighted by ComputeEvents(sigma_mb, target) / trials, the
+            // Pythia events generated including the filtered ones (RunAction)
+            lumi.sigma_mb = sigma_mb;
+
+            std::cout << "[INFO] sigma = " << sigma_mb << " mb on " << lumi.target
+                      << " -> BeamOn(" << N << ")\n" << std::endl;
             
             runManager->BeamOn(N);
         }
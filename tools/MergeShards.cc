@@ -0,0 +1,343 @@
+// Concatenates the outputs of a sharded production (tracks_output_shard*.root)
+// into one file ordered by EventID, and checks the event coverage first:
+//  - shard event ranges (RunInfo) must not overlap and must leave no gap
+//  - compact and digits layouts (Events, Digits): every event of the
+//    ranges exactly once
+//  - legacy layout (TrackTree, events without pairs have no rows): no
+//    EventID outside its shard's range or in two shards
+// Every shard is normalised to a full week of luminosity (EventScale =
+// eventsPerWeek / its own Pythia trials): the merged RunInfo gets
+// eventsPerWeek / the trials of all shards.
+//
+// Given the histogram files instead (output_shard*.root), sums the spectra
+// with the same renormalisation.
+//
+// Usage: mergeShards [-f] output.root shard0.root shard1.root ...
+//        mergeShards output.root output_shard0.root output_shard1.root ...
+//   -f  write the output even if the checks fail
+
+#include "TChain.h"
+#include "TClass.h"
+#include "TFile.h"
+#include "TH1.h"
+#include "TKey.h"
+#include "TParameter.h"
+#include "TTree.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+
+// Luminosity normalisation of one shard (Luminosity::Settings)
+struct Norm {
+    Long64_t trials = 0;          // 0: not recorded (older productions)
+    Long64_t eventsPerWeek = 0;
+    Double_t eventScale = 1.;
+};
+
+struct Shard {
+    std::string file;
+    int shard = -1;
+    int firstEvent = 0;
+    int nEvents = 0;
+    std::string tree;
+    Norm norm;
+};
+
+// Spectra of AnalysisManager filled with the generator weight and scaled
+// by EventScale; the others are plain counts
+const char* const kWeighted[] = {"PairMassHist", "PairXFHist", "PairPtHist", "PairYHist"};
+
+bool IsWeighted(const char* name) {
+    for (auto w : kWeighted) {
+        if (std::strcmp(name, w) == 0) return true;
+    }
+    return false;
+}
+
+// EventScale of the whole production: eventsPerWeek / all the trials.
+// Without Trials each scale is eventsPerWeek / trials_k, which gives
+// 1 / sum(1 / scale_k) for the same eventsPerWeek.
+bool MergedScale(const std::vector<Norm>& norms, double& scale) {
+    Long64_t trials = 0;
+    bool recorded = true, unnormalised = true;
+    double inverse = 0.;
+    for (const auto& n : norms) {
+        if (n.eventsPerWeek != norms.front().eventsPerWeek) {
+            std::fprintf(stderr, "EventsPerWeek differs between shards (%lld, %lld)\n",
+                         n.eventsPerWeek, norms.front().eventsPerWeek);
+            return false;
+        }
+        trials += n.trials;
+        recorded = recorded && n.trials > 0;
+        unnormalised = unnormalised && n.eventScale == 1.;
+        inverse += 1. / n.eventScale;
+    }
+    if (recorded) {
+        scale = norms.front().eventsPerWeek > 0 ? double(norms.front().eventsPerWeek) / trials : 1.;
+    } else {
+        scale = unnormalised ? 1. : 1. / inverse;
+    }
+    return true;
+}
+
+bool ReadRunInfo(const std::string& fileName, Shard& s) {
+    TFile file(fileName.c_str(), "READ");
+    auto info = file.IsZombie() ? nullptr : file.Get<TTree>("RunInfo");
+    if (!info || info->GetEntries() < 1) {
+        std::fprintf(stderr, "%s: no RunInfo\n", fileName.c_str());
+        return false;
+    }
+    char tree[16] = {0};
+    info->SetBranchAddress("Shard", &s.shard);
+    info->SetBranchAddress("FirstEvent", &s.firstEvent);
+    info->SetBranchAddress("NEvents", &s.nEvents);
+    info->SetBranchAddress("Tree", tree);
+    if (info->GetBranch("EventScale")) info->SetBranchAddress("EventScale", &s.norm.eventScale);
+    if (info->GetBranch("Trials")) {
+        info->SetBranchAddress("Trials", &s.norm.trials);
+        info->SetBranchAddress("EventsPerWeek", &s.norm.eventsPerWeek);
+    }
+    info->GetEntry(0);
+    s.file = fileName;
+    s.tree = tree;
+    return true;
+}
+
+template <typename T>
+T Parameter(TFile& file, const char* name, T fallback) {
+    auto p = file.Get<TParameter<T>>(name);
+    return p ? p->GetVal() : fallback;
+}
+
+// output_shard*.root of AnalysisManager: histograms summed, the weighted
+// ones taken back to generator weights and scaled for the whole production
+int MergeSpectra(const std::string& output, const std::vector<std::string>& inputs) {
+    std::vector<std::unique_ptr<TFile>> files;
+    std::vector<Norm> norms;
+    Long64_t events = 0;
+    Double_t sumWeights = 0.;
+    for (const auto& f : inputs) {
+        files.emplace_back(new TFile(f.c_str(), "READ"));
+        auto& file = *files.back();
+        if (file.IsZombie() || !file.Get<TParameter<Double_t>>("EventScale")) {
+            std::fprintf(stderr, "%s: no spectra\n", f.c_str());
+            return 1;
+        }
+        Norm n;
+        n.trials = Parameter<Long64_t>(file, "Trials", 0);
+        n.eventsPerWeek = Parameter<Long64_t>(file, "EventsPerWeek", 0);
+        n.eventScale = Parameter<Double_t>(file, "EventScale", 1.);
+        norms.push_back(n);
+        events += Parameter<Long64_t>(file, "Events", 0);
+        sumWeights += Parameter<Double_t>(file, "SumWeights", 0.);
+    }
+    double scale = 1.;
+    if (!MergedScale(norms, scale)) return 1;
+
+    TFile out(output.c_str(), "RECREATE");
+    if (out.IsZombie()) {
+        std::fprintf(stderr, "Could not create %s\n", output.c_str());
+        return 1;
+    }
+    for (auto key : TRangeDynCast<TKey>(files.front()->GetListOfKeys())) {
+        if (!key || !TClass::GetClass(key->GetClassName())->InheritsFrom(TH1::Class())) continue;
+        const char* name = key->GetName();
+        const bool weighted = IsWeighted(name);
+        std::unique_ptr<TH1> sum;
+        for (std::size_t i = 0; i < files.size(); ++i) {
+            auto hist = files[i]->Get<TH1>(name);
+            if (!hist) {
+                std::fprintf(stderr, "%s: no %s\n", inputs[i].c_str(), name);
+                return 1;
+            }
+            const double c = weighted ? 1. / norms[i].eventScale : 1.;
+            if (!sum) {
+                sum.reset(static_cast<TH1*>(hist->Clone()));
+                sum->SetDirectory(nullptr);
+                sum->Scale(c);
+            } else {
+                sum->Add(hist, c);
+            }
+        }
+        if (weighted) sum->Scale(scale);
+        out.cd();
+        sum->Write();
+    }
+    Long64_t trials = 0;
+    for (const auto& n : norms) trials += n.trials;
+    out.cd();
+    TParameter<Long64_t>("Events", events).Write();
+    TParameter<Double_t>("SumWeights", sumWeights).Write();
+    TParameter<Long64_t>("Trials", trials).Write();
+    TParameter<Long64_t>("EventsPerWeek", norms.front().eventsPerWeek).Write();
+    TParameter<Double_t>("EventScale", scale).Write();
+    out.Close();
+    std::printf("%zu spectra files, %lld events, event scale %g\n", inputs.size(), events, scale);
+    return 0;
+}
+
+// Histogram files carry the EventScale parameter, track files RunInfo
+bool IsSpectra(const std::string& fileName) {
+    TFile file(fileName.c_str(), "READ");
+    return !file.IsZombie() && file.Get<TParameter<Double_t>>("EventScale");
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    bool force = false;
+    std::vector<std::string> args;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "-f") == 0) force = true;
+        else args.emplace_back(argv[i]);
+    }
+    if (args.size() < 2) {
+        std::fprintf(stderr, "Usage: %s [-f] output.root shard0.root [shard1.root ...]\n", argv[0]);
+        return 1;
+    }
+    const std::string output = args.front();
+    const std::vector<std::string> inputs(args.begin() + 1, args.end());
+    if (IsSpectra(inputs.front())) return MergeSpectra(output, inputs);
+
+    // --- Shard ranges ---
+    std::vector<Shard> shards;
+    for (const auto& f : inputs) {
+        Shard s;
+        if (!ReadRunInfo(f, s)) return 1;
+        shards.push_back(s);
+    }
+    const std::string treeName = shards.front().tree;
+    for (const auto& s : shards) {
+        if (s.tree != treeName) {
+            std::fprintf(stderr, "%s: tree %s, expected %s\n", s.file.c_str(), s.tree.c_str(), treeName.c_str());
+            return 1;
+        }
+    }
+    std::sort(shards.begin(), shards.end(),
+              [](const Shard& a, const Shard& b) { return a.firstEvent < b.firstEvent; });
+    std::vector<Norm> norms;
+    for (const auto& s : shards) norms.push_back(s.norm);
+    double scale = 1.;
+    if (!MergedScale(norms, scale)) return 1;
+
+    long problems = 0;
+    for (std::size_t i = 1; i < shards.size(); ++i) {
+        const auto& prev = shards[i - 1];
+        const auto& cur = shards[i];
+        const int prevEnd = prev.firstEvent + prev.nEvents;
+        if (cur.firstEvent < prevEnd) {
+            std::printf("overlap: %s [%d, %d) and %s [%d, %d)\n", prev.file.c_str(), prev.firstEvent,
+                        prevEnd, cur.file.c_str(), cur.firstEvent, cur.firstEvent + cur.nEvents);
+            ++problems;
+        } else if (cur.firstEvent > prevEnd) {
+            std::printf("gap: events [%d, %d) in no shard\n", prevEnd, cur.firstEvent);
+            ++problems;
+        }
+    }
+    const int first = shards.front().firstEvent;
+    const int last = shards.back().firstEvent + shards.back().nEvents;
+
+    // --- EventIDs, in chain order ---
+    TChain chain(treeName.c_str());
+    for (const auto& s : shards) chain.Add(s.file.c_str());
+
+    Int_t eventID = 0;
+    chain.SetBranchStatus("*", 0);
+    chain.SetBranchStatus("EventID", 1);
+    chain.SetBranchAddress("EventID", &eventID);
+
+    const Long64_t nEntries = chain.GetEntries();
+    std::vector<std::pair<Int_t, Long64_t>> order;
+    std::vector<int> owner;   // shard of each entry
+    order.reserve(nEntries);
+    owner.reserve(nEntries);
+    for (Long64_t i = 0; i < nEntries; ++i) {
+        chain.GetEntry(i);
+        order.emplace_back(eventID, i);
+        owner.push_back(chain.GetTreeNumber());
+    }
+
+    long outside = 0;
+    for (Long64_t i = 0; i < nEntries; ++i) {
+        const auto& s = shards[owner[i]];
+        const int id = order[i].first;
+        if (id < s.firstEvent || id >= s.firstEvent + s.nEvents) ++outside;
+    }
+    if (outside) {
+        std::printf("%ld entries outside their shard's event range\n", outside);
+        problems += outside;
+    }
+
+    std::stable_sort(order.begin(), order.end(),
+                     [](const auto& a, const auto& b) { return a.first < b.first; });
+
+    long duplicated = 0, missing = 0;
+    if (treeName == "Events" || treeName == "Digits") {
+        // One entry per event
+        int expected = first;
+        for (const auto& [id, entry] : order) {
+            if (id < expected) { ++duplicated; continue; }
+            missing += id - expected;
+            expected = id + 1;
+        }
+        if (expected < last) missing += last - expected;
+    } else {
+        // Several rows per event, all from the same shard
+        for (std::size_t i = 1; i < order.size(); ++i) {
+            if (order[i].first == order[i - 1].first &&
+                owner[order[i].second] != owner[order[i - 1].second]) {
+                ++duplicated;
+            }
+        }
+    }
+    if (duplicated) std::printf("%ld duplicated events\n", duplicated);
+    if (missing) std::printf("%ld missing events\n", missing);
+    problems += duplicated + missing;
+
+    std::printf("%zu shards, events [%d, %d), %lld %s entries, event scale %g: %s\n", shards.size(),
+                first, last, nEntries, treeName.c_str(), scale, problems ? "CHECK FAILED" : "ok");
+    if (problems && !force) return 2;
+
+    // --- Merge, ordered by EventID ---
+    chain.SetBranchStatus("*", 1);
+    TFile out(output.c_str(), "RECREATE");
+    if (out.IsZombie()) {
+        std::fprintf(stderr, "Could not create %s\n", output.c_str());
+        return 1;
+    }
+    chain.LoadTree(0);
+    TTree* merged = chain.CloneTree(0);
+    merged->SetDirectory(&out);
+    for (const auto& [id, entry] : order) {
+        chain.GetEntry(entry);
+        merged->Fill();
+    }
+    out.cd();
+    merged->Write("", TObject::kOverwrite);
+
+    // RunInfo of every shard, in event order, with the EventScale of the
+    // whole production
+    TChain info("RunInfo");
+    for (const auto& s : shards) info.Add(s.file.c_str());
+    Double_t eventScale = 1.;
+    info.SetBranchAddress("EventScale", &eventScale);
+    info.LoadTree(0);
+    out.cd();
+    TTree* mergedInfo = info.CloneTree(0);
+    for (Long64_t i = 0; i < info.GetEntries(); ++i) {
+        info.GetEntry(i);
+        eventScale = scale;
+        mergedInfo->Fill();
+    }
+    mergedInfo->Write("", TObject::kOverwrite);
+    out.Close();
+
+    return problems ? 2 : 0;
+}
@@ -0,0 +1,180 @@
+// Track reconstruction on a digits output (/eic/output/schema digits): the
+// channels of the FVTX and inner tracker disks turned back into global
+// points (channel centres), then TrackFinder with its default settings, the
+// target of the description as vertex. Writes the tracks of every event to
+// a RecoTracks tree (cm; x0/y0 at the target, cx/cy past the coil entry).
+//
+// Usage: recoDigits [-g description.geo] [-B tesla] input.root [output.root]
+//   (default geometry/ft-eic.geo, 1.7 T as the simulation default, 0 for
+//   runs with /eic/field/type none; reco_tracks.root)
+
+#include "GeometryDescription.hh"
+#include "Readout.hh"
+#include "TrackFinder.hh"
+
+#include "TFile.h"
+#include "TTree.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+
+constexpr int kMaxDigits = 65536;   // TrackOutput::kMaxDigits
+constexpr int kMaxTracks = 4096;
+
+// Readout map of each detector index, and where its channels go
+struct Detector {
+    ReadoutMap map;
+    int        layer;               // TrackFinder layer, -1: not used
+    double     position[3];         // world, cm
+};
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::string geometry = "geometry/ft-eic.geo";
+    double bz = 1.7;   // FieldSetup default
+    std::vector<std::string> args;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "-g") == 0 && i + 1 < argc) geometry = argv[++i];
+        else if (std::strcmp(argv[i], "-B") == 0 && i + 1 < argc) bz = std::atof(argv[++i]);
+        else args.emplace_back(argv[i]);
+    }
+    if (args.empty() || args.size() > 2) {
+        std::fprintf(stderr, "Usage: %s [-g description.geo] [-B tesla] input.root [output.root]\n", argv[0]);
+        return 2;
+    }
+    const std::string outputName = args.size() > 1 ? args[1] : "reco_tracks.root";
+
+    GeometryDescription description;
+    std::string error;
+    bool fromCache = false;
+    if (!description.Load(geometry, "", error, fromCache)) {
+        std::fprintf(stderr, "%s: %s\n", geometry.c_str(), error.c_str());
+        return 1;
+    }
+    std::vector<const GeometryDescription::Volume*> layerVolumes;
+    const auto layers = TrackFinder::DiskLayers(description, layerVolumes);
+    if (layers.size() < 3) {
+        std::fprintf(stderr, "%s: %zu tracking layers, 3 needed\n", geometry.c_str(), layers.size());
+        return 1;
+    }
+    auto& config = TrackFinder::GetSettings().config;
+    if (const auto* target = description.Find("Target")) {
+        double position[3];
+        description.WorldPosition(*target, position);
+        config.vertexZ = position[2];
+    }
+    config.fieldBz = bz;
+
+    // Detector d: readout volume d in description order, as in the simulation
+    std::vector<Detector> detectors;
+    for (const auto& v : description.volumes) {
+        if (v.readout == GeometryDescription::Readout::None) continue;
+        Detector d{ReadoutMap(v), -1, {0., 0., 0.}};
+        for (std::size_t l = 0; l < layerVolumes.size(); ++l) {
+            if (layerVolumes[l] == &v) d.layer = int(l);
+        }
+        description.WorldPosition(v, d.position);
+        detectors.push_back(std::move(d));
+    }
+
+    TFile input(args[0].c_str(), "READ");
+    auto digits = input.IsZombie() ? nullptr : input.Get<TTree>("Digits");
+    if (!digits) {
+        std::fprintf(stderr, "%s: no Digits tree (/eic/output/schema digits)\n", args[0].c_str());
+        return 1;
+    }
+    Int_t eventID = -1, nDigit = 0;
+    std::vector<UShort_t> detector(kMaxDigits);
+    std::vector<UInt_t> channel(kMaxDigits);
+    digits->SetBranchStatus("*", 0);
+    for (const char* name : {"EventID", "nDigit", "Digit_Detector", "Digit_Channel"}) {
+        digits->SetBranchStatus(name, 1);
+    }
+    digits->SetBranchAddress("EventID", &eventID);
+    digits->SetBranchAddress("nDigit", &nDigit);
+    digits->SetBranchAddress("Digit_Detector", detector.data());
+    digits->SetBranchAddress("Digit_Channel", channel.data());
+
+    TFile output(outputName.c_str(), "RECREATE");
+    if (output.IsZombie()) {
+        std::fprintf(stderr, "%s: cannot create\n", outputName.c_str());
+        return 1;
+    }
+    auto tracks = new TTree("RecoTracks", "Tracks from the tracker digits");
+    Int_t nTrack = 0;
+    std::vector<Float_t> x0(kMaxTracks), y0(kMaxTracks), tx(kMaxTracks), ty(kMaxTracks);
+    std::vector<Float_t> cx(kMaxTracks), cy(kMaxTracks), chi2(kMaxTracks);
+    std::vector<UShort_t> nHits(kMaxTracks);
+    tracks->Branch("EventID", &eventID, "EventID/I");
+    tracks->Branch("nTrack", &nTrack, "nTrack/I");
+    tracks->Branch("Track_X0", x0.data(), "Track_X0[nTrack]/F");
+    tracks->Branch("Track_Y0", y0.data(), "Track_Y0[nTrack]/F");
+    tracks->Branch("Track_TX", tx.data(), "Track_TX[nTrack]/F");
+    tracks->Branch("Track_TY", ty.data(), "Track_TY[nTrack]/F");
+    tracks->Branch("Track_CX", cx.data(), "Track_CX[nTrack]/F");
+    tracks->Branch("Track_CY", cy.data(), "Track_CY[nTrack]/F");
+    tracks->Branch("Track_Chi2", chi2.data(), "Track_Chi2[nTrack]/F");
+    tracks->Branch("Track_NHits", nHits.data(), "Track_NHits[nTrack]/s");
+
+    TrackFinder finder(layers);
+    const Long64_t nEvents = digits->GetEntries();
+    long totalHits = 0, totalTracks = 0, unknown = 0;
+    double seconds = 0.;
+    for (Long64_t e = 0; e < nEvents; ++e) {
+        digits->GetEntry(e);
+        const auto start = std::chrono::steady_clock::now();
+        finder.Clear();
+        for (Int_t i = 0; i < nDigit; ++i) {
+            if (detector[i] >= detectors.size()) {
+                ++unknown;
+                continue;
+            }
+            const auto& d = detectors[detector[i]];
+            if (d.layer < 0) continue;
+            double r, phi, z;
+            d.map.Centre(channel[i], r, phi, z);
+            finder.AddHit(d.layer, d.position[0] + r * std::cos(phi), d.position[1] + r * std::sin(phi),
+                          d.position[2] + z, -1);
+        }
+        finder.Find(config);
+        seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        const auto& found = finder.Tracks();
+        nTrack = std::min<Int_t>(found.size(), kMaxTracks);
+        for (Int_t t = 0; t < nTrack; ++t) {
+            x0[t] = found[t].x0;
+            y0[t] = found[t].y0;
+            tx[t] = found[t].tx;
+            ty[t] = found[t].ty;
+            cx[t] = found[t].cx;
+            cy[t] = found[t].cy;
+            chi2[t] = found[t].chi2;
+            nHits[t] = found[t].nHits;
+        }
+        tracks->Fill();
+        totalHits += long(finder.Hits());
+        totalTracks += nTrack;
+    }
+    output.cd();
+    tracks->Write();
+    output.Close();
+
+    if (unknown > 0) {
+        std::fprintf(stderr, "Warning: %ld digits of detectors not in %s (other geometry?)\n", unknown,
+                     geometry.c_str());
+    }
+    std::printf("%lld events, %ld tracker hits, %ld tracks (%.2f per event) in %.3f s -> %s\n", nEvents,
+                totalHits, totalTracks, nEvents ? double(totalTracks) / nEvents : 0., seconds,
+                outputName.c_str());
+    return 0;
+}